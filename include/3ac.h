@@ -12,6 +12,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <interner.h>
 #include <symbol_table.h>
 #include <memory>
 
@@ -111,7 +112,9 @@ typedef unsigned int TID;
 /** Represents a single three address code instruction. */
 typedef struct tac_line {
 public:
-    static unsigned int bid_gen;
+    // Each thread gives out IDs separately, so that threads optimizing 
+    // different graphs can be given separate ranges of IDs.
+    static thread_local unsigned int bid_gen;
 
     /**
      * @param line The current instruction.
@@ -137,6 +140,27 @@ public:
      */
     static bool is_conditional_jump(const tac_line &line);
 
+    /**
+     * @param operation A conditional jump operation.
+     * @return The jump taken exactly when the provided jump is not taken, or 
+     * TAC_NOP if the jump can not be inverted.
+     */
+    static tac_op_t invert_conditional_jump(const tac_op_t operation);
+
+    /**
+     * Evaluates a conditional jump the same way the generated code does, that 
+     * is the jump is taken if (lhs op rhs).
+     * @param operation A conditional jump operation.
+     * @param lhs The value of the first operand of the compare.
+     * @param rhs The value of the second operand of the compare.
+     * @return True if the jump is taken, else false.
+     */
+    static bool is_jump_taken(
+        const tac_op_t operation, 
+        const int64_t lhs, 
+        const int64_t rhs
+    );
+
     /**
      * @param line The current instruction.
      * @return True if the operation is a procedure call, else false.
@@ -186,6 +210,15 @@ public:
      */
     bool is_operand_constant(const std::string &value) const;
 
+    /**
+     * Retrieves the value of an integer literal or constant variable within 
+     * the scope of this instruction.
+     * @param value The variable to evaluate.
+     * @param out The value of the constant, if found.
+     * @return True if the value is an integer constant, else false.
+     */
+    bool get_constant_value(const std::string &value, int64_t &out) const;
+
     /**
      * Simple three address code expressions have at least one operand and are 
      * simple expressions, not labels or function operations.
@@ -210,9 +243,11 @@ public:
 
     TID bid;
     tac_op_t operation;
-    std::string argument1;
-    std::string argument2;
-    std::string result;
+    // The operands are interned, as they are compared far more often than 
+    // they are created.
+    Symbol argument1;
+    Symbol argument2;
+    Symbol result;
     std::shared_ptr<SymbolTable> table;
 public:
     /**
@@ -12,6 +12,7 @@
 #include <string>
 #include <vector>
 #include <codegen2/registers.h>
+#include <interner.h>
 
 typedef enum location_type {
     LT_DUMMY,
@@ -94,11 +95,11 @@ public:
      * @param variable Variable to look up.
      * @return A Location object denoting the location of the variable.
      */
-    Location &getLocation(const std::string &variable);
+    Location &getLocation(const Symbol &variable);
 
-    bool isInRegister(const std::string &variable) const;
+    bool isInRegister(const Symbol &variable) const;
 
-    RegPtr getRegister(const std::string &variable);
+    RegPtr getRegister(const Symbol &variable);
 
     /**
      * Associates a variable with the location provided.
@@ -106,7 +107,13 @@ public:
      * @param variable The variable to associate with.
      * @param location The location to associate with.
      */
-    void insert(const std::string &variable, const Location &location);
+    void insert(const Symbol &variable, const Location &location);
+
+    /**
+     * Forgets the location of a variable whose value is no longer needed.
+     * @param variable The variable to forget.
+     */
+    void remove(const Symbol &variable);
 
     /**
      * Associates a variable with an immediate value if it is a literal.
@@ -125,13 +132,14 @@ public:
      * @param variable Varible to check.
      * @return True if the variable has a location, else false.
     */
-    bool contains(const std::string &variable) const;
+    bool contains(const Symbol &variable) const;
 
     /**
      * Fetches variables and locations of variables that are located within a
      * register.
      * 
-     * @return Pairs of variables and locations that are in use in a register.
+     * @return Pairs of variables and locations that are in use in a register,
+     * ordered by variable name.
      */
     std::vector<std::pair<std::string, Location>> 
     getValueAndLocationInRegisters();
@@ -144,7 +152,9 @@ public:
     /** @return A string representation of the address table. */
     std::string to_string() const;
 private:
-    std::map<std::string, Location> table;
+    // The location of each variable is indexed by its symbol ID.
+    std::vector<Location> locations;
+    std::vector<bool> present;
 };
 
 #endif
\ No newline at end of file
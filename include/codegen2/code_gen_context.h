@@ -8,18 +8,25 @@
 #ifndef CODE_GEN_CONTEXT_H__
 #define CODE_GEN_CONTEXT_H__
 
-#include <vector>
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 /**
  * Stores the data that is to be written to an assembly file and performs the 
- * write to the file.
+ * write to the file. Each procedure is generated into a context of its own, 
+ * and the contexts are appended to the context of the compilation unit in 
+ * the order of the code.
  */
 class CodeGenContext {
 public:
     CodeGenContext();
 
-    /** Inserts the program entry point. */
+    /** 
+     * Inserts the program entry point, which aligns the stack to 32 bytes 
+     * for the frames built on it.
+     */
     void insertEntry();
 
     /** Inserts the program exit system call. */
@@ -36,16 +43,30 @@ public:
      * @param inst Text to instert into the text section.
      */
     void insertText(const std::string &inst);
+
+    /** @return The number of lines in the text section so far. */
+    size_t getTextLength();
+
+    /**
+     * Inserts a string into the text section ahead of the text generated 
+     * since, such as the instructions that a procedure is found to need on 
+     * entry once the rest of it is generated.
+     * @param position A length of the text section.
+     * @param inst Text to insert into the text section.
+     */
+    void insertTextAt(const size_t position, const std::string &inst);
     
     /** 
-     * Insert an array into the data section. 
+     * Insert an array into the data section, unless a global of the same 
+     * name is already there.
      * @param name Name of the array.
      * @param size The size of the array in bytes.
      */
     void insertGlobalArray(const std::string &name, const unsigned int size);
 
     /**
-     * Insert a variable into the data section.
+     * Insert a variable into the data section, unless a global of the same 
+     * name is already there.
      * @param name Name of the variable.
      * @param size Size of the variable in bytes.
      * @param value The literal value of the varialbe.
@@ -58,6 +79,13 @@ public:
         const unsigned int alignment=8
     );
 
+    /**
+     * Appends the text of another context to this one and adds the globals 
+     * of its data section that this context does not have yet.
+     * @param other The context to append.
+     */
+    void append(const CodeGenContext &other);
+
     /**
      * Writes the assembly context into an assembly file.
      * 
@@ -70,7 +98,9 @@ private:
     bool procedureMode;
     std::vector<std::string> textSection;
     std::vector<std::string> procedureSection;
-    std::vector<std::string> dataSection;
+    // The globals of the data section by name, in the order inserted.
+    std::vector<std::pair<std::string, std::string>> dataSection;
+    std::set<std::string> dataNames;
 };
 
 #endif
\ No newline at end of file
@@ -10,18 +10,60 @@
 #define CODE_GENERATOR_H__
 
 #include <map>
+#include <memory>
+#include <set>
+#include <stack>
 #include <string>
+#include <vector>
 #include <codegen2/registers.h>
 #include <codegen2/liveness.h>
+#include <codegen2/live_intervals.h>
+#include <codegen2/register_allocator.h>
 #include <codegen2/address_table.h>
 #include <codegen2/globals_table.h>
 #include <codegen2/stack_table.h>
 #include <codegen2/code_gen_context.h>
 #include <optimizer/block_types.h>
+#include <thread_pool.h>
+
+/**
+ * The move of an argument into the register or the stack slot it is passed 
+ * in. The value is read from a register, through the address held in a 
+ * register, or from an operand that uses no register.
+ */
+typedef struct argument_move {
+public:
+    // The register the argument is passed in, or null if on the stack.
+    RegPtr destination;
+    // Arrays are passed by their address, which may need to be computed.
+    std::string instruction;
+    RegPtr source;
+    bool indirect;
+    std::string operand;
+    // The place on the stack the value is set aside in, or -1 if it is not.
+    int setAside;
+} argument_move_t;
 
 /**
  * Generates assembly code from the three address code intermediate 
- * representation.
+ * representation. The procedures of the program are generated in parallel, 
+ * each by a generator of its own, and their code is joined in the order of 
+ * the blocks so that the assembly does not depend on the number of threads.
+ * 
+ * Unless registers are allocated locally, the variables of a procedure are 
+ * first given registers that they keep across its blocks, and only the 
+ * remaining values are given registers within each block.
+ *
+ * Procedures follow the System V calling convention. The first six arguments 
+ * are passed in registers and the rest on the stack, arrays by their 
+ * address, and the return value is passed in rax. A procedure keeps rbx and 
+ * r12 through r15 for its caller, so only the values in the other registers 
+ * that are read after a call are saved around it.
+ *
+ * Each procedure has a frame addressed from rbp that holds its parameters, 
+ * its variables and the values spilled from registers. The stack is aligned 
+ * to 32 bytes where procedures are called, so vector registers and arrays 
+ * are given aligned slots of the frame.
  */
 class CodeGenerator {
 public:
@@ -33,9 +75,70 @@ public:
      * the form of basic blocks. 
      * 
      * @param blocks Basic blocks to translate into assembly.
+     * @param pool The threads that generate the procedures.
      */
-    void generate(const BlockSet &blocks);
+    void generate(const BlockSet &blocks, ThreadPool &pool);
 private:
+    /**
+     * Records a global variable that was declared before the procedure this 
+     * generator translates, without placing it in the data section again.
+     * @param declaration The declaration of the variable.
+     * @return The symbol table entry of the variable.
+     */
+    st_entry_t declareGlobal(const tac_line_t &declaration);
+
+    /**
+     * Finds which variables are live across the blocks of a procedure and 
+     * chooses the registers that they keep across its blocks.
+     * @param blocks The blocks of the procedure.
+     * @param graphEntry The block that starts the control flow graph of the 
+     * procedure.
+     */
+    void allocateRegisters(
+        const std::vector<BBP> &blocks, 
+        const BBP graphEntry
+    );
+
+    /**
+     * Finds the calls that a procedure makes last, which are followed by 
+     * nothing but labels before the procedure returns.
+     * @param blocks The blocks of the procedure in the order of the code.
+     */
+    void findTailCalls(const std::vector<BBP> &blocks);
+
+    /**
+     * Gives a temp that is live across blocks a place in the data section, 
+     * where it is kept between the blocks like a global.
+     * @param variable The temp.
+     */
+    void declareTemporary(const std::string &variable);
+
+    /**
+     * Reserves the registers of the variables allocated over a block and 
+     * records that the variables live into the block are in them.
+     * @param bb The block about to be generated.
+     */
+    void enterBlock(const BBP &bb);
+
+    /** Loads the variables live into the procedure into their registers. */
+    void loadEntryValues();
+
+    /**
+     * Places an allocated variable in its register, releasing the variable 
+     * whose interval ended there.
+     * @param variable An allocated variable.
+     * @param load True if the value of the variable is loaded into the 
+     * register, false if it is about to be written.
+     * @return The register of the variable.
+     */
+    RegPtr claimRegister(const std::string &variable, const bool load);
+
+    /**
+     * @param variable A variable.
+     * @return True if the variable has a register across blocks, else false.
+     */
+    bool isAllocated(const std::string &variable) const;
+
     void generateFromBB(const BBP &bb);
 
     void generateFrom3AC(
@@ -43,28 +146,273 @@ private:
         const LivenessTable &liveness
     );
 
-    void generateWrite(const std::string &variable);
+    /**
+     * Writes a value by calling into the standard library, which may 
+     * overwrite any register that a procedure need not keep.
+     * @param inst The write instruction.
+     * @param liveness The liveness of the current block.
+     */
+    void generateWrite(
+        const tac_line_t &inst, 
+        const LivenessTable &liveness
+    );
+
+    /**
+     * Loads the address of an array element that was spilled to the stack 
+     * back into a register, where the instructions expect it.
+     * @param liveness The liveness of the current block.
+     * @param variable A variable the instruction uses.
+     * @param instid The instruction.
+     */
+    void loadSpilledAddress(
+        const LivenessTable &liveness,
+        const std::string &variable,
+        const TID &instid
+    );
+
+    /**
+     * Calls a procedure with the parameters that precede the call. The 
+     * procedure reads and writes the global variables in memory, so the 
+     * globals are stored before and the allocated ones loaded after.
+     * @param inst The call instruction.
+     * @param liveness The liveness of the current block.
+     */
+    void generateCall(
+        const tac_line_t &inst, 
+        const LivenessTable &liveness
+    );
+
+    /**
+     * @param inst A call instruction.
+     * @return True if the call is made last by the procedure, so that it 
+     * may jump to the procedure called in place of calling it.
+     */
+    bool isTailCall(const tac_line_t &inst) const;
+
+    /**
+     * Makes a call in tail position, moving the arguments into their 
+     * registers with the globals stored. The frame is left and the jump 
+     * made once the registers the procedure writes are known, where it 
+     * returns.
+     * @param inst The call instruction.
+     * @param liveness The liveness of the current block.
+     */
+    void generateTailCall(
+        const tac_line_t &inst, 
+        const LivenessTable &liveness
+    );
+
+    /**
+     * Finds where each parameter of a call is read from before any 
+     * register is saved or overwritten for the call.
+     * @return The moves of the arguments, in the order of the parameters.
+     */
+    std::vector<argument_move_t> findArguments();
+
+    /**
+     * Moves the arguments passed in registers into their registers, in an 
+     * order that reads each register before it is overwritten.
+     * @param moves The moves of the arguments passed in registers.
+     */
+    void moveArguments(std::vector<argument_move_t> &moves);
+
+    /**
+     * Starts the frame of the procedure being entered and gives its 
+     * parameters and its return value their places in it. Array parameters 
+     * hold the address of the array passed.
+     * @param inst The instruction that enters the procedure.
+     */
+    void enterProcedure(const tac_line_t &inst);
+
+    /**
+     * Builds the frame of the procedure right where it is entered, and 
+     * stores the arguments passed in registers into it. The frame is made 
+     * large enough once the procedure has been generated.
+     */
+    void storeParameters();
+
+    /**
+     * Moves the return value of the procedure into the return register.
+     * @param inst The instruction that returns the value.
+     * @param liveness The liveness of the current block.
+     */
+    void generateReturnValue(
+        const tac_line_t &inst, 
+        const LivenessTable &liveness
+    );
+
+    /**
+     * Returns from the procedure, restoring the registers it keeps for its 
+     * caller and its frame. The registers are saved where the procedure is 
+     * entered once it is known which of them the procedure writes, and the 
+     * size of the frame is set there as well. The tail calls are completed 
+     * the same way, jumping to the procedure called, which returns in place 
+     * of this one.
+     */
+    void generateReturn();
+
+    /**
+     * Builds a frame around code outside of the procedures once it is 
+     * generated, if any of its values were given a place on the stack.
+     */
+    void buildFrame();
+
+    /**
+     * @param reg A register.
+     * @return The slot of the frame that the register is saved in, which 
+     * is aligned to 32 bytes for a vector register.
+     */
+    std::string getSaveSlot(const RegPtr &reg);
+
+    /**
+     * @param variable A variable.
+     * @return True if the variable has a place in the frame or in the data 
+     * section, else false.
+     */
+    bool isInMemory(const std::string &variable) const;
+
+    /**
+     * @param variable A variable with a place in memory.
+     * @return The location of that place.
+     */
+    Location memoryLocation(const std::string &variable) const;
 
     void generateSpecialAssignment(
         const tac_line_t &inst,
         const LivenessTable &liveness
     );
 
+    /**
+     * Hands the register of a temporary that is not used again over to the 
+     * result of a copy from it, so that no move is needed.
+     * @param inst The copy instruction.
+     * @param liveness The liveness of the current block.
+     * @return True if the copy was coalesced, else false.
+     */
+    bool coalesceCopy(
+        const tac_line_t &inst,
+        const LivenessTable &liveness
+    );
+
     void convertGeneral3AC(
         const tac_line_t &inst,
         const LivenessTable &liveness
     );
 
+    /**
+     * Chooses the register an operation writes its result to, which is the 
+     * register of its first operand unless that operand is needed again.
+     * @param inst The operation.
+     * @param first The operand that is overwritten.
+     * @param source The register that holds the operand.
+     * @param liveness The liveness of the current block.
+     * @return The register of the result.
+     */
+    RegPtr getOperationRegister(
+        const tac_line_t &inst,
+        const std::string &first,
+        const RegPtr &source,
+        const LivenessTable &liveness
+    );
+
+    /**
+     * Records that the result of an operation is held by a register.
+     * @param inst The operation.
+     * @param first The operand that may have been overwritten.
+     * @param reg The register that holds the result.
+     */
+    void setResultRegister(
+        const tac_line_t &inst,
+        const std::string &first,
+        const RegPtr &reg
+    );
+
+    /**
+     * Divides without idiv where the divisor is a constant. A power of two 
+     * is divided by with shifts, rounding negative dividends toward zero, 
+     * and any other constant is divided by with a multiplication by its 
+     * magic number that keeps the high half of the product.
+     * @param inst The division.
+     * @param liveness The liveness of the current block.
+     */
+    void generateDivision(
+        const tac_line_t &inst,
+        const LivenessTable &liveness
+    );
+
+    /**
+     * Divides by a power of two with shifts.
+     * @param inst The division.
+     * @param shift The power of two divided by.
+     * @param negative True if the divisor is negative.
+     * @param liveness The liveness of the current block.
+     */
+    void generateShiftDivision(
+        const tac_line_t &inst,
+        const unsigned int shift,
+        const bool negative,
+        const LivenessTable &liveness
+    );
+
+    /**
+     * Divides in rax and rdx, by the magic number of a constant divisor or 
+     * else with idiv. Both registers are emptied first.
+     * @param inst The division.
+     * @param liveness The liveness of the current block.
+     */
+    void generateWideDivision(
+        const tac_line_t &inst,
+        const LivenessTable &liveness
+    );
+
     void generateConditional(
         const tac_line_t &inst,
         const LivenessTable &liveness
     );
 
+    /**
+     * Computes the address of an array element. An element at a constant 
+     * index of an array in the frame or the data section has an address 
+     * that needs no register, so it is used in place by the instructions 
+     * that read or write the element, as a variable in memory is.
+     * @param inst The instruction that indexes the array.
+     * @param liveness The liveness of the current block.
+     */
     void generateArrayIndex(
         const tac_line_t &inst,
         const LivenessTable &liveness
     );
 
+    /**
+     * Finds the address of an array element that needs no register, which 
+     * is an element at a constant index of an array in the frame or in the 
+     * data section.
+     * @param inst An instruction that indexes an array by its operands.
+     * @param element Set to the memory of the element if found.
+     * @return True if the element needs no register, else false.
+     */
+    bool findConstantElement(const tac_line_t &inst, Location &element);
+
+    /**
+     * Picks the memory operand that addresses an array element, folding 
+     * the array and the index into a single operand with as few registers 
+     * as the array and index allow.
+     * @param inst An instruction that indexes an array by its operands.
+     * @param liveness The liveness of the current block.
+     * @return The memory operand of the element.
+     */
+    std::string selectElement(
+        const tac_line_t &inst,
+        const LivenessTable &liveness
+    );
+
+    /**
+     * @param variable A variable.
+     * @return True if the variable is the address of an array element that 
+     * is used in place, else false.
+     */
+    bool isElementInMemory(const std::string &variable);
+
     void generateVaribleDeclaration(
         const tac_line_t &inst
     );
@@ -108,6 +456,67 @@ private:
         const bool address=false
     );
 
+    /**
+     * Frees the register that held a variable before it was given another, 
+     * since the value left in it is stale.
+     * @param variable The variable.
+     * @param reg The register the variable is given.
+     */
+    void releaseOldRegister(const std::string &variable, const RegPtr &reg);
+
+    /**
+     * Chooses the register to spill when none is unused, which is the one 
+     * whose value is read furthest in the future, preferring values that 
+     * do not need to be stored.
+     * @param liveness The liveness of the block being generated.
+     * @param type The type of register needed.
+     * @return The register to spill.
+     */
+    RegPtr chooseSpilledRegister(
+        const LivenessTable &liveness,
+        const register_type_t &type
+    ) const;
+
+    /**
+     * Spills the register chosen to be spilled, storing its value if it 
+     * has a place in memory.
+     * @param liveness The liveness of the block being generated.
+     * @param type The type of register needed.
+     * @return The register, which holds nothing.
+     */
+    RegPtr spillRegister(
+        const LivenessTable &liveness,
+        const register_type_t &type
+    );
+
+    /**
+     * Empties a register, storing its value if it has a place in memory.
+     * @param liveness The liveness of the block being generated.
+     * @param reg The register to empty.
+     */
+    void evictRegister(const LivenessTable &liveness, const RegPtr &reg);
+
+    /**
+     * @param liveness The liveness of the block being generated.
+     * @param type The type of register needed.
+     * @return A register that holds nothing, spilling one if none is unused.
+     */
+    RegPtr getScratchRegister(
+        const LivenessTable &liveness,
+        const register_type_t &type
+    );
+
+    /**
+     * Gets the register that the result of an instruction is written to, 
+     * without loading its previous value if it is allocated.
+     */
+    RegPtr getResultRegister(
+        const LivenessTable &liveness,
+        const std::string &variable,
+        const TID &instid,
+        const register_type_t &type
+    );
+
     RegPtr forceRegister(
         const LivenessTable &liveness,
         const std::string &variable,
@@ -116,6 +525,18 @@ private:
         const bool address=false
     );
 
+    /**
+     * Loads the value at an address held in a register into an unused 
+     * register, leaving the address where it is.
+     * @param location The location of the address.
+     * @param type The type of register to load into.
+     * @return The register holding the value.
+     */
+    RegPtr loadThroughAddress(
+        const Location &location,
+        const register_type_t &type
+    );
+
     void generateMovToRegisterIfInMemory(
         const std::string &varible,
         const RegPtr &reg,
@@ -124,7 +545,11 @@ private:
 
     void storeContentFromRegister(RegPtr &reg);
 
-    void storeVariable(const std::string &variable, const RegPtr &reg);
+    void storeVariable(
+        const std::string &variable, 
+        const RegPtr &reg,
+        const bool updated=true
+    );
 
     void storeVariableInGlobalMemory(
         const std::string &variable, 
@@ -132,14 +557,12 @@ private:
         const bool updated=true
     );
 
-    void storeVariableInGlobalMemoryInit(
-        const std::string &variable,
-        std::shared_ptr<SymbolTable> table
-    );
+    void storeVariableInGlobalMemoryInit(const tac_line_t &inst);
 
     void storeVariableInStack(
         const std::string &variable,
-        const unsigned int size
+        const unsigned int size,
+        const unsigned int alignment
     );
 
     void storeVariableInStack(
@@ -153,8 +576,25 @@ private:
 
     std::string tacToInstruction(const tac_op_t operation) const;
 
-    std::stack<RegPtr> pushRegisters();
+    /**
+     * Keeps the values that are read after a call from being lost to it. 
+     * Values in registers the callee keeps stay there, values in the other 
+     * registers move into an unused register the callee keeps or are saved, 
+     * and the values that are not read again are let go. Vector registers 
+     * are saved in the frame and the others are pushed.
+     * @param inst The instruction that makes the call.
+     * @param liveness The liveness of the current block.
+     * @param call True if a procedure is called, which reads and writes the 
+     * globals in memory, or false for a call into the standard library.
+     * @return The registers saved.
+     */
+    std::stack<RegPtr> saveRegisters(
+        const tac_line_t &inst,
+        const LivenessTable &liveness, 
+        const bool call
+    );
 
+    /** @param toPop The registers saved, which are restored in reverse. */
     void popRegisters(std::stack<RegPtr> &toPop);
 
     void freeRegisters(const LivenessTable &liveness);
@@ -164,6 +604,32 @@ private:
     GlobalTable globalTable;
     StackTable stackTable;
     CodeGenContext context;
+
+    std::unique_ptr<LiveIntervals> intervals;
+    std::map<std::string, RegPtr> allocation;
+    // Variables live into the current entry block that are not loaded yet.
+    std::vector<std::string> entryLoads;
+    // The parameters passed to the next call.
+    std::vector<tac_line_t> arguments;
+    // The parameters of the procedure being entered, stored at its label.
+    std::vector<std::string> parameters;
+    bool enteringProcedure;
+    // Where the frame is made and the registers kept for the caller are 
+    // saved in the text.
+    size_t prologue;
+    // The IDs of the calls followed by nothing but the return.
+    std::set<TID> tailCalls;
+    // Where each tail call leaves the frame in the text, and the label of 
+    // the procedure it jumps to.
+    std::vector<std::pair<size_t, std::string>> tailJumps;
+    // The array parameters, which hold the address of an array, and the 
+    // addresses of array elements spilled to the stack.
+    std::set<std::string> references;
+    BBP block;
+    // The position of the instruction being generated within the procedure.
+    unsigned int position;
+    // The position of the first instruction of the block being generated.
+    unsigned int blockStart;
 };
 
 #endif
\ No newline at end of file
@@ -24,8 +24,20 @@ public:
      * @param sizeBytes Size of the global in bytes.
      */
     GlobalAttributes(const unsigned int sizeBytes);
+
+    /**
+     * Constructs a GlobalAttributes that denotes the size of the global and 
+     * the label of its memory.
+     * @param sizeBytes Size of the global in bytes.
+     * @param label The label of the memory that holds the global.
+     */
+    GlobalAttributes(const unsigned int sizeBytes, const std::string &label);
+
+    /** @return The label of the memory, or empty if named as the global. */
+    const std::string &getLabel() const;
 private:
     unsigned int sizeBytes;
+    std::string label;
 };
 
 /**
@@ -43,6 +55,19 @@ public:
      */
     void insertGlobalVariable(const std::string &name, const unsigned int size);
 
+    /**
+     * Inserts a global variable that is held in memory labelled other than 
+     * by its name.
+     * @param name Name of the global variable to insert.
+     * @param size Size in bytes of the global variable to insert.
+     * @param label The label of the memory that holds the variable.
+     */
+    void insertGlobalVariable(
+        const std::string &name, 
+        const unsigned int size,
+        const std::string &label
+    );
+
     /**
      * Inserts a global array of the specified name and size.
      * @param name Name of the global array to insert.
@@ -55,6 +80,12 @@ public:
      * @return True if variable is global else false.
      */
     bool isGlobal(const std::string &name) const;
+
+    /**
+     * @param name A global.
+     * @return The label of the memory that holds the global.
+     */
+    std::string getLabel(const std::string &name) const;
 private:
     std::map<std::string, GlobalAttributes> table;
 };
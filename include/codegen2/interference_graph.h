@@ -0,0 +1,57 @@
+/**
+ * Contains the interference graph of the variables of a procedure, which the 
+ * graph coloring allocator colors with registers.
+ *
+ * @file interference_graph.h
+ * @author Dalton Caron
+ */
+#ifndef INTERFERENCE_GRAPH_H__
+#define INTERFERENCE_GRAPH_H__
+
+#include <utility>
+#include <vector>
+#include <codegen2/live_intervals.h>
+
+/**
+ * Connects the variables of a procedure that cannot share a register. A 
+ * variable interferes with the variables live where it is written and with 
+ * the other operands of the instruction that writes it, as the code 
+ * generator keeps a single variable in each register. The variable read by 
+ * a copy does not interfere with the variable written if it is not read 
+ * again, so that the copy can be removed by giving both the same register.
+ *
+ * The variables are numbered as in LiveIntervals::getVariables.
+ */
+class InterferenceGraph {
+public:
+    InterferenceGraph() = delete;
+
+    /** @param liveness The liveness of the variables of the procedure. */
+    InterferenceGraph(const LiveIntervals &liveness);
+
+    /**
+     * @param variable A variable.
+     * @return The variables that interfere with it, in increasing order.
+     */
+    const std::vector<size_t> &getNeighbours(const size_t variable) const;
+
+    /** @return The variable written and the variable read by each copy. */
+    const std::vector<std::pair<size_t, size_t>> &getMoves() const;
+
+    /**
+     * The cost of keeping a variable in memory is the number of times it is 
+     * accessed, where an access within a loop counts ten times as much as 
+     * one outside of it.
+     * @param variable A variable.
+     * @return The cost of keeping the variable in memory.
+     */
+    double getSpillCost(const size_t variable) const;
+private:
+    void addEdge(const size_t a, const size_t b);
+
+    std::vector<std::vector<size_t>> neighbours;
+    std::vector<std::pair<size_t, size_t>> moves;
+    std::vector<double> spillCosts;
+};
+
+#endif
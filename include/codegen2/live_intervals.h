@@ -0,0 +1,216 @@
+/**
+ * Contains the live intervals of the variables of a procedure, which drive
+ * the allocation of registers across the blocks of the procedure.
+ *
+ * @file live_intervals.h
+ * @author Dalton Caron
+ */
+#ifndef LIVE_INTERVALS_H__
+#define LIVE_INTERVALS_H__
+
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <3ac.h>
+#include <codegen2/registers.h>
+#include <optimizer/basic_block.h>
+#include <optimizer/bit_vector.h>
+
+/**
+ * The positions between which a variable may be held in a register. The
+ * instructions of a procedure are numbered in the order they are generated,
+ * and both ends of the interval are included.
+ */
+typedef struct live_interval {
+public:
+    std::string variable;
+    register_type_t type;
+    unsigned int start;
+    unsigned int end;
+    // True if a procedure is called between the ends of the interval.
+    bool crossesCall;
+} live_interval_t;
+
+/**
+ * Computes which variables are live into and out of each block of a
+ * procedure, and from that the interval of instructions over which each
+ * variable is live.
+ *
+ * Globals are live out of the blocks that leave the procedure if the
+ * procedure writes them, since they must be in memory when the procedure 
+ * returns. For the same reason a call reads the globals that the procedure 
+ * writes, and it may write any global. The parameters and the variables 
+ * declared by a procedure are kept in its frame, which calls leave alone 
+ * and which is gone once it returns. Nothing is live where the program ends.
+ * Arrays, constants and the addresses of array elements are never given
+ * an interval.
+ */
+class LiveIntervals {
+public:
+    LiveIntervals() = delete;
+
+    /**
+     * @param blocks The blocks of the procedure in the order of the code.
+     * @param graphEntry The block that starts the control flow graph that 
+     * the procedure belongs to, from which its loops are found.
+     */
+    LiveIntervals(const std::vector<BBP> &blocks, const BBP graphEntry);
+
+    /** @return The intervals ordered by variable name. */
+    const std::vector<live_interval_t> &getIntervals() const;
+
+    /**
+     * @param variable A variable with an interval.
+     * @return The interval of the variable.
+     */
+    const live_interval_t &getInterval(const std::string &variable) const;
+
+    /**
+     * @param block A block of the procedure.
+     * @return The variables with intervals that are live into the block,
+     * ordered by name.
+     */
+    std::vector<std::string> getLiveIn(const BBP block) const;
+
+    /**
+     * @param block A block of the procedure.
+     * @return True if control may enter the procedure at the block.
+     */
+    bool isEntry(const BBP block) const;
+
+    /**
+     * @param block A block of the procedure.
+     * @return True if control may leave the procedure from the block.
+     */
+    bool isExit(const BBP block) const;
+
+    /**
+     * @param block A block of the procedure.
+     * @param variable A variable that may be held in a register.
+     * @return True if the variable is read after control leaves the block.
+     */
+    bool isLiveOut(const BBP block, const std::string &variable) const;
+
+    /**
+     * @param variable A variable.
+     * @return True if the variable may be held in a register, which makes 
+     * its liveness known.
+     */
+    bool isVariable(const std::string &variable) const;
+
+    /**
+     * @param variable A variable.
+     * @return True if the procedure writes the variable, else false.
+     */
+    bool isDefined(const std::string &variable) const;
+
+    /**
+     * @param variable A variable with an interval.
+     * @param position The position of a call.
+     * @return True if the variable is read after the call returns.
+     */
+    bool isLiveAfterCall(
+        const std::string &variable, 
+        const unsigned int position
+    ) const;
+
+    /**
+     * @param block A block of the procedure.
+     * @return The number of natural loops that contain the block.
+     */
+    unsigned int getLoopDepth(const BBP block) const;
+
+    /** @return The blocks of the procedure in the order of the code. */
+    const std::vector<BBP> &getBlocks() const;
+
+    /**
+     * @return The variables that may be held in registers, ordered by name.
+     * Their positions index the sets of live variables.
+     */
+    const std::vector<std::string> &getVariables() const;
+
+    /**
+     * @param block A block of the procedure.
+     * @return The variables live into the block.
+     */
+    const BitVector &getLiveInSet(const BBP block) const;
+
+    /**
+     * Calls an action on each variable that an instruction reads or writes, 
+     * with the variables read before the variable written.
+     * @param inst An instruction of the procedure.
+     * @param action The action, given the index of the variable and whether 
+     * it is written.
+     */
+    void forEachVariable(
+        const tac_line_t &inst,
+        const std::function<void(const size_t, const bool)> &action
+    ) const;
+
+    /**
+     * Walks the instructions of a block from last to first.
+     * @param block A block of the procedure.
+     * @param action The action, given each instruction, its position and 
+     * the variables live after it.
+     */
+    void forEachLivePoint(
+        const BBP block,
+        const std::function<void(
+            const tac_line_t &, 
+            const unsigned int, 
+            const BitVector &
+        )> &action
+    ) const;
+
+    /** @return The position of the first instruction of the block. */
+    unsigned int getFirstPosition(const BBP block) const;
+
+    /** @return The position of the last instruction of the block. */
+    unsigned int getLastPosition(const BBP block) const;
+private:
+    void numberInstructions();
+    void findVariables();
+    void computeLiveness();
+    void buildIntervals();
+    void findLiveAfterCalls();
+    void findLoops(const BBP graphEntry);
+
+    bool isCandidate(const tac_line_t &inst, const std::string &name);
+
+    std::vector<BBP> blocks;
+    std::map<BBP, size_t> blockIndices;
+    std::vector<unsigned int> firstPositions;
+    std::vector<unsigned int> lastPositions;
+    std::vector<unsigned int> callPositions;
+
+    std::vector<bool> entries;
+    std::vector<bool> exits;
+    // Entries that can also be reached from within the procedure.
+    std::vector<bool> reentered;
+
+    // The addresses of array elements computed by the procedure.
+    std::set<std::string> addresses;
+    std::map<std::string, bool> candidates;
+
+    // The variables are numbered in the order of their names.
+    std::vector<std::string> names;
+    std::map<std::string, size_t> nameIndices;
+    std::vector<register_type_t> types;
+    BitVector userVariables;
+    // The user variables that are not kept in the frame of the procedure.
+    BitVector globals;
+    BitVector defined;
+
+    std::vector<BitVector> liveIn;
+    std::vector<BitVector> liveOut;
+
+    std::vector<live_interval_t> intervals;
+    std::map<std::string, size_t> intervalIndices;
+
+    std::map<unsigned int, BitVector> liveAfterCalls;
+    std::vector<unsigned int> loopDepths;
+};
+
+#endif
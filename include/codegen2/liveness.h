@@ -9,19 +9,24 @@
 #define LIVENESS_H__
 
 #include <map>
+#include <utility>
+#include <vector>
 #include <3ac.h>
+#include <symbol_map.h>
 #include <optimizer/basic_block.h>
 
 #define NEVER_USED (-1)
 
 using STID = signed int;
 
+class LiveIntervals;
+
 /** Liveness holds liveness and next-use informaion for a single variable. */
 class Liveness {
 public:
     bool isLive() const { return this->live; }
     STID getNextUse() const { return this->next_use; }
-    void setLive(const bool Live) { this->live = live; }
+    void setLive(const bool live) { this->live = live; }
     void setNextUse(const STID nextUse) { this->next_use = nextUse; }
 
     std::string to_string() const { 
@@ -40,15 +45,15 @@ class LivenessMap {
 public:
     LivenessMap();
 
-    bool isLive(const std::string &name) const;
-    bool hasNextUse(const std::string &name) const;
-    STID getNextUse(const std::string &name) const;
-    Liveness &getEntry(const std::string &name);
-    void putEntry(const std::string &name, const Liveness &liveness);
+    bool isLive(const Symbol &name) const;
+    bool hasNextUse(const Symbol &name) const;
+    STID getNextUse(const Symbol &name) const;
+    Liveness &getEntry(const Symbol &name);
+    void putEntry(const Symbol &name, const Liveness &liveness);
 
     std::string to_string() const;
 private:
-    std::map<std::string, Liveness> entries;
+    SymbolMap<Liveness> entries;
 };
 
 /**
@@ -63,8 +68,12 @@ public:
     /**
      * Computes the liveness and next-use information for all instructions 
      * that need to utilize registers within the basic block.
+     *
+     * @param bb The basic block.
+     * @param intervals The liveness of the variables across the blocks of 
+     * the procedure that contains the block.
      */
-    LivenessTable(const BBP bb);
+    LivenessTable(const BBP bb, const LiveIntervals &intervals);
 
     /**
      * Fetches the LivenessMap associated with an instrution in the basic block.
@@ -81,12 +90,47 @@ public:
      * @param variable The variable to check.
      * @return True if the variable is updated, else false.
      */
-    bool isUpdated(const std::string &variable) const;
+    bool isUpdated(const Symbol &variable) const;
+
+    /**
+     * Determines if the value of a variable is read after control leaves the 
+     * block, which is when it must be kept in memory.
+     * 
+     * @param variable The variable to check.
+     * @return True if the variable is live out of the block, else false.
+     */
+    bool isLiveOut(const Symbol &variable) const;
+
+    /**
+     * Finds the next read of the value a variable holds, which is how long 
+     * the value is needed for within the block.
+     * 
+     * @param index The position of an instruction in the block.
+     * @param variable The variable to check.
+     * @return The position of the first instruction from the given one on 
+     * that reads the variable, or NEVER_USED if the variable is written or 
+     * the block ends first.
+     */
+    STID getNextRead(const size_t index, const Symbol &variable) const;
+
+    /**
+     * Determines if the value a variable holds is needed once an instruction 
+     * is done, such as across the call the instruction makes.
+     * 
+     * @param index The position of an instruction in the block.
+     * @param variable The variable to check.
+     * @return True if the variable is read after the instruction before it 
+     * is written, or is live out of the block and never accessed after the 
+     * instruction.
+     */
+    bool isLiveAfter(const size_t index, const Symbol &variable) const;
 private:
     /**
      * Algorithm to compute liveness:
-     * 1. Set all user variables as live, temp variables as dead, and all having
-     * no next use in a table.
+     * 1. Set the variables live out of the block as live, the others as dead, 
+     * and all having no next use in a table. Variables that are never held 
+     * in registers across blocks are assumed live if they are user 
+     * variables and dead if they are temps.
      * 2. Iterate through all 3AC statements in the block in reverse, do
      * a. Look at liveness and next-use information in the table and attach 
      * them to the current instruction.
@@ -95,48 +139,58 @@ private:
      */
     void computeLiveness(const BBP bb);
 
+    void recordAccess(
+        const size_t index, 
+        const Symbol &variable, 
+        const bool write
+    );
+
     void defaultTable(
-        std::map<std::string, Liveness> &table, 
+        SymbolMap<Liveness> &table, 
         const BBP bb
     ) const;
 
     void tryInsertTableEntry(
-        std::map<std::string, Liveness> &table, 
-        const std::string variable
+        SymbolMap<Liveness> &table, 
+        const Symbol &variable
     ) const;
 
-    Liveness getLivenessForVariable(const std::string &name) const;
+    Liveness getLivenessForVariable(const Symbol &name) const;
 
-    Liveness getUserVarDefaultLiveness(const std::string &name) const;
+    Liveness getUserVarDefaultLiveness(const Symbol &name) const;
 
-    Liveness getTempVarDefaultLiveness(const std::string &name) const;
+    Liveness getTempVarDefaultLiveness(const Symbol &name) const;
 
     void attachLivenessAndNextUse(
-        std::map<std::string, Liveness> &table, 
+        SymbolMap<Liveness> &table, 
         const STID &tid, 
-        const std::string &variable
+        const Symbol &variable
     );
 
     void insert(
         const STID &tid, 
-        const std::string &variable, 
+        const Symbol &variable, 
         const Liveness &liveness
     );
 
     void updateOperand(
         const STID &tid,
-        std::map<std::string, Liveness> &table, 
-        const std::string &variable
+        SymbolMap<Liveness> &table, 
+        const Symbol &variable
     ) const;
 
     void updateResult(
         const STID &tid,
-        std::map<std::string, Liveness> &table, 
-        const std::string &variable
+        SymbolMap<Liveness> &table, 
+        const Symbol &variable
     ) const;
 
     std::map<TID, LivenessMap> table;
+    // The positions at which each variable is read or written, in order, 
+    // with a read before a write at the same position.
+    SymbolMap<std::vector<std::pair<size_t, bool>>> accesses;
     const BBP block;
+    const LiveIntervals &intervals;
 };
 
 #endif
\ No newline at end of file
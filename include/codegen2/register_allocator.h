@@ -0,0 +1,143 @@
+/**
+ * Contains the allocators that give the variables of a procedure registers
+ * that they keep across the blocks of the procedure.
+ *
+ * @file register_allocator.h
+ * @author Dalton Caron
+ */
+#ifndef REGISTER_ALLOCATOR_H__
+#define REGISTER_ALLOCATOR_H__
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include <codegen2/interference_graph.h>
+#include <codegen2/live_intervals.h>
+#include <codegen2/registers.h>
+
+/**
+ * Chooses the register that holds each variable of a procedure for the
+ * whole of its live interval. Variables that are not given a register are
+ * kept in memory and loaded by the code generator as each block needs them.
+ */
+class RegisterAllocator {
+public:
+    virtual ~RegisterAllocator();
+
+    /**
+     * @param liveness The liveness of the variables of the procedure.
+     * @param intervals The live intervals of the variables to allocate.
+     * @return The register of each variable that is given one.
+     */
+    virtual std::map<std::string, RegPtr> allocate(
+        const LiveIntervals &liveness,
+        const std::vector<live_interval_t> &intervals
+    ) = 0;
+};
+
+/**
+ * Allocates registers in a single pass over the intervals ordered by their
+ * start, as described by Poletto and Sarkar. When every register is taken,
+ * the interval that ends last is left in memory.
+ */
+class LinearScanAllocator : public RegisterAllocator {
+public:
+    std::map<std::string, RegPtr> allocate(
+        const LiveIntervals &liveness,
+        const std::vector<live_interval_t> &intervals
+    ) override;
+private:
+    void allocateType(
+        const std::vector<live_interval_t> &intervals,
+        const register_type_t type,
+        std::map<std::string, RegPtr> &allocation
+    ) const;
+};
+
+/** Where each variable of the graph being colored is. */
+typedef enum coloring_node_state {
+    NODE_SIMPLIFY = 0,
+    NODE_FREEZE,
+    NODE_SPILL,
+    NODE_COALESCED,
+    NODE_SELECTED
+} coloring_node_state_t;
+
+/** Where each copy of the graph being colored is. */
+typedef enum coloring_move_state {
+    MOVE_WORKLIST = 0,
+    MOVE_ACTIVE,
+    MOVE_COALESCED,
+    MOVE_CONSTRAINED,
+    MOVE_FROZEN
+} coloring_move_state_t;
+
+/**
+ * Allocates registers by coloring the interference graph of the procedure, 
+ * coalescing the variables of copies where that keeps the graph colorable, 
+ * as described by George and Appel. The variables left in memory are those 
+ * that are cheapest to spill for the number of variables they interfere 
+ * with, so that variables used within loops are the last to be spilled.
+ */
+class GraphColoringAllocator : public RegisterAllocator {
+public:
+    std::map<std::string, RegPtr> allocate(
+        const LiveIntervals &liveness,
+        const std::vector<live_interval_t> &intervals
+    ) override;
+private:
+    void allocateType(
+        const LiveIntervals &liveness,
+        const InterferenceGraph &graph,
+        const std::vector<live_interval_t> &intervals,
+        const register_type_t type,
+        std::map<std::string, RegPtr> &allocation
+    );
+
+    void build(
+        const LiveIntervals &liveness,
+        const InterferenceGraph &graph,
+        const std::vector<size_t> &variables
+    );
+    void makeWorklist();
+    void simplify();
+    void coalesce();
+    void freeze();
+    void selectSpill();
+    std::vector<int> assignColors() const;
+
+    std::vector<size_t> adjacent(const size_t node) const;
+    std::vector<size_t> nodeMoves(const size_t node) const;
+    bool isMoveRelated(const size_t node) const;
+    void addEdge(const size_t a, const size_t b);
+    void decrementDegree(const size_t node);
+    void enableMoves(const size_t node);
+    void addWorklist(const size_t node);
+    bool isConservative(const std::vector<size_t> &nodes) const;
+    size_t getAlias(const size_t node) const;
+    void combine(const size_t u, const size_t v);
+    void freezeMoves(const size_t node);
+    void setNodeState(const size_t node, const coloring_node_state_t state);
+
+    // The number of registers that may be given out.
+    size_t colors;
+
+    std::vector<std::set<size_t>> adjacency;
+    std::vector<size_t> degrees;
+    std::vector<double> costs;
+    std::vector<size_t> aliases;
+    std::vector<coloring_node_state_t> nodeStates;
+    std::set<size_t> simplifyWorklist;
+    std::set<size_t> freezeWorklist;
+    std::set<size_t> spillWorklist;
+    std::vector<size_t> selectStack;
+
+    std::vector<std::pair<size_t, size_t>> moves;
+    std::vector<coloring_move_state_t> moveStates;
+    std::vector<std::vector<size_t>> moveLists;
+    std::set<size_t> worklistMoves;
+};
+
+#endif
@@ -58,8 +58,37 @@ class RegisterAllocationTable;
 class Registers {
 public:
     Registers() = delete;
+
+    /**
+     * @param type The type of registers.
+     * @return The registers that may hold a variable across blocks, leaving 
+     * out the registers that instructions and calls use as scratch space.
+     */
+    static std::vector<RegPtr> getAllocatableRegisters(
+        const register_type_t &type
+    );
+
+    /**
+     * @param reg A register.
+     * @return True if a called procedure gives the register back holding 
+     * the value it had, which holds for rbx and r12 through r15.
+     */
+    static bool isCalleeSaved(const RegPtr &reg);
+
+    /** @return The registers the first arguments of a call are passed in. */
+    static const std::vector<RegPtr> &getArgumentRegisters();
+
+    /** @return The register a procedure returns its value in. */
+    static RegPtr getReturnRegister();
+
+    /** 
+     * @return The registers that hold the low and the high half of a wide 
+     * product or dividend.
+     */
+    static std::pair<RegPtr, RegPtr> getWideRegisters();
 private:
     static std::set<RegPtr> &selectRegisters(const register_type_t &type);
+    static RegPtr findRegister(const std::string &name);
 
     static std::set<RegPtr> generalPurposeRegisters;
     static std::set<RegPtr> vectorRegisters;
@@ -78,11 +107,33 @@ public:
 
     void setRegisterValue(RegPtr reg, const std::string &value);
 
+    /**
+     * Keeps registers that hold allocated variables from being handed out 
+     * as unused registers or chosen to be spilled.
+     * @param reserved The registers to keep.
+     */
+    void setReserved(const std::set<RegPtr> &reserved);
+
+    /** @return The registers kept from being handed out or spilled. */
+    const std::set<RegPtr> &getReserved() const;
+
     bool atLeastOneRegisterUnused(const register_type_t &type) const;
 
     RegPtr getUnusedRegister(const register_type_t &type) const;
 
-    RegPtr getARegisterInUse(const register_type_t &type) const;
+    /**
+     * @param type The type of register.
+     * @return An unused register that called procedures keep, or null if 
+     * there is none.
+     */
+    RegPtr getUnusedCalleeSavedRegister(const register_type_t &type) const;
+
+    /**
+     * @param type The type of register.
+     * @return The registers of the type that hold a value and may be 
+     * spilled, in the order they are handed out.
+     */
+    std::vector<RegPtr> getRegistersInUse(const register_type_t &type) const;
 
     std::string getVariableInRegister(RegPtr reg) const;
 
@@ -92,9 +143,17 @@ public:
 
     std::set<RegPtr> getAllRegistersInUse();
 
+    /** 
+     * @return Every register that has been given a value, including those 
+     * freed since.
+     */
+    const std::set<RegPtr> &getRegistersWritten() const;
+
     std::string to_string() const;
 private:
     std::map<RegPtr, std::string> registerTable;
+    std::set<RegPtr> reserved;
+    std::set<RegPtr> written;
 };
 
 #endif
\ No newline at end of file
@@ -1,45 +1,98 @@
 /**
- * The stack table file contains the StackTable class and is responsible for 
+ * The stack table file contains the StackTable class and is responsible for
  * tracking what is on the stack at all times.
- * 
+ *
  * @file stack_table.h
  * @author Dalton Caron
  */
 #ifndef STACK_TABLE_H__
 #define STACK_TABLE_H__
 
-#include <stack>
 #include <map>
 #include <string>
 
-using StackAddr = unsigned int;
+using StackAddr = signed int;
 
 /**
- * The stack table simulates the program stack that is a feature of the 
- * x86_64 runtime. 
+ * The stack table lays out the frame of a procedure, which is addressed from
+ * the frame pointer %rbp. The variables of the frame are below the saved
+ * frame pointer at negative offsets, and the arguments passed on the stack
+ * are above the return address at positive offsets.
+ *
+ * The stack is kept aligned to 32 bytes where procedures are called, so the
+ * offsets of the frame are chosen relative to that alignment. This lets
+ * vector registers and arrays be given slots that are aligned to 32 bytes.
  */
 class StackTable {
 public:
-    StackTable();
-
-    StackAddr allocate(const std::string &variable, unsigned int size);
+    /** The alignment of the stack where a procedure is called. */
+    static const unsigned int STACK_ALIGNMENT = 32;
 
-    void resetToPreviousBaseAddress();
+    /**
+     * Constructs the table of a frame outside of any procedure, which is
+     * built on a stack aligned to 32 bytes.
+     */
+    StackTable();
 
+    /**
+     * Starts the frame of a procedure, which is entered with the return
+     * address pushed on the aligned stack of its caller.
+     */
     void newBaseAddress();
 
+    /** @return True if no procedure has been entered, else false. */
     bool inGlobalScope() const;
 
+    /**
+     * Gives a variable a slot in the frame.
+     * @param variable The variable.
+     * @param size The size of the variable in bytes.
+     * @param alignment The alignment of the slot, which divides 32.
+     * @return The offset of the slot from the frame pointer.
+     */
+    StackAddr allocate(
+        const std::string &variable,
+        unsigned int size,
+        unsigned int alignment=8
+    );
+
+    /**
+     * Records a variable passed on the stack by the caller.
+     * @param variable The variable.
+     * @param address The offset of the variable from the frame pointer.
+     */
+    void insertArgument(const std::string &variable, StackAddr address);
+
     bool inStack(const std::string &variable) const;
 
     StackAddr getAddress(const std::string &variable) const;
+
+    /** @return The bytes of stack taken by the variables of the frame. */
+    unsigned int getStackSize() const;
+
+    /**
+     * @return The number of bytes to lower the stack pointer by below the
+     * frame pointer, which covers the variables of the frame and leaves the
+     * stack aligned.
+     */
+    unsigned int getFrameSize() const;
 private:
-    void clearVarsInStackToBaseAddress();
+    /**
+     * @param size A number of bytes below the frame pointer.
+     * @param alignment The alignment wanted.
+     * @return The least number of bytes no less than the size at which the
+     * address below the frame pointer has the alignment.
+     */
+    unsigned int alignBelowBase(
+        const unsigned int size,
+        const unsigned int alignment
+    ) const;
 
-    StackAddr baseAddress;
+    bool procedure;
+    // How far the frame pointer is above an aligned address of the stack.
+    unsigned int baseAddress;
     unsigned int stackSize;
-    std::stack<StackAddr> prevBaseAddresses;
-    std::map<std::string, unsigned int> varsInStack;
+    std::map<std::string, StackAddr> varsInStack;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -29,5 +29,41 @@
 #define STATIC_ASSERTIONS_ENABLED 1
 
 extern bool AUTOMATIC_VECTORIZATION_ENABLED;
+extern bool LOOP_UNSWITCHING_ENABLED;
+extern bool LOOP_UNROLLING_ENABLED;
+extern bool LOOP_ROTATION_ENABLED;
+extern bool SSA_ENABLED;
+extern bool SCCP_ENABLED;
+extern bool GVN_ENABLED;
+extern bool COPY_PROPAGATION_ENABLED;
+extern bool DCE_ENABLED;
+extern bool INLINING_ENABLED;
+extern bool TAIL_CALLS_ENABLED;
+
+// The -O level, which enables the passes registered at or below it.
+extern unsigned int OPTIMIZATION_LEVEL;
+// The comma separated passes given by --passes, or null if not given.
+extern char *PASS_PIPELINE;
+// The number of threads that optimize and translate the procedures, from -j.
+extern unsigned int JOBS;
+// Whether the time and memory used by each phase is reported on exit.
+extern bool TIME_REPORT_ENABLED;
+// Whether the report is printed as JSON instead of as a table.
+extern bool TIME_REPORT_JSON;
+
+// The ways registers may be allocated, chosen with --regalloc.
+typedef enum register_allocator_kind {
+    // Registers are handed out within each block and spilled at its end.
+    REGALLOC_LOCAL = 0,
+    // Variables keep a register across the blocks of a procedure, chosen 
+    // by a linear scan of their live intervals.
+    REGALLOC_LINEAR,
+    // Variables keep a register across the blocks of a procedure, chosen 
+    // by coloring their interference graph. The default at -O2.
+    REGALLOC_GRAPH
+} register_allocator_kind_t;
+
+// The register allocator used by the code generator.
+extern register_allocator_kind_t REGISTER_ALLOCATOR;
 
 #endif
\ No newline at end of file
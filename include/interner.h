@@ -0,0 +1,151 @@
+/**
+ * This file contains the string interner, which stores a single copy of every
+ * name used by the three address code and identifies it by a small integer.
+ *
+ * @file interner.h
+ * @author Dalton Caron
+ */
+#ifndef INTERNER_H__
+#define INTERNER_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/** Identifies an interned string. The empty string is always 0. */
+typedef uint32_t SymbolId;
+
+/** The ID of the empty string. */
+#define EMPTY_SYMBOL 0
+
+/**
+ * Maps strings to IDs and back. A string is given an ID the first time it is
+ * interned, and keeps it for the rest of the program. Strings may be interned
+ * and looked up from any thread.
+ */
+class Interner {
+public:
+    /**
+     * @param name The string to intern.
+     * @return The ID of the string.
+     */
+    static SymbolId intern(const std::string &name);
+
+    /**
+     * @param id The ID of an interned string.
+     * @return The interned string, which is never moved or destroyed.
+     */
+    static const std::string &lookup(const SymbolId id);
+
+    /** @return The number of interned strings, which bounds every ID. */
+    static size_t size();
+};
+
+/**
+ * An interned name, such as an operand of a three address code. A symbol is
+ * as small as its ID and compares for equality in constant time, while it
+ * can still be used in place of the string it represents.
+ *
+ * Symbols are ordered by their strings, so that containers of symbols and
+ * of strings are ordered the same way.
+ */
+class Symbol {
+public:
+    /** Constructs the empty symbol. */
+    Symbol() : symbolId(EMPTY_SYMBOL) {}
+
+    Symbol(const std::string &name) : symbolId(Interner::intern(name)) {}
+
+    Symbol(const char *name) : symbolId(Interner::intern(name)) {}
+
+    /** @return The ID of the symbol. */
+    SymbolId id() const { return this->symbolId; }
+
+    /** @return The string the symbol represents. */
+    const std::string &str() const { return Interner::lookup(this->symbolId); }
+
+    operator const std::string &() const { return this->str(); }
+
+    // The string operations used on names.
+    const char *c_str() const { return this->str().c_str(); }
+    size_t size() const { return this->str().size(); }
+    size_t length() const { return this->str().length(); }
+    bool empty() const { return this->symbolId == EMPTY_SYMBOL; }
+    char operator[](const size_t index) const { return this->str()[index]; }
+    char at(const size_t index) const { return this->str().at(index); }
+    std::string substr(const size_t pos, const size_t n = std::string::npos)
+        const { return this->str().substr(pos, n); }
+    size_t find(const std::string &s, const size_t pos = 0) const {
+        return this->str().find(s, pos);
+    }
+    size_t find(const char c, const size_t pos = 0) const {
+        return this->str().find(c, pos);
+    }
+    int compare(const std::string &s) const { return this->str().compare(s); }
+    std::string::const_iterator begin() const { return this->str().begin(); }
+    std::string::const_iterator end() const { return this->str().end(); }
+
+    /** Replaces the symbol with the symbol of its string and a suffix. */
+    Symbol &operator+=(const std::string &suffix) {
+        this->symbolId = Interner::intern(this->str() + suffix);
+        return *this;
+    }
+private:
+    SymbolId symbolId;
+};
+
+inline bool operator==(const Symbol &a, const Symbol &b) {
+    return a.id() == b.id();
+}
+inline bool operator==(const Symbol &a, const std::string &b) {
+    return a.str() == b;
+}
+inline bool operator==(const std::string &a, const Symbol &b) {
+    return a == b.str();
+}
+inline bool operator==(const Symbol &a, const char *b) {
+    return a.str() == b;
+}
+inline bool operator==(const char *a, const Symbol &b) {
+    return a == b.str();
+}
+
+inline bool operator!=(const Symbol &a, const Symbol &b) { return !(a == b); }
+inline bool operator!=(const Symbol &a, const std::string &b) {
+    return !(a == b);
+}
+inline bool operator!=(const std::string &a, const Symbol &b) {
+    return !(a == b);
+}
+inline bool operator!=(const Symbol &a, const char *b) { return !(a == b); }
+inline bool operator!=(const char *a, const Symbol &b) { return !(a == b); }
+
+inline bool operator<(const Symbol &a, const Symbol &b) {
+    return a.id() != b.id() && a.str() < b.str();
+}
+
+inline std::string operator+(const Symbol &a, const std::string &b) {
+    return a.str() + b;
+}
+inline std::string operator+(const std::string &a, const Symbol &b) {
+    return a + b.str();
+}
+inline std::string operator+(const Symbol &a, const char *b) {
+    return a.str() + b;
+}
+inline std::string operator+(const char *a, const Symbol &b) {
+    return a + b.str();
+}
+inline std::string operator+(const Symbol &a, const char b) {
+    return a.str() + b;
+}
+inline std::string operator+(const char a, const Symbol &b) {
+    return a + b.str();
+}
+
+inline std::ostream &operator<<(std::ostream &stream, const Symbol &symbol) {
+    return stream << symbol.str();
+}
+
+#endif
@@ -11,13 +11,20 @@
 #define BASIC_BLOCK_H__
 
 #include <3ac.h>
+#include <symbol_map.h>
 
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <set>
 
 class BasicBlock;
+class BlockArena;
 
-using BBP = std::shared_ptr<BasicBlock>;
+// Blocks are owned by the BlockArena they were created in, which outlives 
+// every pointer to them.
+using BBP = BasicBlock *;
 
 auto inline set_id_cmp = [](tac_line_t a, tac_line_t b) { 
     return a.bid < b.bid; 
@@ -38,12 +45,46 @@ public:
     /** Number of functions that exist in the global basic block collection. */
     static unsigned int functionCount;
 
-    /** A set of all variables defined in basic blocks. */
+    /** 
+     * A set of all variables defined in basic blocks. Blocks are created 
+     * from several threads while optimizing, so the set must be used through 
+     * copyGlobalVarDefinitions while graphs are being optimized.
+     */
     static TIDSet globalVarDefinitions;
 
+    /** @return A copy of the set of all variables defined in basic blocks. */
+    static TIDSet copyGlobalVarDefinitions();
+
+    /** @return The minor ID of the next block the calling thread creates. */
+    static unsigned int getNextMinorId();
+
+    /**
+     * Sets the minor ID of the next block the calling thread creates. Each 
+     * thread gives out minor IDs separately, so that threads optimizing 
+     * different graphs can be given separate ranges of IDs.
+     * @param next The minor ID of the next block.
+     */
+    static void setNextMinorId(const unsigned int next);
+
+    /**
+     * Changes the IDs of the instructions in the set of all variables 
+     * defined in basic blocks.
+     * @param renumber Maps each ID to its new ID, keeping their order.
+     */
+    static void renumberGlobalVarDefinitions(
+        const std::function<TID(TID)> &renumber
+    );
+
     /** Constructs a basic block with a unique major ID. */
     BasicBlock();
 
+    /**
+     * Constructs an empty basic block that is ordered after all existing 
+     * blocks sharing the provided major ID.
+     * @param majorId The major ID of the new basic block.
+     */
+    BasicBlock(const unsigned int majorId);
+
     /**
      * BasicBlock copy constructor.
      * @param newMajorId The new major ID of the basic block.
@@ -61,6 +102,28 @@ public:
     );
     void removeInstruction(const tac_line_t instruction);
 
+    /**
+     * Recomputes the control flow flags and def/use chains of the block. Must 
+     * be called after the instruction vector is modified in place.
+     */
+    void recomputeInstructionInfo();
+
+    /**
+     * Changes the IDs of the instructions of the block, including the 
+     * copies kept by the def/use chains and the gen and kill sets.
+     * @param renumber Maps each ID to its new ID, keeping their order.
+     */
+    void renumberInstructions(const std::function<TID(TID)> &renumber);
+
+    /**
+     * Appends the instructions of the only successor of this block onto this 
+     * block and takes over the successors of said successor. The leading 
+     * label of the successor and any jump to it are dropped. The successor 
+     * must be removed from the block collection by the caller.
+     * @param successor The successor to absorb.
+     */
+    void mergeWithSuccessor(BBP successor);
+
     void insertPredecessor(BBP block);
     void insertPredecessors(std::vector<BBP> predecessors);
     void clearPredecessors();
@@ -76,17 +139,25 @@ public:
     const std::vector<BBP> &getPredecessors();
 
     unsigned int getID() const;
+    /** @return The index of the block within the arena that owns it. */
+    uint32_t getIndex() const;
     unsigned int getMinorId() const;
     void setMinorId(const unsigned int mid);
+
+    /**
+     * Gives the block a new minor ID that orders it after all existing blocks 
+     * sharing its major ID. The block must not be in a block set.
+     */
+    void renewMinorId();
     bool getHasProcedureCall() const;
     bool getHasEnterProcedure() const;
     bool getHasExitProcedure() const;
     bool blockEndsWithUnconditionalJump() const;
     bool changesControlAtEnd() const;
-    TIDSet getGenSet() const;
-    TIDSet getKillSet() const;
-    const std::map<std::string, std::vector<tac_line_t>> &getDefChain() const;
-    const std::map<std::string, std::vector<tac_line_t>> &getUseChain() const;
+    const TIDSet &getGenSet() const;
+    const TIDSet &getKillSet() const;
+    const SymbolMap<std::vector<tac_line_t>> &getDefChain() const;
+    const SymbolMap<std::vector<tac_line_t>> &getUseChain() const;
     const tac_line_t &getFirstLabel() const;
     bool isNeverDefined(const std::string &variable) const;
 
@@ -95,11 +166,17 @@ public:
     std::string id_to_string() const;
     std::string to_string() const;
 private:
+    friend class BlockArena;
+
+    void recordInstruction(const tac_line_t &instruction);
+
     static unsigned int basicBlockIdGenerator;
-    static unsigned int minorIdGenerator;
+    static thread_local unsigned int minorIdGenerator;
+    static std::mutex globalVarDefinitionsLock;
 
     unsigned int id;
     unsigned int minorId;
+    uint32_t index = 0;
     bool hasProcedureCall;
     bool hasEnterProcedure;
     bool hasExitProcedure;
@@ -114,8 +191,8 @@ private:
     TIDSet killed;
 
     std::set<std::string> variableAssignments;
-    std::map<std::string, std::vector<tac_line_t>> defChain;
-    std::map<std::string, std::vector<tac_line_t>> useChain;
+    SymbolMap<std::vector<tac_line_t>> defChain;
+    SymbolMap<std::vector<tac_line_t>> useChain;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,94 @@
+/**
+ * This file contains a dense set of small integers, used by the dataflow
+ * analyses to represent sets of definitions, names and copies.
+ *
+ * @file bit_vector.h
+ * @author Dalton Caron
+ */
+#ifndef BIT_VECTOR_H__
+#define BIT_VECTOR_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * A fixed size set of the integers from 0 up to its size, stored as one bit
+ * per integer. Set operations work a word at a time, and both operands of a
+ * set operation must have the same size.
+ */
+class BitVector {
+public:
+    /** Constructs an empty vector of size 0. */
+    BitVector();
+
+    /**
+     * Constructs a vector of the provided size.
+     * @param size The number of bits in the vector.
+     * @param value The value of every bit.
+     */
+    BitVector(const size_t size, const bool value = false);
+
+    /** @return The number of bits in the vector. */
+    size_t size() const;
+
+    /** @return The number of bits that are set. */
+    size_t count() const;
+
+    /** @return True if no bit is set. */
+    bool none() const;
+
+    /** @return True if the bit at the provided index is set. */
+    bool test(const size_t index) const;
+
+    /** Sets the bit at the provided index. */
+    void set(const size_t index);
+
+    /** Clears the bit at the provided index. */
+    void reset(const size_t index);
+
+    /** Sets every bit. */
+    void setAll();
+
+    /** Clears every bit. */
+    void resetAll();
+
+    /**
+     * Adds the bits of another vector to this vector.
+     * @return True if this vector changed.
+     */
+    bool unionWith(const BitVector &other);
+
+    /**
+     * Keeps only the bits of this vector that are set in another vector.
+     * @return True if this vector changed.
+     */
+    bool intersectWith(const BitVector &other);
+
+    /**
+     * Removes the bits of another vector from this vector.
+     * @return True if this vector changed.
+     */
+    bool subtract(const BitVector &other);
+
+    /**
+     * Calls an action on the index of each set bit in increasing order.
+     * @param action The function to call on each index.
+     */
+    void forEach(std::function<void(size_t index)> action) const;
+
+    bool operator==(const BitVector &other) const;
+    bool operator!=(const BitVector &other) const;
+
+    /** @return The bits in string form, with the lowest index first. */
+    std::string to_string() const;
+private:
+    void clearUnusedBits();
+
+    size_t bits;
+    std::vector<uint64_t> words;
+};
+
+#endif
@@ -0,0 +1,55 @@
+/**
+ * This file contains the arena that owns the basic blocks of a compilation
+ * unit.
+ *
+ * @file block_arena.h
+ * @author Dalton Caron
+ */
+#ifndef BLOCK_ARENA_H__
+#define BLOCK_ARENA_H__
+
+#include <optimizer/basic_block.h>
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+/**
+ * Owns every basic block created for a compilation unit. Blocks are stored
+ * in large chunks, never move once created, and are all freed together when
+ * the arena is destroyed, so the edges between blocks can be plain pointers.
+ *
+ * Each block is given an index that is unique within the arena and smaller
+ * than the size of the arena, so that analyses can keep per block data in
+ * flat arrays. Blocks may be created from several threads at once.
+ */
+class BlockArena {
+public:
+    BlockArena();
+
+    // Blocks point into the arena, so it is never copied.
+    BlockArena(const BlockArena &) = delete;
+
+    /**
+     * Constructs a basic block in the arena.
+     * @param args The arguments of a BasicBlock constructor.
+     * @return The new block, which lives as long as the arena.
+     */
+    template <typename... Args>
+    BBP create(Args &&...args) {
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->blocks.emplace_back(std::forward<Args>(args)...);
+        BBP block = &this->blocks.back();
+        block->index = this->blocks.size() - 1;
+        return block;
+    }
+
+    /** @return The number of blocks created, which bounds every index. */
+    uint32_t size() const;
+private:
+    mutable std::mutex lock;
+    std::deque<BasicBlock> blocks;
+};
+
+#endif
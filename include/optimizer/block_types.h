@@ -1,20 +1,106 @@
 /**
- * Contains types that depend on basic blocks but implement special 
+ * Contains types that depend on basic blocks but implement special
  * templated functionality.
- * 
+ *
  * @file block_types.h
  * @author Dalton Caron
  */
 #ifndef BLOCK_TYPES_H__
 #define BLOCK_TYPES_H__
 
-inline auto bb_cmp = [](BBP a, BBP b) { 
+#include <optimizer/basic_block.h>
+#include <optimizer/block_arena.h>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
+
+inline auto bb_cmp = [](BBP a, BBP b) {
     if (a->getID() == b->getID()) {
         return a->getMinorId() < b->getMinorId();
     }
     return a->getID() < b->getID();
 };
 
-using BlockSet = std::set<BBP, decltype(bb_cmp)>;
+/**
+ * The blocks of a compilation unit ordered by their position in the code,
+ * along with the arena that owns them. Blocks removed from the set stay
+ * allocated until the arena is destroyed with the last copy of the set.
+ *
+ * The graphs of a compilation unit are optimized in parallel while sharing
+ * the set, so blocks are only added, removed and looked up through the
+ * methods below, which may be called from several threads at once. The set
+ * may only be iterated while no graph is being optimized.
+ */
+class BlockSet {
+public:
+    typedef std::set<BBP, decltype(bb_cmp)>::const_iterator const_iterator;
+
+    BlockSet();
+
+    /** Copies the blocks of another set, sharing its arena. */
+    BlockSet(const BlockSet &other);
+    BlockSet &operator=(const BlockSet &other);
+
+    /**
+     * Constructs a basic block in the arena of the set. The block must be
+     * inserted into the set by the caller.
+     * @param args The arguments of a BasicBlock constructor.
+     * @return The new block.
+     */
+    template <typename... Args>
+    BBP create(Args &&...args) {
+        return this->arena->create(std::forward<Args>(args)...);
+    }
+
+    /** @return The number of blocks in the arena, which bounds every index. */
+    uint32_t getArenaSize() const;
+
+    /** @param block The block to add to the set. */
+    void insert(const BBP block);
+
+    /** @param block The block to remove from the set, if present. */
+    void erase(const BBP block);
+
+    /**
+     * Places a block created with the major ID of another block directly
+     * after it. The blocks that followed with the same major ID are given
+     * new minor IDs so that they follow the new block.
+     * @param block The block in the set to place the new block after.
+     * @param inserted The new block.
+     */
+    void insertAfter(const BBP block, const BBP inserted);
+
+    /**
+     * @param block A block in the set.
+     * @return The block following it in the code, or nullptr if it is last.
+     */
+    BBP getNext(const BBP block) const;
+
+    /**
+     * @param block A block in the set.
+     * @return The block preceding it in the code, or nullptr if it is first.
+     */
+    BBP getPrevious(const BBP block) const;
+
+    /**
+     * @param first A block in the set.
+     * @param count The most blocks to return.
+     * @return The block and the blocks following it in the code.
+     */
+    std::vector<BBP> getBlocksFrom(const BBP first, const size_t count) const;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    size_t size() const;
+    bool empty() const;
+private:
+    mutable std::mutex lock;
+    std::set<BBP, decltype(bb_cmp)> blocks;
+    std::shared_ptr<BlockArena> arena;
+};
 
-#endif
\ No newline at end of file
+#endif
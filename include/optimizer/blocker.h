@@ -62,6 +62,12 @@ private:
      */
     void computeControlFlowInformation();
 
+    /**
+     * Links the block to the blocks its jumps transfer control to.
+     * @param block The block to link.
+     */
+    void insertJumpEdges(BBP block);
+
     /**
      * @param line The instruction to evaluate.
      * @param followsJump True if the instruction is after a jump, else false.
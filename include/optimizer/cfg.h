@@ -31,11 +31,18 @@ public:
 
     /**
      * Computes the control flow graph.
-     * @param allBlocks The blocks to be contained within the CFG.
      * @param name A name to identify the CFG when printing.
      * @param firstBlock The entry point to the CFG.
     */
-    CFG(BlockSet &allBlocks, std::string &name, BBP firstBlock);
+    CFG(const std::string &name, BBP firstBlock);
+
+    /**
+     * Computes the analyses of the graph to describe it for debugging.
+     * @param allBlocks The collection of all basic blocks.
+     * @return The graph, its dominator tree, back edges, natural loops and 
+     * reaching definitions in string form.
+     */
+    std::string to_report(BlockSet &allBlocks);
 
     /**
      * Performs a post order traversal on the CFG, performing an action on each 
@@ -52,22 +59,32 @@ public:
 
     /** @return A Graphviz dot representation of the graph in stirng form. */
     std::string to_graph() const;
-private:
-    void computePostorderTraversalInternal(
-        BBP node, std::set<BBP> &visited, std::function<void(BBP block)> action
-    ) const;
 
+    /** @return The edges that lead back to a block visited before them. */
     std::set<std::pair<BBP, BBP>> computeBackwardsEdges();
 
+    /**
+     * Computes the natural loops of the graph.
+     * @param backedges The back edges of the graph.
+     * @param dominator The dominator tree of the graph.
+     * @param reach The reaching definitions of the graph.
+     * @param allBlocks The collection of all basic blocks.
+     * @return A natural loop for each back edge whose target dominates its 
+     * source. The loops point to the provided analyses.
+     */
     std::vector<NaturalLoop> computeNaturalLoops(
         std::set<std::pair<BBP, BBP>> backedges,
+        const Dominator *dominator,
+        const Reach *reach,
         BlockSet &allBlocks
     ) const;
+private:
+    void computePostorderTraversalInternal(
+        BBP node, std::set<BBP> &visited, std::function<void(BBP block)> action
+    ) const;
 
     std::string name;
     BBP entryBlock;
-    Dominator dominator;
-    Reach reach;
 };
 
 /**
@@ -0,0 +1,85 @@
+/**
+ * This file contains code that supports the propagation of copies through a
+ * control flow graph.
+ *
+ * @file copy_propagator.h
+ * @author Dalton Caron
+ */
+#ifndef COPY_PROPAGATOR_H__
+#define COPY_PROPAGATOR_H__
+
+#include <optimizer/basic_block.h>
+#include <optimizer/block_types.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+class CFG;
+
+// Copies in the form of (destination, source).
+typedef std::set<std::pair<std::string, std::string>> CopySet;
+
+/**
+ * Replaces uses of the destination of a copy with its source.
+ *
+ * Example:
+ * x := y
+ * L0: $t0 := x + 1
+ * z := $t0
+ * write z
+ * Becomes:
+ * x := y
+ * L0: $t0 := y + 1
+ * z := $t0
+ * write $t0
+ *
+ * A copy reaches a use if it is executed on every path to the use and
+ * neither of its names is defined after it on any of those paths. The
+ * copies reaching each block are found by a forwards dataflow analysis.
+ * Temporaries only live within the block that defines them, so copies
+ * involving temporaries are only propagated within their block.
+ *
+ * Copies whose destination is no longer used are left for dead code
+ * elimination.
+ */
+class CopyPropagator {
+public:
+    /**
+     * Constructs the copy propagator of a control flow graph.
+     * @param cfg The control flow graph to propagate copies through.
+     */
+    CopyPropagator(CFG *cfg);
+
+    /**
+     * Replaces the uses of names with the sources of the copies reaching
+     * them.
+     * @return True if a use was replaced, else false.
+     */
+    bool propagate();
+private:
+    void computeReachingCopies();
+    bool propagateInBlock(const BBP block);
+    void transfer(const tac_line_t &inst, CopySet &copies) const;
+    bool isCopy(const tac_line_t &inst) const;
+    bool isCopyOperand(
+        const tac_line_t &inst,
+        const std::string &name
+    ) const;
+
+    CFG *cfg;
+
+    // The reachable blocks of the graph in layout order.
+    std::vector<BBP> blocks;
+    // Temporaries that hold the address of an array element.
+    std::set<std::string> addresses;
+    // Every copy between variables in the graph.
+    CopySet universe;
+
+    // The copies reaching the start of each block.
+    std::map<BBP, CopySet> in;
+};
+
+#endif
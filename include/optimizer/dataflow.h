@@ -0,0 +1,117 @@
+/**
+ * This file contains a generic solver for dataflow analyses over the blocks
+ * of a control flow graph, where the facts are represented as bit vectors.
+ *
+ * @file dataflow.h
+ * @author Dalton Caron
+ */
+#ifndef DATAFLOW_H__
+#define DATAFLOW_H__
+
+#include <optimizer/basic_block.h>
+#include <optimizer/bit_vector.h>
+
+#include <map>
+#include <vector>
+
+class CFG;
+
+/** The direction in which facts flow through the graph. */
+typedef enum dataflow_direction {
+    // Facts flow from predecessors to successors, such as definitions.
+    DATAFLOW_FORWARD = 0,
+    // Facts flow from successors to predecessors, such as liveness.
+    DATAFLOW_BACKWARD
+} dataflow_direction_t;
+
+/** How the facts of the blocks flowing into a block are combined. */
+typedef enum dataflow_meet {
+    // A fact holds if it holds along any edge.
+    DATAFLOW_UNION = 0,
+    // A fact holds only if it holds along every edge.
+    DATAFLOW_INTERSECTION
+} dataflow_meet_t;
+
+/**
+ * Solves a dataflow problem whose transfer function for each block is
+ * result = gen U (input - kill), where the facts are numbered from 0 and
+ * stored as bit vectors.
+ *
+ * Only blocks reachable from the entry block are analyzed. The worklist
+ * visits blocks in reverse postorder for forwards problems and postorder
+ * for backwards problems, so that a block is usually visited after the
+ * blocks flowing into it.
+ *
+ * Example:
+ * DataflowSolver solver(cfg, DATAFLOW_FORWARD, DATAFLOW_UNION, size);
+ * solver.setTransfer(block, gen, kill);
+ * solver.solve();
+ * const BitVector &in = solver.getIn(block);
+ */
+class DataflowSolver {
+public:
+    /**
+     * @param cfg The control flow graph to analyze.
+     * @param direction The direction in which facts flow.
+     * @param meet How facts flowing into a block are combined.
+     * @param size The number of facts.
+     */
+    DataflowSolver(
+        CFG *cfg,
+        const dataflow_direction_t direction,
+        const dataflow_meet_t meet,
+        const size_t size
+    );
+
+    /**
+     * Sets the transfer function of a block. Blocks without a transfer
+     * function pass their facts through unchanged.
+     * @param block The block the function belongs to.
+     * @param gen The facts the block creates.
+     * @param kill The facts the block destroys.
+     */
+    void setTransfer(const BBP block, const BitVector &gen,
+        const BitVector &kill);
+
+    /**
+     * Sets the facts flowing into the entry block for forwards problems, or
+     * out of the blocks without successors for backwards problems. The
+     * boundary is empty by default.
+     * @param boundary The facts at the boundary of the graph.
+     */
+    void setBoundary(const BitVector &boundary);
+
+    /** Computes the facts at the start and end of every block. */
+    void solve();
+
+    /** @return The reachable blocks of the graph in reverse postorder. */
+    const std::vector<BBP> &getBlocks() const;
+
+    /**
+     * @param block A reachable block of the graph.
+     * @return The facts that hold at the start of the block.
+     */
+    const BitVector &getIn(const BBP block) const;
+
+    /**
+     * @param block A reachable block of the graph.
+     * @return The facts that hold at the end of the block.
+     */
+    const BitVector &getOut(const BBP block) const;
+private:
+    BitVector meetInputs(const unsigned int index) const;
+
+    dataflow_direction_t direction;
+    dataflow_meet_t meet;
+    size_t size;
+    BitVector boundary;
+
+    std::vector<BBP> blocks;
+    std::map<BBP, unsigned int> indices;
+    std::vector<BitVector> gen;
+    std::vector<BitVector> kill;
+    std::vector<BitVector> in;
+    std::vector<BitVector> out;
+};
+
+#endif
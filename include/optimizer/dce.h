@@ -0,0 +1,80 @@
+/**
+ * This file contains code that supports the elimination of dead code from a
+ * control flow graph.
+ *
+ * @file dce.h
+ * @author Dalton Caron
+ */
+#ifndef DCE_H__
+#define DCE_H__
+
+#include <optimizer/basic_block.h>
+#include <optimizer/block_types.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+class CFG;
+
+/**
+ * Removes instructions that compute values that are never used.
+ *
+ * Example:
+ * $t0 := a[i]
+ * x := 5
+ * x := i + 1
+ * write x
+ * Becomes:
+ * x := i + 1
+ * write x
+ *
+ * Names that are live at each point of the graph are found by a backwards
+ * dataflow analysis. Instructions without side effects whose results are
+ * not live are removed, which covers dead temporaries as well as stores to
+ * variables that are overwritten or never read again. Removing an
+ * instruction may make its operands dead, so this repeats until nothing
+ * changes.
+ *
+ * A procedure call may use any variable, and the caller may use any
+ * variable not declared by the procedure once it returns.
+ */
+class DCE {
+public:
+    /**
+     * Constructs the dead code eliminator of a control flow graph.
+     * @param cfg The control flow graph to eliminate dead code from.
+     * @param allBlocks A reference to the collection of all basic blocks.
+     */
+    DCE(CFG *cfg, BlockSet &allBlocks);
+
+    /**
+     * Removes dead instructions, along with blocks left empty. The CFG
+     * analyses are invalidated if a block is removed.
+     * @return True if an instruction was removed, else false.
+     */
+    bool eliminate();
+private:
+    void computeLiveness();
+    bool sweep();
+    void removeEmptyBlocks();
+    void transfer(const tac_line_t &inst, std::set<std::string> &live) const;
+    std::set<std::string> getLiveOut(const BBP block) const;
+
+    CFG *cfg;
+    BlockSet &allBlocks;
+
+    // The reachable blocks of the graph in layout order.
+    std::vector<BBP> blocks;
+    // Temporaries that hold the address of an array element.
+    std::set<std::string> addresses;
+    // Every variable accessed by the graph.
+    std::set<std::string> variables;
+    // Variables the graph does not declare, which outlive a procedure.
+    std::set<std::string> nonLocals;
+
+    std::map<BBP, std::set<std::string>> liveIn;
+};
+
+#endif
@@ -13,6 +13,7 @@
 #include <optimizer/basic_block.h>
 
 #include <map>
+#include <set>
 #include <vector>
 #include <string>
 
@@ -41,6 +42,27 @@ public:
      */
     bool dominates(const BBP a, const BBP b) const;
 
+    /**
+     * @param node The node to get the immediate dominator of.
+     * @return The immediate dominator of the node, which is the node itself 
+     * for the entry node, or nullptr if the node is unreachable.
+     */
+    BBP getImmediateDominator(const BBP node) const;
+
+    /**
+     * Computes the children of every node in the dominator tree.
+     * @return A mapping from each reachable node to its children.
+     */
+    std::map<BBP, std::vector<BBP>> computeDominatorTreeChildren() const;
+
+    /**
+     * Computes the dominance frontier of every reachable node. The dominance 
+     * frontier of a node d is the set of nodes n such that d dominates a 
+     * predecessor of n but does not strictly dominate n.
+     * @return A mapping from each reachable node to its dominance frontier.
+     */
+    std::map<BBP, std::set<BBP>> computeDominanceFrontiers() const;
+
     /** @return A graphical representation of the dominator tree. */
     std::string to_graph();
 private:
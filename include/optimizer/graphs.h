@@ -10,6 +10,9 @@
 
 #include <optimizer/cfg.h>
 #include <optimizer/block_types.h>
+#include <thread_pool.h>
+
+#include <vector>
 
 /** Computes and holds all control flow graphs for the program. */
 class Graphs {
@@ -19,11 +22,12 @@ public:
      * A CFG is constructed for the program entry point and all procedures. 
      * 
      * @param blocks The blocks to construct CFGs from.
+     * @param pool The threads that analyze the graphs to print them.
      */
-    Graphs(BlockSet &blocks);
+    Graphs(BlockSet &blocks, ThreadPool &pool);
 
-    /** @return All control flow graphs. */
-    const std::vector<CFG> &getAllGraphs();
+    /** @return All control flow graphs, starting with the entry point. */
+    std::vector<CFG *> getAllGraphs();
 
     /** @return The CFG representing the program entry point. */
     CFG &getEntry();
@@ -31,7 +35,7 @@ public:
     /** @return The CFGs representing all program procedures. */
     std::vector<CFG> &getProcedures();
 private:
-    void constructCFGs(BlockSet &blocks);
+    void constructCFGs(BlockSet &blocks, ThreadPool &pool);
 
     CFG entry;
     std::vector<CFG> procedures;
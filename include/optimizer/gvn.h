@@ -0,0 +1,99 @@
+/**
+ * This file contains code that supports global value numbering over a
+ * control flow graph in SSA form.
+ *
+ * @file gvn.h
+ * @author Dalton Caron
+ */
+#ifndef GVN_H__
+#define GVN_H__
+
+#include <optimizer/basic_block.h>
+#include <optimizer/block_types.h>
+#include <optimizer/dominator.h>
+#include <optimizer/ssa.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+class CFG;
+
+/**
+ * Removes expressions that compute a value already computed by a dominating
+ * instruction.
+ *
+ * Example:
+ * $t0 := a[i.1]
+ * $t1 := a[i.1]
+ * $t2 := $t1 + 1
+ * $t0 := $t2
+ * x.1 := i.1 * 3
+ * L0: y.1 := i.1 * 3
+ * Becomes:
+ * $t0 := a[i.1]
+ * $t2 := $t0 + 1
+ * $t0 := $t2
+ * x.1 := i.1 * 3
+ * L0: y.1 := x.1
+ *
+ * Every name is given a value number, which is the first name known to hold
+ * the same value. Expressions are looked up by the operation and the value
+ * numbers of their operands in a table that is scoped to the dominator tree,
+ * so an expression is only reused where its first computation dominates it.
+ *
+ * Temporaries only live within the block that defines them, so a temporary
+ * is only reused within its block. Versions of variables are stored in
+ * memory and may be reused by any block they dominate. Elements of arrays
+ * may change between loads, so only the addresses of elements are reused.
+ */
+class GVN {
+public:
+    /**
+     * Constructs the value numbering of a control flow graph.
+     * @param cfg The control flow graph to number.
+     * @param ssa The SSA form of the control flow graph.
+     * @param dominator The dominator tree of the control flow graph.
+     */
+    GVN(CFG *cfg, SSA &ssa, const Dominator *dominator);
+
+    /**
+     * Replaces redundant expressions with the names that already hold them.
+     * @return True if an expression was replaced, else false.
+     */
+    bool eliminate();
+private:
+    void eliminateInBlock(
+        const BBP block,
+        const std::map<BBP, std::vector<BBP>> &children
+    );
+    std::string getValueNumber(
+        const tac_line_t &inst,
+        const std::string &operand
+    ) const;
+    std::string getExpressionKey(const tac_line_t &inst) const;
+    bool isValue(const std::string &name) const;
+    bool isAvailable(const std::string &leader, const BBP block) const;
+
+    CFG *cfg;
+    SSA &ssa;
+    const Dominator *dominator;
+
+    // Temporaries that are defined exactly once, not counting stores through
+    // addresses.
+    std::set<std::string> temporaries;
+    // Temporaries that hold the address of an array element.
+    std::set<std::string> addresses;
+
+    // The value number of each name numbered so far.
+    std::map<std::string, std::string> valueNumbers;
+    // The name holding each expression in the current dominator tree scope.
+    std::map<std::string, std::string> available;
+    // The block each temporary is defined in.
+    std::map<std::string, BBP> definingBlocks;
+    bool changed;
+};
+
+#endif
@@ -0,0 +1,159 @@
+/**
+ * This file contains the inliner, which replaces calls to small procedures
+ * with the bodies of the procedures.
+ *
+ * @file inliner.h
+ * @author Dalton Caron
+ */
+#ifndef INLINER_H__
+#define INLINER_H__
+
+#include <3ac.h>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+// Procedures with larger bodies are inlined only where they are called in
+// loops, where the limit is raised by this much for each loop.
+#define INLINE_MAX_INSTRUCTIONS 16
+// Loops nested deeper than this do not raise the limit any further.
+#define INLINE_MAX_LOOP_DEPTH 3
+// Inlining may at most add this many instructions for every instruction
+// of the program.
+#define INLINE_MAX_GROWTH 1
+
+/**
+ * Replaces the calls to small procedures with copies of their bodies, so
+ * that the loops that call them may be optimized as any other loop.
+ *
+ * Example:
+ * procedure square(int v) int r;
+ * begin
+ *     r := v * v;
+ *     s := r
+ * end;
+ * ...
+ * call square(x + 1);
+ * Becomes:
+ * $t0 := x + 1;
+ * v.I0 := $t0;
+ * r.I0 := v.I0 * v.I0;
+ * s := r.I0
+ *
+ * The parameters, the return value and the variables declared by the
+ * procedure are renamed into the scope of the caller, and the labels and
+ * temporaries of the body are renamed to keep them apart from every other
+ * copy. Arrays are passed by their address, so an array parameter is
+ * replaced by the array that is passed. Procedures are inlined into their
+ * callers before the callers are inlined themselves. Recursive procedures
+ * are never inlined, and a procedure that is no longer called after it has
+ * been inlined is removed.
+ */
+class Inliner {
+public:
+    /**
+     * Constructs and performs the inlining on the provided instructions.
+     * @param instructions Three address codes to inline calls within.
+     */
+    Inliner(std::vector<tac_line_t> &instructions);
+private:
+    /** The code of a procedure, or the code between procedures. */
+    typedef struct segment {
+        // The name of the procedure, or empty between procedures.
+        std::string procedure;
+        std::vector<tac_line_t> code;
+        bool inlined;
+    } segment_t;
+
+    /** Splits the instructions into procedures and the code between. */
+    void findSegments();
+
+    /** Finds the procedures that may call themselves. */
+    void findRecursiveProcedures();
+
+    /**
+     * @return The order that segments are inlined into, where a procedure
+     * comes before the procedures that call it.
+     */
+    std::vector<size_t> findInliningOrder() const;
+
+    /**
+     * Inlines the calls of a segment that fit the budget.
+     * @param segment The segment to inline calls within.
+     */
+    void inlineCalls(segment_t &segment);
+
+    /**
+     * @param segment The segment the instruction is in.
+     * @param call A call to a procedure.
+     * @param depth The number of loops that contain the call.
+     * @return True if the call is inlined, else false.
+     */
+    bool shouldInline(
+        const segment_t &segment,
+        const tac_line_t &call,
+        const unsigned int depth
+    ) const;
+
+    /**
+     * Copies the body of the called procedure into the code of a caller.
+     * @param call The call to replace.
+     * @param arguments The parameters passed to the procedure.
+     * @param out The code of the caller to append the body to.
+     * @param declarations The declarations of the renamed variables are
+     * appended here.
+     */
+    void inlineCall(
+        const tac_line_t &call,
+        const std::vector<tac_line_t> &arguments,
+        std::vector<tac_line_t> &out,
+        std::vector<tac_line_t> &declarations
+    );
+
+    /** Removes the inlined procedures that are no longer called. */
+    void removeUncalledProcedures();
+
+    /** Joins the segments back into the instructions. */
+    void joinSegments();
+
+    /**
+     * @param segment A segment.
+     * @return The procedures called by the segment.
+     */
+    static std::set<std::string> getCallees(const segment_t &segment);
+
+    /**
+     * @param code The code of a segment.
+     * @return The number of loops that contain each instruction.
+     */
+    static std::vector<unsigned int> computeLoopDepths(
+        const std::vector<tac_line_t> &code
+    );
+
+    /**
+     * @param procedure The code of a procedure.
+     * @return The number of instructions that inlining the body adds.
+     */
+    static unsigned int getBodySize(const std::vector<tac_line_t> &procedure);
+
+    /**
+     * @param call A call to a procedure.
+     * @return The name of the called procedure.
+     */
+    static std::string getCallee(const tac_line_t &call);
+
+    std::vector<tac_line_t> &instructions;
+    std::vector<segment_t> segments;
+    std::map<std::string, size_t> procedures;
+    std::set<std::string> recursive;
+    // The globals declared for the variables inlined between procedures.
+    std::vector<tac_line_t> globals;
+
+    unsigned int budget;
+    unsigned int inlinedCount;
+};
+
+#endif
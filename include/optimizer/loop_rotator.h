@@ -0,0 +1,66 @@
+/**
+ * This file contains code that supports the rotation of loops from a top
+ * tested form into a bottom tested form.
+ *
+ * @file loop_rotator.h
+ * @author Dalton Caron
+ */
+#ifndef LOOP_ROTATOR_H__
+#define LOOP_ROTATOR_H__
+
+#include <optimizer/natural_loop.h>
+#include <optimizer/block_types.h>
+
+#include <vector>
+
+/**
+ * Rotates a while loop so that the exit condition is tested at the bottom of
+ * the loop.
+ *
+ * Example:
+ * L0: if i >= 10 goto L1
+ *     ...
+ *     goto L0
+ * L1:
+ * Becomes:
+ * L0: if i >= 10 goto L1
+ * L2: ...
+ *     if i < 10 goto L2
+ * L1:
+ *
+ * The header is only executed once to guard entry into the loop, so each
+ * iteration executes one conditional jump instead of a conditional jump and
+ * an unconditional jump.
+ */
+class LoopRotator {
+public:
+    /**
+     * Constructs the loop rotator and checks if the loop can be rotated.
+     * @param loop The loop to evaluate and rotate.
+     * @param allBlocks A reference to the collection of all basic blocks.
+     */
+    LoopRotator(NaturalLoop &loop, BlockSet &allBlocks);
+
+    /**
+     * Attempts to rotate the loop. The CFG analyses are invalidated if the
+     * loop is rotated.
+     * @return True if the loop was rotated, else false.
+     */
+    bool rotate();
+private:
+    /** @return True if the loop can be rotated, else false. */
+    bool checkCanLoopBeRotated();
+
+    /** @return The label of the first body block, inserted if missing. */
+    std::string labelFirstBodyBlock();
+
+    NaturalLoop &loop;
+    BlockSet &allBlocks;
+    bool canRotate;
+
+    // Loop blocks in the order they are laid out.
+    std::vector<BBP> loopBlocks;
+    BBP exit;
+};
+
+#endif
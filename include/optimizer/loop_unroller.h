@@ -0,0 +1,71 @@
+/**
+ * This file contains code that supports the full unrolling of loops that
+ * execute a small constant number of times.
+ *
+ * @file loop_unroller.h
+ * @author Dalton Caron
+ */
+#ifndef LOOP_UNROLLER_H__
+#define LOOP_UNROLLER_H__
+
+#include <optimizer/natural_loop.h>
+#include <optimizer/block_types.h>
+
+#include <vector>
+
+// Loops that execute more times than this are left as loops.
+#define FULL_UNROLL_MAX_TRIP_COUNT 8
+// Limits the size of the straight line code produced by unrolling.
+#define FULL_UNROLL_MAX_INSTRUCTIONS 128
+
+/**
+ * Replaces a loop with a known constant trip count with copies of its body.
+ *
+ * Example:
+ * i := 0;
+ * while i < 2 do
+ * begin
+ *     a[i] := i;
+ *     i := i + 1
+ * end;
+ * Becomes:
+ * i := 0;
+ * a[i] := i;
+ * i := i + 1;
+ * a[i] := i;
+ * i := i + 1;
+ *
+ * The header compare and jump of every iteration are removed and the
+ * straight line code may be optimized further as a single basic block.
+ */
+class LoopUnroller {
+public:
+    /**
+     * Constructs the loop unroller and computes the trip count of the loop.
+     * @param loop The loop to evaluate and unroll.
+     * @param allBlocks A reference to the collection of all basic blocks.
+     */
+    LoopUnroller(NaturalLoop &loop, BlockSet &allBlocks);
+
+    /**
+     * Attempts to fully unroll the loop. The CFG analyses are invalidated if
+     * the loop is unrolled.
+     * @return True if the loop was unrolled, else false.
+     */
+    bool unroll();
+private:
+    /** @return True if the loop can be fully unrolled, else false. */
+    bool checkCanLoopBeUnrolled();
+
+    NaturalLoop &loop;
+    BlockSet &allBlocks;
+    bool canUnroll;
+    unsigned int tripCount;
+
+    // Loop blocks in the order they are laid out.
+    std::vector<BBP> loopBlocks;
+    // The instructions of a single iteration of the loop body.
+    std::vector<tac_line_t> body;
+};
+
+#endif
@@ -0,0 +1,150 @@
+/**
+ * This file contains code that supports the unswitching of loops. Unswitching
+ * hoists a loop invariant conditional out of a loop and clones the loop for
+ * each outcome of the conditional.
+ *
+ * @file loop_unswitcher.h
+ * @author Dalton Caron
+ */
+#ifndef LOOP_UNSWITCHER_H__
+#define LOOP_UNSWITCHER_H__
+
+#include <optimizer/natural_loop.h>
+#include <optimizer/block_types.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// The number of loops that may be unswitched within a single CFG. Every
+// unswitch duplicates a loop, so this bounds the growth of the code.
+#define UNSWITCH_BUDGET 4
+
+/**
+ * Unswitches the input natural loop if it contains a conditional statement
+ * whose condition is loop invariant.
+ *
+ * Example:
+ * while i < 10 do
+ * begin
+ *     if flag = 1 then a[i] := 5;
+ *     i := i + 1
+ * end;
+ * Becomes:
+ * if flag = 1 then
+ *     while i < 10 do
+ *     begin
+ *         a[i] := 5;
+ *         i := i + 1
+ *     end
+ * else
+ *     while i < 10 do
+ *     begin
+ *         i := i + 1
+ *     end;
+ *
+ * Neither clone contains a conditional statement, so both clones may be
+ * simple loops and candidates for vectorization.
+ */
+class LoopUnswitcher {
+public:
+    /**
+     * Constructs the loop unswitcher and searches for an invariant
+     * conditional within the loop.
+     * @param loop The loop to evaluate and unswitch.
+     * @param allBlocks A reference to the collection of all basic blocks.
+     */
+    LoopUnswitcher(NaturalLoop &loop, BlockSet &allBlocks);
+
+    /**
+     * Attempts to unswitch the loop. The CFG analyses are invalidated if the
+     * loop is unswitched.
+     * @return True if the loop was unswitched, else false.
+     */
+    bool unswitch();
+
+    /**
+     * Restarts the numbering of the cloned labels made by the calling thread. 
+     * Cloned labels extend labels that are already unique, so each graph may 
+     * number them from zero regardless of the thread that optimizes it.
+     */
+    static void resetIdGenerators();
+private:
+    /** @return True if the loop can be unswitched, else false. */
+    bool checkCanLoopBeUnswitched();
+
+    /**
+     * Loops are only unswitched if the blocks of the loop are laid out
+     * contiguously from the header and the header has a single predecessor
+     * that falls through into it.
+     */
+    bool checkLoopLayout();
+
+    /**
+     * Searches the loop body for a conditional jump over a region of blocks
+     * that only contains the body of the conditional.
+     */
+    bool findInvariantConditional();
+
+    /**
+     * Records the definitions that must be hoisted along with the operand.
+     * @param variable The operand to check.
+     * @param user The instruction using the operand.
+     * @return True if the operand can be computed before the loop.
+     */
+    bool isOperandHoistable(
+        const std::string &variable,
+        const tac_line_t &user
+    );
+
+    bool isDefinedInLoop(const std::string &variable) const;
+
+    /** Copies the loop after the last block of the loop. */
+    void cloneLoop();
+
+    /** Inserts the hoisted conditional between the preheader and header. */
+    void insertGuard();
+
+    /** The original loop always executes the body of the conditional. */
+    void removeConditionalFromOriginal();
+
+    /** The cloned loop never executes the body of the conditional. */
+    void removeConditionalFromClone();
+
+    /**
+     * Merges chains of blocks that fall through into each other with no
+     * other control flow so that the loop bodies may be single blocks.
+     */
+    void mergeStraightLineBlocks(BBP start);
+
+    BBP getNextBlock(const BBP &block) const;
+
+    std::string cloneLabel(const std::string &label) const;
+
+    static thread_local unsigned int unswitchIdGenerator;
+
+    NaturalLoop &loop;
+    BlockSet &allBlocks;
+    bool canUnswitch;
+    // Suffix that makes the labels of the cloned loop unique.
+    std::string labelSuffix;
+
+    // Loop blocks in the order they are laid out.
+    std::vector<BBP> loopBlocks;
+    std::set<std::string> loopLabels;
+    BBP preheader;
+
+    // The block that ends in the invariant conditional jump.
+    BBP conditional;
+    // The target of the jump.
+    BBP target;
+    // The blocks that are skipped when the jump is taken.
+    std::vector<BBP> region;
+    // Instructions that compute the condition ahead of the loop.
+    std::vector<tac_line_t> hoisted;
+
+    std::map<BBP, BBP> clones;
+};
+
+#endif
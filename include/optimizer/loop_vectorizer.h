@@ -8,6 +8,7 @@
 #define LOOP_VECTORIZER
 
 #include <optimizer/natural_loop.h>
+#include <set>
 
 #define DISTANCE_LESS (-1)
 #define DISTANCE_MORE 1
@@ -86,6 +87,38 @@ public:
         const induction_variable_t &index
     );
 private:
+    /**
+     * Follows the definitions of the operands of an instruction back to the 
+     * loop index. Each variable is followed once, as a variable may be 
+     * defined from itself.
+     * @param loop Loop that contains the dependent index/iterator.
+     * @param inst The instruction to evaluate.
+     * @param index The loop iterator variable.
+     * @param visited The variables already followed.
+     * @return True if the instruction depends on the index, else false.
+     */
+    static bool isInstructionDependentOnIndex(
+        const NaturalLoop &loop,
+        const tac_line_t &inst,
+        const induction_variable_t &index,
+        std::set<std::string> &visited
+    );
+
+    /**
+     * Follows the definitions of a variable back to the loop index.
+     * @param loop Loop that contains the dependent index/iterator.
+     * @param variable The variable to evaluate.
+     * @param index The loop iterator variable.
+     * @param visited The variables already followed.
+     * @return True if the variable depends on the index, else false.
+     */
+    static bool isVariableDependentOnIndex(
+        const NaturalLoop &loop, 
+        const std::string &variable,
+        const induction_variable_t &index,
+        std::set<std::string> &visited
+    );
+
     /** @return True if can be vectorized, else false. Called once. */
     bool checkCanLoopBeVectorized();
 
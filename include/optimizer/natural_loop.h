@@ -175,12 +175,40 @@ public:
      */
     bool isNeverDefinedInLoop(const std::string &variable) const;
 
+    /**
+     * Computes the number of times the loop body executes when the iterator
+     * starts at a constant in the preheader, is stepped by a constant once 
+     * per iteration, and is compared against a constant in the header.
+     * 
+     * @param limit The largest trip count worth computing.
+     * @param tripCountOut The number of iterations, if found.
+     * @return True if the trip count is a constant no larger than the limit.
+     */
+    bool computeConstantTripCount(
+        const unsigned int limit, 
+        unsigned int &tripCountOut
+    ) const;
+
+    /**
+     * Collects the blocks of the loop if they are laid out one after another
+     * starting from the header.
+     * @param blocksOut The loop blocks in layout order, if contiguous.
+     * @return True if the loop blocks are contiguous, else false.
+     */
+    bool getContiguousBlocks(std::vector<BBP> &blocksOut) const;
+
     /**
      * Returns the loop exit. Assumes the loop only has one exit.
      * @return The loop exit.
      */
     BBP getExit() const;
 
+    /** 
+     * @return The only predecessor of the header outside of the loop, or 
+     * nullptr if there is more than one.
+     */
+    BBP getPreheader() const;
+
     /** @return The loop header. */
     const BBP getHeader() const;
 
@@ -190,12 +218,6 @@ public:
     /** @return A back edge tuple representation of the loop in string form. */
     const std::string to_string() const;
 private:
-    void forEachBBInBodyInternal(
-        BBP current, 
-        std::function<void(BBP)> action,
-        std::set<BBP> &visited
-    ) const;
-
     BBP header;
     BBP footer;
     const Reach *reach;
@@ -12,7 +12,11 @@
 
 #include <optimizer/blocker.h>
 #include <optimizer/graphs.h>
+#include <optimizer/inliner.h>
+#include <optimizer/pass_manager.h>
 #include <optimizer/preprocessing.h>
+#include <optimizer/tail_recursion.h>
+#include <thread_pool.h>
 
 /**
  * Represents the compiler optimizer entry point. Responsible for running 
@@ -22,9 +26,16 @@ class Optimizer {
 public:
     /**
      * Performs specifically machine independent optimization on the sequence 
-     * of instructions generated from the compiler frontend.
+     * of instructions generated from the compiler frontend. Tail recursion 
+     * is turned into loops at -O2 or with -e, and small procedures are 
+     * inlined into their callers at -O2 or with -i, before the code is 
+     * split into blocks. The passes run are chosen by the -O level, the pass 
+     * flags and --passes. The graphs of the program are optimized in 
+     * parallel on the thread pool.
+     * @param instructions The code to optimize.
+     * @param pool The threads that optimize the graphs.
      */
-    Optimizer(std::vector<tac_line_t> &instructions);
+    Optimizer(std::vector<tac_line_t> &instructions, ThreadPool &pool);
 
     /**
      * Gets the optimized code in the form of a sequnece of basic blocks.
@@ -32,9 +43,14 @@ public:
      */
     BlockSet &getBlocks();
 private:
+    /** Runs the pass pipeline over every graph on the thread pool. */
+    void optimizeGraphs();
+
+    ThreadPool &pool;
     Preprocessor preprocessor;
     Blocker blocker;
     Graphs graphs;
+    PassManager passManager;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,181 @@
+/**
+ * This file contains the pass manager, which runs a pipeline of optimization
+ * passes over each control flow graph and maintains the analyses they use.
+ *
+ * @file pass_manager.h
+ * @author Dalton Caron
+ */
+#ifndef PASS_MANAGER_H__
+#define PASS_MANAGER_H__
+
+#include <optimizer/basic_block.h>
+#include <optimizer/block_types.h>
+#include <optimizer/cfg.h>
+#include <optimizer/dominator.h>
+#include <optimizer/natural_loop.h>
+#include <optimizer/reach.h>
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// The highest optimization level accepted by -O.
+#define MAX_OPTIMIZATION_LEVEL 2
+
+/** The analyses that passes may depend on, as a bit set. */
+typedef enum analysis {
+    ANALYSIS_NONE = 0,
+    ANALYSIS_DOMINATOR = 1 << 0,
+    ANALYSIS_REACH = 1 << 1,
+    // Natural loops are computed from the dominator tree and reaching
+    // definitions, so they are invalidated along with either.
+    ANALYSIS_LOOPS = 1 << 2,
+    ANALYSIS_ALL = ANALYSIS_DOMINATOR | ANALYSIS_REACH | ANALYSIS_LOOPS
+} analysis_t;
+
+/**
+ * Caches the analyses of a control flow graph. An analysis is computed when
+ * first requested and kept until a pass invalidates it.
+ */
+class AnalysisCache {
+public:
+    /**
+     * @param cfg The control flow graph to analyze.
+     * @param allBlocks A reference to the collection of all basic blocks.
+     */
+    AnalysisCache(CFG *cfg, BlockSet &allBlocks);
+
+    // The loops point into the dominator tree and reaching definitions held 
+    // by the cache, so it is not copied.
+    AnalysisCache(const AnalysisCache &) = delete;
+
+    /** @return The dominator tree of the graph. */
+    const Dominator &getDominator();
+
+    /** @return The reaching definitions of the graph. */
+    const Reach &getReach();
+
+    /** @return The natural loops of the graph. */
+    std::vector<NaturalLoop> &getLoops();
+
+    /**
+     * Computes the provided analyses if they are not already valid.
+     * @param analyses The analyses to compute.
+     */
+    void require(const unsigned int analyses);
+
+    /**
+     * Discards every analysis that is not preserved.
+     * @param preserved The analyses that are still valid.
+     */
+    void invalidate(const unsigned int preserved);
+private:
+    CFG *cfg;
+    BlockSet &allBlocks;
+
+    // The analyses that are currently valid.
+    unsigned int valid;
+    Dominator dominator;
+    Reach reach;
+    std::vector<NaturalLoop> loops;
+};
+
+/** The ways in which a pass may be applied to a control flow graph. */
+typedef enum pass_kind {
+    // The pass is run once on the whole graph.
+    PASS_FUNCTION = 0,
+    // The pass is run on one loop at a time, and the loops are computed
+    // again after every loop it changes.
+    PASS_LOOP
+} pass_kind_t;
+
+/** Describes an optimization pass that the pass manager can run. */
+typedef struct pass {
+public:
+    // The name of the pass in --passes pipelines.
+    std::string name;
+    // What the pass does, for the log.
+    std::string description;
+    pass_kind_t kind;
+    // The lowest optimization level that runs the pass, or
+    // MAX_OPTIMIZATION_LEVEL + 1 if it only runs when enabled by its flag.
+    unsigned int level;
+    // The flag that enables the pass regardless of the level.
+    const bool *enabled;
+    // The analyses computed before the pass runs.
+    unsigned int required;
+    // The analyses that stay valid when the pass changes the graph.
+    unsigned int preserved;
+    // The most loops a loop pass may change, or 0 for one change per loop.
+    unsigned int budget;
+    // Runs a function pass and returns true if the graph changed.
+    std::function<bool(CFG &cfg, AnalysisCache &analyses,
+        BlockSet &allBlocks)> runOnFunction;
+    // Runs a loop pass on a loop and returns true if the loop changed.
+    std::function<bool(NaturalLoop &loop, BlockSet &allBlocks)> runOnLoop;
+} pass_t;
+
+/**
+ * Runs a pipeline of passes over control flow graphs.
+ *
+ * Every known pass is registered in the order it runs in by default. The
+ * pipeline is either given explicitly through --passes, or consists of the
+ * passes enabled by the -O level and by their individual flags in the
+ * registered order.
+ */
+class PassManager {
+public:
+    /** Registers every known pass, with an empty pipeline. */
+    PassManager();
+
+    /**
+     * Registers a pass so that it can be added to the pipeline.
+     * @param pass The pass to register.
+     */
+    void registerPass(const pass_t &pass);
+
+    /**
+     * Appends the registered passes enabled by the optimization level or by
+     * their flags to the pipeline, in registration order.
+     * @param level The optimization level.
+     */
+    void addDefaultPipeline(const unsigned int level);
+
+    /**
+     * Appends the passes of a comma separated list to the pipeline.
+     * @param pipeline The names of the passes to run, in order.
+     * @return False if a name does not belong to a registered pass.
+     */
+    bool addPipeline(const std::string &pipeline);
+
+    /**
+     * Runs the pipeline over a control flow graph.
+     * @param cfg The control flow graph to optimize.
+     * @param allBlocks A reference to the collection of all basic blocks.
+     */
+    void run(CFG &cfg, BlockSet &allBlocks) const;
+
+    /** @return The names of the passes in the pipeline in string form. */
+    std::string to_string() const;
+private:
+    void registerDefaultPasses();
+    bool runPass(
+        const pass_t &pass,
+        CFG &cfg,
+        AnalysisCache &analyses,
+        BlockSet &allBlocks
+    ) const;
+    bool runLoopPass(
+        const pass_t &pass,
+        AnalysisCache &analyses,
+        BlockSet &allBlocks
+    ) const;
+
+    std::map<std::string, pass_t> passes;
+    // The names of the registered passes in registration order.
+    std::vector<std::string> order;
+    std::vector<std::string> pipeline;
+};
+
+#endif
@@ -0,0 +1,129 @@
+/**
+ * This file contains code that supports sparse conditional constant
+ * propagation over a control flow graph in SSA form.
+ *
+ * @file sccp.h
+ * @author Dalton Caron
+ */
+#ifndef SCCP_H__
+#define SCCP_H__
+
+#include <optimizer/basic_block.h>
+#include <optimizer/block_types.h>
+#include <optimizer/ssa.h>
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+class CFG;
+
+// The heights of the constant propagation lattice.
+typedef enum lattice_height {
+    // The value is not known yet, as its definition was not reached.
+    LATTICE_TOP = 0,
+    // The value is the same constant on every path reached so far.
+    LATTICE_CONSTANT,
+    // The value is not a constant.
+    LATTICE_BOTTOM
+} lattice_height_t;
+
+/** Represents the value of a version in the constant propagation lattice. */
+typedef struct lattice_value {
+public:
+    lattice_height_t height;
+    // The constant, if the height is LATTICE_CONSTANT.
+    int64_t constant;
+
+    inline bool operator==(lattice_value const &rhs) const {
+        return this->height == rhs.height &&
+            (this->height != LATTICE_CONSTANT || this->constant == rhs.constant);
+    }
+
+    inline bool operator!=(lattice_value const &rhs) const {
+        return !(*this == rhs);
+    }
+} lattice_value_t;
+
+/**
+ * Propagates constants through a control flow graph in SSA form, only
+ * following the edges that may be taken given the constants found so far.
+ *
+ * Example:
+ * x.1 := 4
+ * if x.1 >= 5 goto L1
+ * y.1 := x.1 * 2
+ * L1: y.2 := phi(y.1, y)
+ * write y.2
+ * Becomes:
+ * x.1 := 4
+ * y.1 := 8
+ * L1: y.2 := phi(y.1)
+ * write 8
+ *
+ * Uses of constants are replaced with literals, arithmetic on constants is
+ * folded, conditional jumps on constants are resolved and blocks that are
+ * never reached are removed.
+ */
+class SCCP {
+public:
+    /**
+     * Constructs the propagator and computes the value of every version.
+     * @param cfg The control flow graph to propagate constants through.
+     * @param ssa The SSA form of the control flow graph.
+     * @param allBlocks A reference to the collection of all basic blocks.
+     */
+    SCCP(CFG *cfg, SSA &ssa, BlockSet &allBlocks);
+
+    /**
+     * Rewrites the graph using the constants found. The CFG analyses are
+     * invalidated if a block is removed.
+     * @return True if the graph was changed, else false.
+     */
+    bool rewrite();
+
+    /** @return The versions found to be constant in string form. */
+    std::string to_string() const;
+private:
+    // Propagation.
+    void propagate();
+    void visitEdge(const BBP pred, const BBP succ);
+    void visitPhiFunctions(const BBP block);
+    void visitInstruction(const BBP block, const size_t index);
+    void visitTerminator(const BBP block);
+    lattice_value_t evaluate(const tac_line_t &inst) const;
+    lattice_value_t getValue(
+        const tac_line_t &inst,
+        const std::string &operand
+    ) const;
+    void lowerValue(const std::string &name, const lattice_value_t &value);
+    bool isExecutable(const BBP pred, const BBP succ) const;
+
+    // Rewriting.
+    bool replaceConstants(const BBP block);
+    bool resolveConditionalJump(const BBP block);
+    bool removeUnreachableBlocks();
+    std::string getLiteral(const tac_line_t &inst, const int64_t constant);
+
+    CFG *cfg;
+    SSA &ssa;
+    BlockSet &allBlocks;
+
+    // The reachable blocks of the graph in layout order.
+    std::vector<BBP> blocks;
+    // The value of every version and temporary defined in the graph.
+    std::map<std::string, lattice_value_t> values;
+    // The blocks, and instruction indices within them, that use each name.
+    // Uses by phi-functions are recorded with the largest index.
+    std::map<std::string, std::vector<std::pair<BBP, size_t>>> uses;
+
+    std::set<std::pair<BBP, BBP>> executableEdges;
+    std::set<BBP> executableBlocks;
+    std::vector<std::pair<BBP, BBP>> edgeWorklist;
+    std::vector<std::string> nameWorklist;
+};
+
+#endif
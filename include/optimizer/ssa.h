@@ -0,0 +1,198 @@
+/**
+ * This file contains code that converts a control flow graph into and out of
+ * static single assignment (SSA) form.
+ *
+ * In SSA form, every variable is defined exactly once. Variables with
+ * multiple definitions are split into versions, and versions that meet at a
+ * join in the control flow graph are merged by phi-functions.
+ *
+ * @file ssa.h
+ * @author Dalton Caron
+ */
+#ifndef SSA_H__
+#define SSA_H__
+
+#include <optimizer/basic_block.h>
+#include <optimizer/block_types.h>
+#include <optimizer/dominator.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+class CFG;
+
+// Separates a variable from its version number. Identifiers of the language
+// may not contain the separator, so versions never collide with variables.
+#define SSA_VERSION_SEPARATOR "."
+
+/**
+ * Represents a phi-function at the start of a basic block, which selects the
+ * version of a variable flowing in from the predecessor control came from.
+ * Phi-functions are stored beside the instructions of a block, so passes
+ * that do not understand SSA form never encounter them.
+ */
+typedef struct phi_function {
+public:
+    // The variable of which versions are merged.
+    std::string variable;
+    // The version defined by the phi-function.
+    std::string result;
+    // The version flowing in from each reachable predecessor.
+    std::map<BBP, std::string> arguments;
+} phi_function_t;
+
+/**
+ * Converts the blocks of a control flow graph into SSA form on construction
+ * and back into normal form on destruction.
+ *
+ * Example:
+ * i := 0
+ * L0: if i >= 10 goto L1
+ *     i := i + 1
+ *     goto L0
+ * L1:
+ * Becomes:
+ * i.1 := 0
+ * L0: i.2 := phi(i.1, i.3)
+ *     if i.2 >= 10 goto L1
+ *     i.3 := i.2 + 1
+ *     goto L0
+ * L1:
+ *
+ * Only scalar user variables are renamed. Temporaries are already defined
+ * once, and arrays are accessed through addresses. Variables are not renamed
+ * in graphs with procedure calls, as the callee may access any of them.
+ */
+class SSA {
+public:
+    /**
+     * Converts the control flow graph into SSA form.
+     * @param cfg The control flow graph to convert.
+     * @param dominator The dominator tree of the control flow graph.
+     * @param allBlocks A reference to the collection of all basic blocks.
+     */
+    SSA(CFG *cfg, const Dominator *dominator, BlockSet &allBlocks);
+
+    /**
+     * Converts the control flow graph out of SSA form. Phi-functions become
+     * copies in the predecessors of their blocks, splitting edges where the
+     * copies may not be placed in the predecessor.
+     */
+    void destruct();
+
+    /** @return The phi-functions at the start of each block. */
+    std::map<BBP, std::vector<phi_function_t>> &getPhiFunctions();
+
+    /**
+     * @param name The name to check.
+     * @return True if the name is a variable renamed by SSA or one of its
+     * versions, else false.
+     */
+    bool isRenamed(const std::string &name) const;
+
+    /**
+     * @param version A name for which isRenamed is true.
+     * @return The variable the version is a version of.
+     */
+    const std::string &getVariable(const std::string &version) const;
+
+    /** @return The phi-functions of the graph in string form. */
+    std::string to_string() const;
+
+    /**
+     * Removes a block that is no longer reachable, along with its
+     * phi-functions and the phi-function arguments flowing in from it. The
+     * caller removes the block from the graph.
+     * @param block The unreachable block.
+     */
+    void removeBlock(const BBP block);
+
+    /**
+     * @param inst The current instruction.
+     * @return The operands of the instruction that are read as scalar values.
+     */
+    static std::vector<Symbol *> getUses(tac_line_t &inst);
+
+    /**
+     * @param inst The current instruction.
+     * @return The operand of the instruction that is written as a scalar
+     * value, or nullptr if there is no such operand.
+     */
+    static Symbol *getDefinition(tac_line_t &inst);
+
+    /**
+     * @param pred The source of the edge.
+     * @param succ The destination of the edge.
+     * @return True if control flows along the edge by the jump ending the
+     * source, else false if control falls through.
+     */
+    static bool isJumpEdge(const BBP pred, const BBP succ);
+
+    /**
+     * Restarts the numbering of the edge labels and copy temporaries made by 
+     * the calling thread. Edge labels extend labels that are already unique 
+     * and the temporaries never outlive their block, so each graph may number 
+     * them from zero regardless of the thread that optimizes it.
+     */
+    static void resetIdGenerators();
+private:
+    // Construction.
+    void collectVariables();
+    void insertPhiFunctions();
+    void renameVariables(
+        const BBP block,
+        std::map<std::string, std::vector<std::string>> &stacks,
+        const std::map<BBP, std::vector<BBP>> &children
+    );
+    std::string newVersion(const std::string &variable);
+
+    // Destruction.
+    void computeInterference();
+    void computeStorage();
+    void declareStorage(const std::string &variable, const std::string &name);
+    void replaceVersionsWithStorage();
+    void insertCopies(
+        BBP pred,
+        BBP succ,
+        const std::vector<std::pair<std::string, std::string>> &copies
+    );
+    BBP splitEdge(BBP pred, BBP succ);
+    BBP insertBlockAfter(const BBP block);
+    std::vector<tac_line_t> sequentializeCopies(
+        std::vector<std::pair<std::string, std::string>> copies,
+        const tac_line_t &location
+    );
+    std::string &findWeb(const std::string &name);
+
+    static thread_local unsigned int edgeIdGenerator;
+    static thread_local unsigned int copyTempIdGenerator;
+
+    CFG *cfg;
+    const Dominator *dominator;
+    BlockSet &allBlocks;
+
+    // The reachable blocks of the graph in layout order.
+    std::vector<BBP> blocks;
+    // The renamed variables.
+    std::set<std::string> variables;
+    // Maps each renamed variable and version to its variable.
+    std::map<std::string, std::string> versionToVariable;
+    std::map<std::string, unsigned int> versionCounts;
+    std::map<BBP, std::vector<phi_function_t>> phis;
+    // The version of each variable that reaches the end of the procedure.
+    std::map<std::string, std::string> exitVersions;
+
+    // Versions of the same variable that are live at the same time.
+    std::map<std::string, std::set<std::string>> interference;
+    // Versions that share storage are grouped into webs.
+    std::map<std::string, std::string> webs;
+    // The variable each web is stored in.
+    std::map<std::string, std::string> storage;
+    // Blocks inserted on split edges.
+    std::map<std::pair<BBP, BBP>, BBP> edgeBlocks;
+};
+
+#endif
@@ -10,6 +10,7 @@
 
 #include <optimizer/basic_block.h>
 #include <optimizer/natural_loop.h>
+#include <set>
 #include <vector>
 
 /** Represents the body of a loop that is to be strip mined. */
@@ -50,6 +51,18 @@ private:
 
     bool isVariableDependentOnIndex(const std::string &variable) const;
 
+    /**
+     * Follows the definitions of a variable back to the loop index. Each 
+     * variable is followed once, as a variable may be defined from itself.
+     * @param variable The variable.
+     * @param visited The variables already followed.
+     * @return True if the variable depends on the loop index.
+     */
+    bool isVariableDependentOnIndex(
+        const std::string &variable,
+        std::set<std::string> &visited
+    ) const;
+
     bool canSquashLoop() const;
 
     const NaturalLoop &loop;
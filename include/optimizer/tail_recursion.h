@@ -0,0 +1,95 @@
+/**
+ * This file contains the tail recursion eliminator, which turns procedures
+ * that call themselves last into loops.
+ *
+ * @file tail_recursion.h
+ * @author Dalton Caron
+ */
+#ifndef TAIL_RECURSION_H__
+#define TAIL_RECURSION_H__
+
+#include <3ac.h>
+
+#include <string>
+#include <vector>
+
+/**
+ * Replaces the calls a procedure makes to itself in tail position with
+ * jumps back to the start of its body. A call is in tail position if only
+ * labels come between it and the exit of the procedure.
+ *
+ * Example:
+ * procedure sum(int n, int acc);
+ * begin
+ *     if n > 0 then
+ *         call sum(n - 1, acc + n)
+ * end;
+ * Becomes:
+ * $Lsum:
+ * $LsumT:
+ * $t0 := n > 0;
+ * jump if zero $Lno0;
+ * $t1 := n - 1;
+ * $t2 := acc + n;
+ * n := $t1;
+ * acc := $t2;
+ * jump $LsumT;
+ * $Lno0:
+ * exit sum
+ *
+ * The parameters are assigned the arguments of the call. An argument that
+ * is another parameter is copied first, as it may be assigned before it is
+ * read. The loop starts after the declarations of the procedure, so that
+ * they stay outside of it. Arrays are passed by their address, so a call
+ * that passes another array in place of an array parameter is left alone.
+ * Procedures with a return value are never changed, as the value is
+ * returned after the call.
+ */
+class TailRecursionEliminator {
+public:
+    /**
+     * Constructs and eliminates the tail recursion of the provided
+     * instructions.
+     * @param instructions Three address codes to eliminate tail recursion
+     * within.
+     */
+    TailRecursionEliminator(std::vector<tac_line_t> &instructions);
+private:
+    /**
+     * @param procedure The code of a procedure, from its entry to its exit.
+     * @return The code of the procedure with its tail calls to itself
+     * replaced by jumps.
+     */
+    std::vector<tac_line_t> eliminate(
+        const std::vector<tac_line_t> &procedure
+    );
+
+    /**
+     * Assigns the arguments of a call to the parameters of the procedure.
+     * @param entry The procedure called.
+     * @param arguments The parameters passed to the procedure.
+     * @param out The code to append the assignments to.
+     * @return True if the arguments can be assigned, else false.
+     */
+    bool assignArguments(
+        const st_entry_t &entry,
+        const std::vector<tac_line_t> &arguments,
+        std::vector<tac_line_t> &out
+    );
+
+    /**
+     * @param procedure The code of a procedure.
+     * @param call The index of a call in the procedure.
+     * @return True if only labels come between the call and the exit.
+     */
+    static bool isInTailPosition(
+        const std::vector<tac_line_t> &procedure,
+        const size_t call
+    );
+
+    std::vector<tac_line_t> &instructions;
+    unsigned int tempCount;
+    unsigned int eliminatedCount;
+};
+
+#endif
@@ -0,0 +1,102 @@
+/**
+ * This file contains a compact map from interned names to values, for the
+ * small per block and per instruction tables of the analyses.
+ *
+ * @file symbol_map.h
+ * @author Dalton Caron
+ */
+#ifndef SYMBOL_MAP_H__
+#define SYMBOL_MAP_H__
+
+#include <interner.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ * Maps symbols to values using a flat array of entries sorted by symbol ID.
+ * Lookups are a binary search over contiguous memory, which is faster than
+ * a tree of strings for the handful of names a block or instruction uses.
+ * Entries are iterated in the order of their IDs.
+ */
+template <typename T>
+class SymbolMap {
+public:
+    typedef std::pair<SymbolId, T> entry_t;
+    typedef typename std::vector<entry_t>::iterator iterator;
+    typedef typename std::vector<entry_t>::const_iterator const_iterator;
+
+    /** @return 1 if the symbol has a value, else 0. */
+    size_t count(const Symbol &symbol) const {
+        const const_iterator i = this->find(symbol.id());
+        return i != this->entries.end() && i->first == symbol.id();
+    }
+
+    /** @return The value of a symbol, which must exist. */
+    T &at(const Symbol &symbol) {
+        const iterator i = this->find(symbol.id());
+        if (i == this->entries.end() || i->first != symbol.id()) {
+            throw std::out_of_range("SymbolMap::at " + symbol.str());
+        }
+        return i->second;
+    }
+
+    const T &at(const Symbol &symbol) const {
+        const const_iterator i = this->find(symbol.id());
+        if (i == this->entries.end() || i->first != symbol.id()) {
+            throw std::out_of_range("SymbolMap::at " + symbol.str());
+        }
+        return i->second;
+    }
+
+    /** @return The value of a symbol, inserting a default value if needed. */
+    T &operator[](const Symbol &symbol) {
+        iterator i = this->find(symbol.id());
+        if (i == this->entries.end() || i->first != symbol.id()) {
+            i = this->entries.insert(i, std::make_pair(symbol.id(), T()));
+        }
+        return i->second;
+    }
+
+    /**
+     * Gives a symbol a value if it does not have one.
+     * @return True if the value was inserted, else false.
+     */
+    bool insert(const Symbol &symbol, const T &value) {
+        const iterator i = this->find(symbol.id());
+        if (i != this->entries.end() && i->first == symbol.id()) {
+            return false;
+        }
+        this->entries.insert(i, std::make_pair(symbol.id(), value));
+        return true;
+    }
+
+    void clear() { this->entries.clear(); }
+    size_t size() const { return this->entries.size(); }
+    bool empty() const { return this->entries.empty(); }
+
+    iterator begin() { return this->entries.begin(); }
+    iterator end() { return this->entries.end(); }
+    const_iterator begin() const { return this->entries.begin(); }
+    const_iterator end() const { return this->entries.end(); }
+private:
+    iterator find(const SymbolId id) {
+        return std::lower_bound(this->entries.begin(), this->entries.end(),
+            id, [](const entry_t &entry, const SymbolId key) {
+                return entry.first < key;
+            });
+    }
+
+    const_iterator find(const SymbolId id) const {
+        return std::lower_bound(this->entries.begin(), this->entries.end(),
+            id, [](const entry_t &entry, const SymbolId key) {
+                return entry.first < key;
+            });
+    }
+
+    std::vector<entry_t> entries;
+};
+
+#endif
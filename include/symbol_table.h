@@ -16,6 +16,7 @@
 #include <string>
 #include <memory>
 #include <map>
+#include <shared_mutex>
 
 #define NO_NEXT_USE (-1)
 
@@ -97,6 +98,8 @@ typedef struct symbol_table_entry {
         struct {
             uint8_t argumentsLength;
             type_t argumentTypes[MAXIMUM_ARGUMENTS];
+            // Arrays are passed by their address.
+            bool argumentIsArray[MAXIMUM_ARGUMENTS];
             type_t returnType;
             char argumentNames[MAXIMUM_ARGUMENTS][MAX_ID_LEN];
             char returnTypeName[MAX_ID_LEN];
@@ -115,6 +118,8 @@ typedef struct symbol_table_entry {
 /**
  * The SymbolTable is used to associate a variable or literal with information 
  * at compile-time. The SymbolTable is utilized in most phases of the compiler. 
+ * Procedures are optimized in parallel while sharing their enclosing scopes, 
+ * so the table may be used from several threads at once.
  */
 class SymbolTable {
 public:
@@ -184,6 +189,7 @@ public:
     unsigned int getLevel() const { return this->level; };
 private:
     std::map<address, st_entry_t> symbolTable;
+    mutable std::shared_mutex lock;
     std::shared_ptr<SymbolTable> enclosingScope = nullptr;
     unsigned int level = 0;
 };
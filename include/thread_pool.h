@@ -0,0 +1,80 @@
+/**
+ * This file contains the thread pool that runs independent tasks, such as
+ * the optimization of each procedure, in parallel.
+ *
+ * @file thread_pool.h
+ * @author Dalton Caron
+ */
+#ifndef THREAD_POOL_H__
+#define THREAD_POOL_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Runs batches of numbered tasks on a fixed set of threads using work
+ * stealing. The tasks of a batch are dealt out to the threads in contiguous
+ * runs, and each thread takes tasks from the front of its own queue. A
+ * thread whose queue is empty steals from the back of the queue of another
+ * thread, so that a few large tasks do not leave the other threads idle.
+ *
+ * The thread that starts a batch runs tasks too, so a pool of one thread
+ * runs every task on the calling thread in order.
+ */
+class ThreadPool {
+public:
+    /** @param threads The number of threads that run tasks, at least one. */
+    ThreadPool(const unsigned int threads);
+
+    // The threads refer to the pool, so it is never copied.
+    ThreadPool(const ThreadPool &) = delete;
+
+    /** Waits for the threads to exit. */
+    virtual ~ThreadPool();
+
+    /**
+     * Runs a task for each index below the count and waits for them all to
+     * finish. If a task throws, the first exception is rethrown once every
+     * task has finished.
+     *
+     * @param count The number of tasks.
+     * @param task The task to run, given the index of the task.
+     */
+    void run(const size_t count, const std::function<void(size_t)> &task);
+
+    /** @return The number of threads that run tasks. */
+    unsigned int getThreadCount() const;
+private:
+    typedef struct task_queue {
+    public:
+        std::mutex lock;
+        std::deque<size_t> tasks;
+    } task_queue_t;
+
+    void work(const unsigned int self);
+    bool runOne(const unsigned int self);
+
+    std::vector<std::unique_ptr<task_queue_t>> queues;
+    std::vector<std::thread> threads;
+
+    // Guards the batch and wakes the threads when one starts or ends.
+    std::mutex lock;
+    std::condition_variable started;
+    std::condition_variable finished;
+    unsigned long batch;
+    bool stopping;
+
+    const std::function<void(size_t)> *task;
+    std::atomic<size_t> remaining;
+    std::exception_ptr error;
+};
+
+#endif
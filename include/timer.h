@@ -0,0 +1,112 @@
+/**
+ * This file supports measuring the time and memory used by each phase of the
+ * compiler, for the report printed by --time-report.
+ *
+ * @file timer.h
+ * @author Dalton Caron
+ */
+#ifndef TIMER_H__
+#define TIMER_H__
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/** The resources used by every run of a compiler phase. */
+typedef struct phase_usage {
+public:
+    std::string name;
+    // How many phases enclosed the phase when it first ran.
+    unsigned int depth;
+    unsigned int calls;
+    double milliseconds;
+    uint64_t allocations;
+    uint64_t allocatedBytes;
+    // The peak resident set size of the process when the phase last ended.
+    long peakResidentKb;
+} phase_usage_t;
+
+/**
+ * Collects the usage of every phase measured by a ScopedTimer. Phases are
+ * kept in the order they first ran, and runs of a phase with the same name
+ * are added together. The usage of a phase includes the phases nested in it.
+ *
+ * Phases may be recorded from several threads. The time of a phase run on
+ * several threads at once is the sum of the time spent on each, and its
+ * allocations include those made by the other threads meanwhile.
+ */
+class TimeReport {
+public:
+    /**
+     * Adds a run of a phase to the report.
+     * @param usage The resources used by the run, with a call count of one.
+     */
+    static void record(const phase_usage_t &usage);
+
+    /** @return The usage of every phase measured so far. */
+    static const std::vector<phase_usage_t> &getPhases();
+
+    /** Discards every phase measured so far. */
+    static void reset();
+
+    /** @return The report as a table with a row for each phase. */
+    static std::string to_table();
+
+    /** @return The report as a single line JSON object. */
+    static std::string to_json();
+
+    /** @return The number of allocations made by the program so far. */
+    static uint64_t getAllocationCount();
+
+    /** @return The number of bytes allocated by the program so far. */
+    static uint64_t getAllocatedBytes();
+
+    /** @return The peak resident set size of the process in KiB. */
+    static long getPeakResidentKb();
+private:
+    static double getTotalMilliseconds();
+
+    static std::mutex lock;
+    static std::vector<phase_usage_t> phases;
+};
+
+/**
+ * Measures a phase of the compiler from construction until destruction,
+ * if the time report is enabled.
+ *
+ * Example:
+ * {
+ *     ScopedTimer timer("lexing");
+ *     tokens = lexer.lex(path);
+ * }
+ */
+class ScopedTimer {
+public:
+    /** @param phase The name of the phase in the report. */
+    ScopedTimer(const std::string &phase);
+
+    /** Records the resources used since construction. */
+    virtual ~ScopedTimer();
+
+    /** @return The number of phases the calling thread is measuring. */
+    static unsigned int getDepth();
+
+    /**
+     * Nests the phases measured by the calling thread in the provided number 
+     * of phases, for a thread that runs part of a phase started by another.
+     * @param depth The depth of the phase the thread is part of.
+     */
+    static void setDepth(const unsigned int depth);
+private:
+    static thread_local unsigned int depth;
+
+    std::string phase;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+    uint64_t allocations;
+    uint64_t allocatedBytes;
+};
+
+#endif
@@ -2,7 +2,7 @@
 
 #include <logging.h>
 
-unsigned int tac_line_t::bid_gen = 0;
+thread_local unsigned int tac_line_t::bid_gen = 0;
 
 bool tac_line_t::transfers_control(const tac_line_t &line) {
     switch (line.operation) {
@@ -55,6 +55,50 @@ bool tac_line_t::is_conditional_jump(const tac_line &line) {
     return false;
 }
 
+tac_op_t tac_line_t::invert_conditional_jump(const tac_op_t operation) {
+    switch (operation) {
+        case TAC_JMP_E:
+            return TAC_JMP_NE;
+        case TAC_JMP_NE:
+            return TAC_JMP_E;
+        case TAC_JMP_L:
+            return TAC_JMP_GE;
+        case TAC_JMP_GE:
+            return TAC_JMP_L;
+        case TAC_JMP_G:
+            return TAC_JMP_LE;
+        case TAC_JMP_LE:
+            return TAC_JMP_G;
+        default:
+            break;
+    }
+    return TAC_NOP;
+}
+
+bool tac_line_t::is_jump_taken(
+    const tac_op_t operation, 
+    const int64_t lhs, 
+    const int64_t rhs
+) {
+    switch (operation) {
+        case TAC_JMP_E:
+            return lhs == rhs;
+        case TAC_JMP_NE:
+            return lhs != rhs;
+        case TAC_JMP_L:
+            return lhs < rhs;
+        case TAC_JMP_G:
+            return lhs > rhs;
+        case TAC_JMP_LE:
+            return lhs <= rhs;
+        case TAC_JMP_GE:
+            return lhs >= rhs;
+        default:
+            break;
+    }
+    return false;
+}
+
 bool tac_line_t::is_procedure_call(const tac_line &line) {
     return line.operation == TAC_CALL || line.operation == TAC_RETVAL;
 }
@@ -103,6 +147,30 @@ bool tac_line_t::is_operand_constant(const std::string &value) const {
         (entry.entry_type == ST_VARIABLE && entry.variable.isConstant));
 }
 
+bool tac_line_t::get_constant_value(
+    const std::string &value, 
+    int64_t &out
+) const {
+    unsigned int level;
+    st_entry_t entry;
+    if (value == "" || !this->table->lookup(value, &level, &entry)) {
+        return false;
+    }
+
+    if (entry.entry_type == ST_LITERAL && entry.literal.type == INT) {
+        out = entry.literal.value.int_value;
+        return true;
+    }
+
+    if (entry.entry_type == ST_VARIABLE && entry.variable.isConstant &&
+        entry.variable.type == INT) {
+            out = entry.variable.value.int_value;
+            return true;
+        }
+
+    return false;
+}
+
 bool tac_line_t::is_simple() const {
     if (this->argument1 == "" && this->argument2 == "") {
         return false;
@@ -1,5 +1,6 @@
 #include <codegen2/address_table.h>
 
+#include <algorithm>
 #include <assertions.h>
 
 static std::string locationTypeToString(const location_type_t loc) {
@@ -88,7 +89,7 @@ std::string Location::address(const bool forceRegValue) const {
         case LT_MEMORY_GLOBAL:
             return this->immValueOrGlobal + "(\%rip)";
         case LT_MEMORY_STACK:
-            return stackOffset + "(\%rbp)";
+            return std::to_string(this->stackOffset) + "(\%rbp)";
         case LT_IMMEDIATE:
             return "$" + this->immValueOrGlobal;
         default:
@@ -103,26 +104,38 @@ std::string Location::to_string() const {
 
 AddressTable::AddressTable() {}
 
-Location &AddressTable::getLocation(const std::string &variable) {
+Location &AddressTable::getLocation(const Symbol &variable) {
     ASSERT(this->contains(variable));
-    return this->table.at(variable);
+    return this->locations[variable.id()];
 }
 
-bool AddressTable::isInRegister(const std::string &variable) const {
-    return this->table.count(variable) > 0 
-        && this->table.at(variable).getType() == LT_REGISTER;
+bool AddressTable::isInRegister(const Symbol &variable) const {
+    return this->contains(variable) 
+        && this->locations[variable.id()].getType() == LT_REGISTER;
 }
 
-RegPtr AddressTable::getRegister(const std::string &variable) {
+RegPtr AddressTable::getRegister(const Symbol &variable) {
     ASSERT(this->isInRegister(variable));
-    return this->table.at(variable).getRegister();
+    return this->locations[variable.id()].getRegister();
 }
 
 void AddressTable::insert(
-    const std::string &variable, 
+    const Symbol &variable, 
     const Location &location
 ) {
-    this->table[variable] = location;
+    if (variable.id() >= this->locations.size()) {
+        this->locations.resize(Interner::size());
+        this->present.resize(Interner::size(), false);
+    }
+    this->locations[variable.id()] = location;
+    this->present[variable.id()] = true;
+}
+
+void AddressTable::remove(const Symbol &variable) {
+    if (this->contains(variable)) {
+        this->present[variable.id()] = false;
+        this->locations[variable.id()] = Location();
+    }
 }
 
 void AddressTable::insertIfLiteral(
@@ -140,35 +153,47 @@ void AddressTable::insertIfLiteral(
     } 
 }
 
-bool AddressTable::contains(const std::string &variable) const {
-    return this->table.count(variable) > 0;
+bool AddressTable::contains(const Symbol &variable) const {
+    return variable.id() < this->present.size() && this->present[variable.id()];
 }
 
 std::vector<std::pair<std::string, Location>> 
 AddressTable::getValueAndLocationInRegisters() {
     std::vector<std::pair<std::string, Location>> result;
-    for (auto kv : table) {
-        if (kv.second.inRegister()) {
-            result.push_back(kv);
+    for (SymbolId id = 0; id < this->present.size(); id++) {
+        if (this->present[id] && this->locations[id].inRegister()) {
+            result.push_back(
+                std::make_pair(Interner::lookup(id), this->locations[id])
+            );
         }
     }
+
+    // Registers are spilled in this order, which should not depend on the 
+    // order in which names were interned.
+    std::sort(result.begin(), result.end(),
+        [](const std::pair<std::string, Location> &a,
+            const std::pair<std::string, Location> &b) {
+                return a.first < b.first;
+            });
     return result;
 }
 
 void AddressTable::clearRegisters() {
-    for (auto i = this->table.cbegin(); i != this->table.cend(); ) {
-        if (i->second.inRegister()) {
-            i = this->table.erase(i);
-        } else {
-            i++;
+    for (SymbolId id = 0; id < this->present.size(); id++) {
+        if (this->present[id] && this->locations[id].inRegister()) {
+            this->present[id] = false;
+            this->locations[id] = Location();
         }
     }
 }
 
 std::string AddressTable::to_string() const {
     std::string result = "";
-    for (auto i = this->table.begin(); i != this->table.end(); i++) {
-        result += "(" + i->first + ", " + i->second.to_string() + ") ";
+    for (SymbolId id = 0; id < this->present.size(); id++) {
+        if (this->present[id]) {
+            result += "(" + Interner::lookup(id) + ", " + 
+                this->locations[id].to_string() + ") ";
+        }
     }
     return result;
 }
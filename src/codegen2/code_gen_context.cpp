@@ -4,18 +4,17 @@
 #include <logging.h>
 #include <assertions.h>
 
-CodeGenContext::CodeGenContext() : procedureMode(false) {
-    this->insertEntry();
-}
+CodeGenContext::CodeGenContext() : procedureMode(false) {}
 
 void CodeGenContext::insertEntry() {
     this->textSection.push_back(".global _start");
     this->textSection.push_back("_start:");
+    this->textSection.push_back("\tandq $-32, \%rsp");
 }
 
 void CodeGenContext::insertExit() {
     this->textSection.push_back("\tmovq $60, \%rax");
-    this->textSection.push_back("\tmovq $0, \%rbx");
+    this->textSection.push_back("\tmovq $0, \%rdi");
     this->textSection.push_back("\tsyscall");
 }
 
@@ -39,13 +38,30 @@ void CodeGenContext::insertText(const std::string &inst) {
     this->selectSection().push_back(inst);
 }
 
+size_t CodeGenContext::getTextLength() {
+    return this->selectSection().size();
+}
+
+void CodeGenContext::insertTextAt(
+    const size_t position, 
+    const std::string &inst
+) {
+    std::vector<std::string> &section = this->selectSection();
+    ASSERT(position <= section.size());
+    section.insert(section.begin() + position, inst);
+}
+
 void CodeGenContext::insertGlobalArray(
     const std::string &name, 
     const unsigned int size
 ) {
+    if (!this->dataNames.insert(name).second) {
+        return;
+    }
+
     const std::string insertion = 
         ".align 32\n" + name + ":\n.zero " + std::to_string(size);
-    this->dataSection.push_back(insertion);
+    this->dataSection.push_back(std::make_pair(name, insertion));
 }
 
 void CodeGenContext::insertGlobalVariable(
@@ -55,12 +71,31 @@ void CodeGenContext::insertGlobalVariable(
     const unsigned int alignment
 ) {
     ASSERT(size % 8 == 0);
+    if (!this->dataNames.insert(name).second) {
+        return;
+    }
+
     std::string insertion = ".align " + std::to_string(alignment) + 
         "\n" + name + ":";
     for (unsigned int i = 0; i < size; i += 8) {
         insertion += "\n.quad " + std::to_string(value);
     }
-    this->dataSection.push_back(insertion);
+    this->dataSection.push_back(std::make_pair(name, insertion));
+}
+
+void CodeGenContext::append(const CodeGenContext &other) {
+    this->textSection.insert(
+        this->textSection.end(),
+        other.textSection.begin(), other.textSection.end()
+    );
+
+    // Procedures declare the large immediates they use themselves, so the 
+    // same global may come from several of them.
+    for (const auto &global : other.dataSection) {
+        if (this->dataNames.insert(global.first).second) {
+            this->dataSection.push_back(global);
+        }
+    }
 }
 
 void CodeGenContext::to_file(const char *fileName) const {
@@ -74,8 +109,8 @@ void CodeGenContext::to_file(const char *fileName) const {
     }
 
     fprintf(file, ".data\n");
-    for (const std::string &line : this->dataSection) {
-        fprintf(file, "%s\n", line.c_str());
+    for (const auto &global : this->dataSection) {
+        fprintf(file, "%s\n", global.second.c_str());
     }
 
     fprintf(file, ".text\n");
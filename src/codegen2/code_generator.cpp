@@ -1,46 +1,353 @@
 #include <codegen2/code_generator.h>
 
+#include <algorithm>
+#include <climits>
 #include <assertions.h>
+#include <constants.h>
+#include <timer.h>
+
+CodeGenerator::CodeGenerator() : enteringProcedure(false), prologue(0), 
+    block(nullptr), position(0), blockStart(0) {}
+
+/**
+ * Splits the blocks into the procedures of the program and the code between 
+ * them, in the order of the blocks.
+ * @param blocks The blocks of the program.
+ * @return The blocks of each part of the program.
+ */
+static std::vector<std::vector<BBP>> splitAtProcedures(
+    const BlockSet &blocks
+) {
+    std::vector<std::vector<BBP>> parts;
+    bool partEnded = true;
+    for (const BBP &bb : blocks) {
+        if (partEnded || bb->getHasEnterProcedure()) {
+            parts.emplace_back();
+        }
+        parts.back().push_back(bb);
+        partEnded = bb->getHasExitProcedure();
+    }
+    return parts;
+}
 
-CodeGenerator::CodeGenerator() {}
+/**
+ * @param inst An instruction.
+ * @return True if the instruction declares a variable, else false.
+ */
+static bool isDeclaration(const tac_line_t &inst) {
+    return inst.operation == TAC_ASSIGN && inst.result != "" && 
+        inst.argument1 == "";
+}
 
-void CodeGenerator::generate(const BlockSet &blocks) {
-    for (const BBP &bb : blocks) {
-        this->generateFromBB(bb);
+/**
+ * @param reg A register.
+ * @return True if the register is a vector register, else false.
+ */
+static bool isVectorRegister(const RegPtr &reg) {
+    return reg->getName().find("ymm") != std::string::npos;
+}
+
+void CodeGenerator::generate(const BlockSet &blocks, ThreadPool &pool) {
+    ScopedTimer timer("CodeGenerator::generate");
+
+    const std::vector<std::vector<BBP>> parts = splitAtProcedures(blocks);
+
+    // A part may use the globals declared by the parts before it. The 
+    // variables declared by a procedure are kept in its frame instead.
+    std::vector<tac_line_t> declarations;
+    std::vector<size_t> declaredBefore;
+    for (const std::vector<BBP> &part : parts) {
+        declaredBefore.push_back(declarations.size());
+        if (part.front()->getHasEnterProcedure()) {
+            continue;
+        }
+        for (const BBP &bb : part) {
+            for (const tac_line_t &inst : bb->getInstructions()) {
+                if (isDeclaration(inst)) {
+                    declarations.push_back(inst);
+                }
+            }
+        }
+    }
+
+    std::vector<CodeGenContext> contexts(parts.size());
+    pool.run(parts.size(), [&](size_t i) {
+        CodeGenerator generator;
+        for (size_t d = 0; d < declaredBefore.at(i); d++) {
+            generator.declareGlobal(declarations.at(d));
+        }
+        // The loops of a part are found in the graph of the procedure, or 
+        // in the graph of the program entry for the code between them.
+        const BBP graphEntry = parts.at(i).front()->getHasEnterProcedure() ?
+            parts.at(i).front() : *blocks.begin();
+        generator.allocateRegisters(parts.at(i), graphEntry);
+        generator.findTailCalls(parts.at(i));
+        for (const BBP &bb : parts.at(i)) {
+            generator.generateFromBB(bb);
+        }
+        if (!parts.at(i).front()->getHasEnterProcedure()) {
+            generator.buildFrame();
+        }
+        contexts.at(i) = std::move(generator.context);
+    });
+
+    // Procedures are only reached by calls, so they follow the exit.
+    this->context.insertEntry();
+    for (size_t i = 0; i < parts.size(); i++) {
+        if (!parts.at(i).front()->getHasEnterProcedure()) {
+            this->context.append(contexts.at(i));
+        }
     }
     this->context.insertExit();
+    for (size_t i = 0; i < parts.size(); i++) {
+        if (parts.at(i).front()->getHasEnterProcedure()) {
+            this->context.append(contexts.at(i));
+        }
+    }
     this->context.to_file("output.s");
 }
 
+st_entry_t CodeGenerator::declareGlobal(const tac_line_t &declaration) {
+    unsigned int level;
+    st_entry_t entry;
+    const bool success = 
+        declaration.table->lookup(declaration.result, &level, &entry);
+
+    ASSERT(success);
+    ASSERT(entry.entry_type == ST_VARIABLE);
+
+    if (entry.variable.isArray) {
+        this->globalTable.insertGlobalArray(
+            declaration.result, entry.variable.arraySize * 8
+        );
+    } else {
+        this->globalTable.insertGlobalVariable(declaration.result, 8);
+    }
+
+    this->addressTable
+        .insert(declaration.result, Location(LT_MEMORY_GLOBAL)
+        .setImmValueOrGlobal(declaration.result));
+    return entry;
+}
+
+/** @return The allocator chosen with --regalloc, or null if local. */
+static std::unique_ptr<RegisterAllocator> createAllocator() {
+    switch (REGISTER_ALLOCATOR) {
+        case REGALLOC_LINEAR:
+            return std::make_unique<LinearScanAllocator>();
+        case REGALLOC_GRAPH:
+            return std::make_unique<GraphColoringAllocator>();
+        default:
+            break;
+    }
+    return nullptr;
+}
+
+void CodeGenerator::allocateRegisters(
+    const std::vector<BBP> &blocks,
+    const BBP graphEntry
+) {
+    this->intervals = std::make_unique<LiveIntervals>(blocks, graphEntry);
+
+    const std::unique_ptr<RegisterAllocator> allocator = createAllocator();
+    if (allocator != nullptr) {
+        // The called procedure may use any register, and only globals are 
+        // stored across the call.
+        std::vector<live_interval_t> allocatable;
+        for (const live_interval_t &interval : 
+            this->intervals->getIntervals()) {
+                if (!interval.crossesCall || 
+                    tac_line_t::is_user_defined_var(interval.variable)) {
+                        allocatable.push_back(interval);
+                    }
+            }
+
+        this->allocation = allocator->allocate(*this->intervals, allocatable);
+    }
+
+    // Temps live across blocks without a register of their own are kept in 
+    // memory between the blocks, as the user variables are.
+    for (const BBP &bb : blocks) {
+        for (const std::string &variable : this->intervals->getLiveIn(bb)) {
+            if (!tac_line_t::is_user_defined_var(variable) && 
+                !this->isAllocated(variable) &&
+                !this->globalTable.isGlobal(variable) &&
+                this->intervals->getInterval(variable).type == GPR) {
+                    this->declareTemporary(variable);
+                }
+        }
+    }
+}
+
+void CodeGenerator::findTailCalls(const std::vector<BBP> &blocks) {
+    if (!TAIL_CALLS_ENABLED) {
+        return;
+    }
+
+    // The return is a block of its own, as is each label before it.
+    for (auto i = blocks.begin(); i != blocks.end(); i++) {
+        const tac_line_t &last = (*i)->getInstructions().back();
+        if (last.operation != TAC_CALL) {
+            continue;
+        }
+        auto next = i + 1;
+        while (next != blocks.end() && 
+            (*next)->getInstructions().size() == 1 &&
+            (*next)->getInstructions().front().operation == TAC_LABEL) {
+                next++;
+            }
+        if (next != blocks.end() && 
+            (*next)->getInstructions().size() == 1 &&
+            (*next)->getInstructions().front().operation == TAC_EXIT_PROC) {
+                this->tailCalls.insert(last.bid);
+            }
+    }
+}
+
+/**
+ * @param variable A global, or a temp kept in memory between blocks.
+ * @return The label of the memory that holds the variable.
+ */
+static std::string memoryLabel(const std::string &variable) {
+    if (tac_line_t::is_user_defined_var(variable)) {
+        return variable;
+    }
+    // The assembler would read the $ that temps start with as an immediate.
+    return ".L" + variable.substr(1);
+}
+
+void CodeGenerator::declareTemporary(const std::string &variable) {
+    const std::string label = memoryLabel(variable);
+    this->globalTable.insertGlobalVariable(variable, 8, label);
+    this->context.insertGlobalVariable(label, 8, 0);
+    this->addressTable
+        .insert(variable, Location(LT_MEMORY_GLOBAL)
+        .setImmValueOrGlobal(label));
+}
+
+void CodeGenerator::enterBlock(const BBP &bb) {
+    this->block = bb;
+    if (this->allocation.empty()) {
+        return;
+    }
+
+    const unsigned int first = this->intervals->getFirstPosition(bb);
+    const unsigned int last = this->intervals->getLastPosition(bb);
+
+    std::set<RegPtr> reserved;
+    for (const auto &p : this->allocation) {
+        const live_interval_t &interval = 
+            this->intervals->getInterval(p.first);
+        if (interval.start <= last && interval.end >= first) {
+            reserved.insert(p.second);
+        }
+    }
+    this->regTable.setReserved(reserved);
+
+    // Control reaches any other block with the variables already loaded.
+    for (const std::string &variable : this->intervals->getLiveIn(bb)) {
+        if (!this->isAllocated(variable)) {
+            continue;
+        }
+
+        if (this->intervals->isEntry(bb)) {
+            this->entryLoads.push_back(variable);
+        } else {
+            const RegPtr reg = this->allocation.at(variable);
+            this->regTable.setRegisterValue(reg, variable);
+            this->addressTable
+                .insert(variable, Location(LT_REGISTER).setReg(reg));
+        }
+    }
+}
+
+void CodeGenerator::loadEntryValues() {
+    for (const std::string &variable : this->entryLoads) {
+        this->claimRegister(variable, true);
+    }
+    this->entryLoads.clear();
+}
+
+RegPtr CodeGenerator::claimRegister(
+    const std::string &variable,
+    const bool load
+) {
+    const RegPtr reg = this->allocation.at(variable);
+    if (this->addressTable.isInRegister(variable) && 
+        this->addressTable.getRegister(variable) == reg) {
+            return reg;
+        }
+
+    // Variables given the same register are never live at once, so the 
+    // variable that held the register is no longer needed.
+    if (this->regTable.getAllRegistersInUse().count(reg)) {
+        const std::string previous = this->regTable.getVariableInRegister(reg);
+        if (this->isInMemory(previous)) {
+            this->storeVariable(previous, reg, false);
+        } else {
+            this->addressTable.remove(previous);
+            this->regTable.freeRegister(reg);
+        }
+    }
+
+    if (load) {
+        this->generateMovToRegisterIfInMemory(variable, reg);
+    }
+    this->regTable.setRegisterValue(reg, variable);
+    this->addressTable.insert(variable, Location(LT_REGISTER).setReg(reg));
+    return reg;
+}
+
+bool CodeGenerator::isAllocated(const std::string &variable) const {
+    return this->allocation.count(variable) != 0;
+}
+
 void CodeGenerator::generateFromBB(const BBP &bb) {
-    const LivenessTable liveness(bb);
+    const LivenessTable liveness(bb, *this->intervals);
+    this->enterBlock(bb);
+    this->blockStart = this->position;
     for (
         auto i = bb->getInstructions().begin(); 
         i != bb->getInstructions().end() - 1; 
         i++
     ) {
         this->generateFrom3AC(*i, liveness);
+        this->position++;
     }
 
-    if (bb->changesControlAtEnd()) {
+    // The registers are stored before the jump or the return ending the block.
+    const tac_line_t &last = *(bb->getInstructions().end() - 1);
+    if (bb->changesControlAtEnd() || last.operation == TAC_EXIT_PROC) {
         this->freeRegisters(liveness);
         this->generateFrom3AC(*(bb->getInstructions().end() - 1), liveness);
     } else {
         this->generateFrom3AC(*(bb->getInstructions().end() - 1), liveness);
         this->freeRegisters(liveness);
     }
+    this->position++;
 }
 
 void CodeGenerator::generateFrom3AC(
     const tac_line_t &inst,
     const LivenessTable &liveness
 ) {
+    // The values live into the procedure are loaded once the label that 
+    // enters it and the declarations have been placed.
+    if (!this->entryLoads.empty() && inst.operation != TAC_LABEL &&
+        inst.operation != TAC_ENTER_PROC && !isDeclaration(inst)) {
+            this->loadEntryValues();
+        }
+
     this->context.comment(TACGenerator::tacLineToString(inst));
 
     // If there are any literals, they need to be stored in the address table.
     this->addressTable.insertIfLiteral(inst.argument1, inst.table);
     this->addressTable.insertIfLiteral(inst.argument2, inst.table);
 
+    this->loadSpilledAddress(liveness, inst.argument1, inst.bid);
+    this->loadSpilledAddress(liveness, inst.argument2, inst.bid);
+    this->loadSpilledAddress(liveness, inst.result, inst.bid);
+
     // There are two kinds of instructions: those that require registers and 
     // those that do not.
     switch (inst.operation) {
@@ -49,8 +356,10 @@ void CodeGenerator::generateFrom3AC(
                 .insertText("\t" + this->tacToInstruction(inst.operation));
             break;
         case TAC_ENTER_PROC:
+            this->enterProcedure(inst);
             break;
         case TAC_EXIT_PROC:
+            this->generateReturn();
             break;
         case TAC_UNCOND_JMP:
             this->generateLabelledInstruction(inst.operation, inst.argument1);
@@ -58,18 +367,29 @@ void CodeGenerator::generateFrom3AC(
         case TAC_READ:
             break;
         case TAC_WRITE:
-            this->generateWrite(inst.argument1);
+            this->generateWrite(inst, liveness);
             break;
         case TAC_LABEL:
             this->generateLabel(inst.argument1);
+            if (this->enteringProcedure) {
+                this->storeParameters();
+            }
             break;
         case TAC_CALL:
+            if (this->isTailCall(inst)) {
+                this->generateTailCall(inst, liveness);
+            } else {
+                this->generateCall(inst, liveness);
+            }
+            break;
         case TAC_JMP_E ... TAC_JMP_ZERO:
             this->generateLabelledInstruction(inst.operation, inst.argument1);
             break;
         case TAC_RETVAL:
+            this->generateReturnValue(inst, liveness);
             break;
         case TAC_PROC_PARAM:
+            this->arguments.push_back(inst);
             break;
         case TAC_ASSIGN:
             if (inst.result != "" && inst.argument1 != ""
@@ -80,9 +400,14 @@ void CodeGenerator::generateFrom3AC(
                 this->generateSpecialAssignment(inst, liveness);
             }
             break;
-        case TAC_ADD ... TAC_MULT:
+        case TAC_ADD:
+        case TAC_SUB:
+        case TAC_MULT:
             this->convertGeneral3AC(inst, liveness);
             break;
+        case TAC_DIV:
+            this->generateDivision(inst, liveness);
+            break;
         case TAC_LESS_THAN ... TAC_NOT_EQUALS:
             this->generateConditional(inst, liveness);
             break;
@@ -111,19 +436,415 @@ void CodeGenerator::generateFrom3AC(
     }
 }
 
-void CodeGenerator::generateWrite(const std::string &variable) {
-    const Location toWrite = this->addressTable.getLocation(variable);
+void CodeGenerator::loadSpilledAddress(
+    const LivenessTable &liveness,
+    const std::string &variable,
+    const TID &instid
+) {
+    if (tac_line_t::is_user_defined_var(variable) || 
+        !this->references.count(variable) ||
+        this->addressTable.isInRegister(variable)) {
+            return;
+        }
+    this->getRegister(liveness, variable, instid, GPR, true);
+}
 
-    auto registersSaved = this->pushRegisters();
-    this->context.insertText("\tpushq \%rsi");
-    this->context.insertText("\tpushq \%rdi");
-    this->context.insertText("\tmovq " + toWrite.address() + ", \%rdi");
+void CodeGenerator::generateWrite(
+    const tac_line_t &inst,
+    const LivenessTable &liveness
+) {
+    const Location toWrite = this->addressTable.getLocation(inst.argument1);
+    const RegPtr argument = Registers::getArgumentRegisters().front();
+
+    auto registersSaved = this->saveRegisters(inst, liveness, false);
+    if (!toWrite.inRegister() || toWrite.isRegAddress() ||
+        toWrite.getRegister() != argument) {
+            this->context.insertText("\tmovq " + toWrite.address() + ", " + 
+                argument->getName());
+        }
     this->context.insertText("\tcall write_pl_0");
-    this->context.insertText("\tpopq \%rdi");
-    this->context.insertText("\tpopq \%rsi");
     this->popRegisters(registersSaved);
 }
 
+/**
+ * @param move The move of an argument.
+ * @return The operand the argument is read from.
+ */
+static std::string sourceOperand(const argument_move_t &move) {
+    if (move.source == nullptr) {
+        return move.operand;
+    }
+    return move.indirect ? 
+        move.source->getNameAsMemory() : move.source->getName();
+}
+
+void CodeGenerator::generateCall(
+    const tac_line_t &inst,
+    const LivenessTable &liveness
+) {
+    std::vector<argument_move_t> moves = this->findArguments();
+    auto registersSaved = this->saveRegisters(inst, liveness, true);
+
+    // The arguments that do not fit in registers are pushed from the last, 
+    // leaving the first on top of the stack. A value that is not in a 
+    // register or memory is computed in rax, which keeps its own value.
+    const size_t inRegisters = 
+        std::min(moves.size(), Registers::getArgumentRegisters().size());
+    const size_t onStack = moves.size() - inRegisters;
+
+    // The stack is aligned where the procedure is called, which keeps the 
+    // aligned slots of its frame aligned.
+    size_t pushed = onStack;
+    for (std::stack<RegPtr> saved = registersSaved; !saved.empty(); 
+        saved.pop()) {
+            pushed += isVectorRegister(saved.top()) ? 0 : 1;
+        }
+    const size_t padding = (StackTable::STACK_ALIGNMENT - 
+        8 * pushed % StackTable::STACK_ALIGNMENT) % 
+            StackTable::STACK_ALIGNMENT;
+    if (padding != 0) {
+        this->context.insertText(
+            "\tsubq $" + std::to_string(padding) + ", \%rsp"
+        );
+    }
+
+    for (size_t i = moves.size(); i-- > inRegisters;) {
+        const argument_move_t &move = moves.at(i);
+        if (move.source != nullptr || 
+            (move.instruction == "movq" && move.operand.at(0) != '$')) {
+                this->context.insertText("\tpushq " + sourceOperand(move));
+                continue;
+            }
+        this->context.insertText("\tpushq \%rax");
+        this->context.insertText(
+            "\t" + move.instruction + " " + move.operand + ", \%rax"
+        );
+        this->context.insertText("\txchgq \%rax, (\%rsp)");
+    }
+    moves.resize(inRegisters);
+    this->moveArguments(moves);
+
+    this->generateLabelledInstruction(inst.operation, inst.argument1);
+    if (onStack != 0 || padding != 0) {
+        this->context.insertText("\taddq $" + 
+            std::to_string(8 * onStack + padding) + ", \%rsp");
+    }
+    this->popRegisters(registersSaved);
+
+    std::vector<std::string> globals;
+    for (const auto &p : this->allocation) {
+        if (tac_line_t::is_user_defined_var(p.first)) {
+            globals.push_back(p.first);
+        }
+    }
+
+    // The variables used later are expected in their registers by the 
+    // blocks that follow.
+    for (const std::string &variable : globals) {
+        if (this->intervals->isLiveAfterCall(variable, this->position)) {
+            this->claimRegister(variable, true);
+        }
+    }
+}
+
+/**
+ * @param inst An instruction.
+ * @param name A name the instruction uses.
+ * @return True if the name is an array, which is passed by its address.
+ */
+static bool isArray(const tac_line_t &inst, const std::string &name) {
+    unsigned int level;
+    st_entry_t entry;
+    return inst.table->lookup(name, &level, &entry) && 
+        entry.entry_type == ST_VARIABLE && entry.variable.isArray;
+}
+
+bool CodeGenerator::isTailCall(const tac_line_t &inst) const {
+    if (!this->tailCalls.count(inst.bid)) {
+        return false;
+    }
+
+    // The arguments that do not fit in registers would be left in the frame 
+    // of the caller, which is left before the jump, as are its arrays.
+    if (this->arguments.size() > Registers::getArgumentRegisters().size()) {
+        return false;
+    }
+    for (const tac_line_t &parameter : this->arguments) {
+        if (isArray(parameter, parameter.argument1) && 
+            this->stackTable.inStack(parameter.argument1) && 
+            !this->references.count(parameter.argument1)) {
+                return false;
+            }
+    }
+    return true;
+}
+
+void CodeGenerator::generateTailCall(
+    const tac_line_t &inst,
+    const LivenessTable &liveness
+) {
+    std::vector<argument_move_t> moves = this->findArguments();
+    std::stack<RegPtr> registersSaved = 
+        this->saveRegisters(inst, liveness, true);
+
+    // Nothing but the globals, which are stored for the call, is read once 
+    // the procedure called returns.
+    ASSERT(registersSaved.empty());
+    this->moveArguments(moves);
+    this->tailJumps.emplace_back(
+        this->context.getTextLength(), inst.argument1
+    );
+
+    // Control does not come back, so the block ends with nothing to store.
+    this->addressTable.clearRegisters();
+    this->regTable.clear();
+}
+
+std::vector<argument_move_t> CodeGenerator::findArguments() {
+    const std::vector<RegPtr> &registers = Registers::getArgumentRegisters();
+
+    std::vector<argument_move_t> moves;
+    for (const tac_line_t &parameter : this->arguments) {
+        const bool array = isArray(parameter, parameter.argument1);
+        const Location location = 
+            this->addressTable.getLocation(parameter.argument1);
+
+        argument_move_t move;
+        move.destination = moves.size() < registers.size() ? 
+            registers.at(moves.size()) : nullptr;
+        move.instruction = "movq";
+        move.source = nullptr;
+        move.indirect = false;
+        move.setAside = -1;
+        if (location.inRegister()) {
+            // An array in a register is held by its address.
+            move.source = location.getRegister();
+            move.indirect = location.isRegAddress() && !array;
+        } else {
+            move.operand = location.address();
+            if (array && !this->references.count(parameter.argument1)) {
+                move.instruction = "leaq";
+            }
+        }
+        moves.push_back(move);
+    }
+    this->arguments.clear();
+    return moves;
+}
+
+void CodeGenerator::moveArguments(std::vector<argument_move_t> &moves) {
+    int setAside = 0;
+    while (!moves.empty()) {
+        // A register is overwritten once no other move reads it.
+        auto next = std::find_if(moves.begin(), moves.end(),
+            [&](const argument_move_t &move) {
+                return std::none_of(moves.begin(), moves.end(),
+                    [&](const argument_move_t &other) {
+                        return &other != &move && 
+                            other.source == move.destination;
+                    });
+            });
+
+        // Otherwise the registers left are moved in a cycle, which is 
+        // broken by setting the value of one of the moves aside.
+        if (next == moves.end()) {
+            next = std::find_if(moves.begin(), moves.end(),
+                [](const argument_move_t &move) {
+                    return move.source != nullptr;
+                });
+            ASSERT(next != moves.end());
+            this->context.insertText("\tpushq " + sourceOperand(*next));
+            next->source = nullptr;
+            next->indirect = false;
+            next->setAside = setAside++;
+            continue;
+        }
+
+        if (next->setAside >= 0) {
+            const int offset = 8 * (setAside - 1 - next->setAside);
+            next->operand = std::to_string(offset) + "(\%rsp)";
+        }
+        if (next->source != next->destination || next->indirect) {
+            this->context.insertText("\t" + next->instruction + " " + 
+                sourceOperand(*next) + ", " + next->destination->getName());
+        }
+        moves.erase(next);
+    }
+
+    if (setAside != 0) {
+        this->context.insertText(
+            "\taddq $" + std::to_string(8 * setAside) + ", \%rsp"
+        );
+    }
+}
+
+void CodeGenerator::enterProcedure(const tac_line_t &inst) {
+    unsigned int level;
+    st_entry_t entry;
+    const bool success = inst.table->lookup(inst.argument1, &level, &entry);
+
+    ASSERT(success);
+    ASSERT(entry.entry_type == ST_FUNCTION);
+
+    this->stackTable.newBaseAddress();
+
+    // The arguments that do not fit in registers are left by the caller 
+    // above the return address and the saved frame pointer.
+    const size_t inRegisters = Registers::getArgumentRegisters().size();
+    for (uint8_t i = 0; i < entry.procedure.argumentsLength; i++) {
+        const std::string name = entry.procedure.argumentNames[i];
+        if (i < inRegisters) {
+            this->parameters.push_back(name);
+            this->stackTable.allocate(name, 8);
+        } else {
+            this->stackTable.insertArgument(name, 8 * (i - inRegisters + 2));
+        }
+        if (entry.procedure.argumentIsArray[i]) {
+            this->references.insert(name);
+        }
+        this->addressTable.insert(name, this->memoryLocation(name));
+    }
+    if (entry.procedure.returnType != VOID) {
+        const std::string name = entry.procedure.returnTypeName;
+        this->stackTable.allocate(name, 8);
+        this->addressTable.insert(name, this->memoryLocation(name));
+    }
+    this->enteringProcedure = true;
+}
+
+void CodeGenerator::storeParameters() {
+    this->context.insertText("\tpushq \%rbp");
+    this->context.insertText("\tmovq \%rsp, \%rbp");
+    this->prologue = this->context.getTextLength();
+
+    const std::vector<RegPtr> &registers = Registers::getArgumentRegisters();
+    for (size_t i = 0; i < this->parameters.size(); i++) {
+        this->context.insertText("\tmovq " + registers.at(i)->getName() + 
+            ", " + this->memoryLocation(this->parameters.at(i)).address());
+    }
+    this->enteringProcedure = false;
+}
+
+void CodeGenerator::generateReturnValue(
+    const tac_line_t &inst,
+    const LivenessTable &liveness
+) {
+    const RegPtr result = Registers::getReturnRegister();
+    const Location value = this->addressTable.getLocation(inst.argument1);
+    if (value.inRegister() && !value.isRegAddress() && 
+        value.getRegister() == result) {
+            return;
+        }
+
+    // The value held in the return register is stored with the others 
+    // when the block ends, so it is stored first.
+    if (this->regTable.getAllRegistersInUse().count(result)) {
+        const std::string held = this->regTable.getVariableInRegister(result);
+        if (this->addressTable.isInRegister(held) && 
+            this->addressTable.getRegister(held) == result) {
+                if (this->isInMemory(held)) {
+                    this->storeVariable(
+                        held, result, liveness.isUpdated(held)
+                    );
+                } else {
+                    this->addressTable.remove(held);
+                }
+            }
+        this->regTable.freeRegister(result);
+    }
+
+    this->context.insertText(
+        "\tmovq " + value.address() + ", " + result->getName()
+    );
+}
+
+void CodeGenerator::generateReturn() {
+    std::vector<RegPtr> saved;
+    for (const RegPtr &reg : this->regTable.getRegistersWritten()) {
+        if (Registers::isCalleeSaved(reg)) {
+            saved.push_back(reg);
+        }
+    }
+    std::sort(saved.begin(), saved.end(), 
+        [](const RegPtr &a, const RegPtr &b) { return *a < *b; });
+
+    // The registers kept for the caller are saved in the frame below the 
+    // variables, so the size of the frame is only known now. Each is placed 
+    // ahead of the ones placed before it.
+    for (const RegPtr &reg : saved) {
+        this->stackTable.allocate(reg->getName(), 8);
+    }
+
+    // The procedure called by a tail call returns to the caller of this 
+    // one. The jumps follow the prologue, so they are placed first, from 
+    // the last, each line ahead of the ones placed before it.
+    for (auto i = this->tailJumps.rbegin(); i != this->tailJumps.rend(); 
+        i++) {
+            this->context.insertTextAt(i->first, "\tjmp " + 
+                tac_line_t::extract_label(i->second));
+            this->context.insertTextAt(i->first, "\tleave");
+            for (auto j = saved.rbegin(); j != saved.rend(); j++) {
+                this->context.insertTextAt(i->first, "\tmovq " + 
+                    this->getSaveSlot(*j) + ", " + (*j)->getName());
+            }
+        }
+    this->tailJumps.clear();
+    for (auto i = saved.rbegin(); i != saved.rend(); i++) {
+        this->context.insertTextAt(this->prologue, "\tmovq " + 
+            (*i)->getName() + ", " + this->getSaveSlot(*i));
+    }
+    this->context.insertTextAt(this->prologue, "\tsubq $" + 
+        std::to_string(this->stackTable.getFrameSize()) + ", \%rsp");
+
+    for (const RegPtr &reg : saved) {
+        this->context.insertText(
+            "\tmovq " + this->getSaveSlot(reg) + ", " + reg->getName()
+        );
+    }
+    this->context.insertText("\tleave");
+    this->context.insertText("\tret");
+}
+
+void CodeGenerator::buildFrame() {
+    if (this->stackTable.getStackSize() == 0) {
+        return;
+    }
+
+    // Each line is placed ahead of the ones placed before it.
+    this->context.insertTextAt(0, "\tsubq $" + 
+        std::to_string(this->stackTable.getFrameSize()) + ", \%rsp");
+    this->context.insertTextAt(0, "\tmovq \%rsp, \%rbp");
+    this->context.insertTextAt(0, "\tpushq \%rbp");
+    this->context.insertText("\tleave");
+}
+
+std::string CodeGenerator::getSaveSlot(const RegPtr &reg) {
+    const std::string &name = reg->getName();
+    if (!this->stackTable.inStack(name)) {
+        if (isVectorRegister(reg)) {
+            this->stackTable.allocate(name, 32, StackTable::STACK_ALIGNMENT);
+        } else {
+            this->stackTable.allocate(name, 8);
+        }
+    }
+    return std::to_string(this->stackTable.getAddress(name)) + "(\%rbp)";
+}
+
+bool CodeGenerator::isInMemory(const std::string &variable) const {
+    return this->stackTable.inStack(variable) || 
+        this->globalTable.isGlobal(variable);
+}
+
+Location CodeGenerator::memoryLocation(const std::string &variable) const {
+    // A variable of the frame hides a global of the same name.
+    if (this->stackTable.inStack(variable)) {
+        return Location(LT_MEMORY_STACK)
+            .setStack(this->stackTable.getAddress(variable));
+    }
+    return Location(LT_MEMORY_GLOBAL)
+        .setImmValueOrGlobal(this->globalTable.getLabel(variable));
+}
+
 void CodeGenerator::generateSpecialAssignment(
     const tac_line_t &inst,
     const LivenessTable &liveness
@@ -139,44 +860,390 @@ void CodeGenerator::generateSpecialAssignment(
             return;
     }
     
-    const Location &source = this->addressTable.getLocation(inst.argument1);
+    if (this->coalesceCopy(inst, liveness)) {
+        return;
+    }
+
+    std::string sourceAddr 
+        = this->addressTable.getLocation(inst.argument1).address();
 
     std::string resultAddr;
 
-    if (this->addressTable.contains(inst.result)) {
+    if (this->isAllocated(inst.result)) {
+        resultAddr = this->claimRegister(inst.result, false)->getName();
+        if (sourceAddr == resultAddr) {
+            return;
+        }
+    } else if (this->addressTable.contains(inst.result)) {
         Location &dest = this->addressTable.getLocation(inst.result);
         resultAddr = dest.address();
+
+        // There is no memory to memory move, so the source is loaded first.
+        const Location &source = this->addressTable.getLocation(inst.argument1);
+        if ((dest.inMemory() || dest.isRegAddress()) && 
+            (source.inMemory() || source.isRegAddress())) {
+                sourceAddr = this->forceRegister(
+                    liveness, inst.argument1, inst.bid, GPR
+                )->getName();
+            }
     } else {
         RegPtr reg = this->getRegister(liveness, inst.result, inst.bid, GPR);
         resultAddr = reg->getName();
     }
 
     const std::string instertion = "\t" + instStr + " " + 
-        source.address() + ", " + resultAddr;
+        sourceAddr + ", " + resultAddr;
 
     this->context.insertText(instertion);
 }
 
+bool CodeGenerator::coalesceCopy(
+    const tac_line_t &inst,
+    const LivenessTable &liveness
+) {
+    const std::string &source = inst.argument1;
+    if (this->isAllocated(source) || this->isAllocated(inst.result) ||
+        tac_line_t::is_user_defined_var(source) || 
+        !this->addressTable.isInRegister(source) ||
+        this->addressTable.getLocation(source).isRegAddress() ||
+        liveness.getLivenessAndNextUse(inst.bid).isLive(source)) {
+            return false;
+        }
+
+    // The result may not already be in a register, which would then hold a 
+    // stale copy of it, nor be an element that is written in place.
+    if ((this->addressTable.contains(inst.result) &&
+        this->addressTable.getLocation(inst.result).inRegister()) ||
+        this->isElementInMemory(inst.result)) {
+            return false;
+        }
+
+    const RegPtr reg = this->addressTable.getRegister(source);
+    this->addressTable.insert(inst.result, Location(LT_REGISTER).setReg(reg));
+    this->regTable.setRegisterValue(reg, inst.result);
+    return true;
+}
+
+/**
+ * @param value A value.
+ * @param shift Set to the power of two the value is.
+ * @return True if the value is a power of two, else false.
+ */
+static bool findPowerOfTwo(const long long value, unsigned int &shift) {
+    if (value <= 0 || (value & (value - 1)) != 0) {
+        return false;
+    }
+    shift = __builtin_ctzll(value);
+    return true;
+}
+
+/**
+ * Finds the magic number of a divisor, which is multiplied by a dividend to 
+ * give the quotient shifted into the high half of the product, as given by 
+ * Hacker's Delight. The divisor must not be -1, 0 or 1.
+ * @param divisor The divisor.
+ * @param magic Set to the magic number.
+ * @param shift Set to the shift of the high half of the product.
+ */
+static void findMagicNumber(
+    const long long divisor,
+    long long &magic,
+    unsigned int &shift
+) {
+    const unsigned long long two63 = 1ULL << 63;
+    const unsigned long long absolute = divisor < 0 ? 
+        -(unsigned long long) divisor : (unsigned long long) divisor;
+    const unsigned long long t = 
+        two63 + ((unsigned long long) divisor >> 63);
+    const unsigned long long anc = t - 1 - t % absolute;
+
+    unsigned int p = 63;
+    unsigned long long q1 = two63 / anc;
+    unsigned long long r1 = two63 - q1 * anc;
+    unsigned long long q2 = two63 / absolute;
+    unsigned long long r2 = two63 - q2 * absolute;
+    unsigned long long delta;
+    do {
+        p++;
+        q1 *= 2;
+        r1 *= 2;
+        if (r1 >= anc) {
+            q1++;
+            r1 -= anc;
+        }
+        q2 *= 2;
+        r2 *= 2;
+        if (r2 >= absolute) {
+            q2++;
+            r2 -= absolute;
+        }
+        delta = absolute - r2;
+    } while (q1 < delta || (q1 == delta && r1 == 0));
+
+    magic = (long long) (q2 + 1);
+    if (divisor < 0) {
+        magic = -magic;
+    }
+    shift = p - 64;
+}
+
+/**
+ * @param location The location of an operand.
+ * @return True if the operand is read from a register, else false.
+ */
+static bool isReadFromRegister(const Location &location) {
+    return location.inRegister() && !location.isRegAddress();
+}
+
 void CodeGenerator::convertGeneral3AC(
     const tac_line_t &inst,
     const LivenessTable &liveness
 ) {
     const std::string instStr = this->tacToInstruction(inst.operation);
 
-    const RegPtr &reg = 
-        this->forceRegister(liveness, inst.argument1, inst.bid, GPR);
+    // The second operand may be an immediate or memory, so the operands of 
+    // an operation that commutes are swapped to read such an operand there, 
+    // unless the result is written over the first operand.
+    std::string first = inst.argument1;
+    std::string second = inst.argument2;
+    if (inst.operation == TAC_ADD || inst.operation == TAC_MULT) {
+        const Location &lhs = this->addressTable.getLocation(first);
+        const Location &rhs = this->addressTable.getLocation(second);
+        if ((lhs.isImmediate() && !rhs.isImmediate()) || 
+            (inst.result != first && !lhs.isImmediate() && 
+                !isReadFromRegister(lhs) && isReadFromRegister(rhs))) {
+                    std::swap(first, second);
+                }
+    }
 
-    // Instruction is in the form a = b (op) c.
-    const Location &other = this->addressTable.getLocation(inst.argument2);
+    // A multiplication by a power of two is a shift.
+    unsigned int shift = 0;
+    const Location &other = this->addressTable.getLocation(second);
+    const bool immediate = inst.operation == TAC_MULT && other.isImmediate();
+    if (immediate) {
+        findPowerOfTwo(std::stoll(other.getImmValueOrGlobal()), shift);
+    }
 
-    this->context.insertText(
-        "\t" + instStr + "q " + other.address() + ", " + reg->getName()
-    );
+    const RegPtr source = 
+        this->forceRegister(liveness, first, inst.bid, GPR);
+    const RegPtr reg = 
+        this->getOperationRegister(inst, first, source, liveness);
+
+    // Instruction is in the form a = b (op) c. A multiplication into 
+    // another register needs no copy of its operand.
+    if (shift != 0 && shift <= 3 && reg != source) {
+        this->context.insertText("\tleaq (," + source->getName() + ", " + 
+            std::to_string(1 << shift) + "), " + reg->getName());
+    } else if (immediate && shift == 0 && reg != source) {
+        this->context.insertText("\timulq " + other.address() + ", " + 
+            source->getName() + ", " + reg->getName());
+    } else {
+        if (reg != source) {
+            this->context.insertText(
+                "\tmovq " + source->getName() + ", " + reg->getName()
+            );
+        }
+        if (shift != 0) {
+            this->context.insertText("\tshlq $" + std::to_string(shift) + 
+                ", " + reg->getName());
+        } else {
+            this->context.insertText("\t" + instStr + "q " + 
+                other.address() + ", " + reg->getName());
+        }
+    }
+
+    this->setResultRegister(inst, first, reg);
+}
+
+RegPtr CodeGenerator::getOperationRegister(
+    const tac_line_t &inst,
+    const std::string &first,
+    const RegPtr &source,
+    const LivenessTable &liveness
+) {
+    // The instruction overwrites its first operand, so an operand that is 
+    // used again or that keeps its register is copied into a register for 
+    // the result first.
+    if (inst.result != first && 
+        (liveness.getLivenessAndNextUse(inst.bid).isLive(first) ||
+        liveness.getLivenessAndNextUse(inst.bid).hasNextUse(first) ||
+        this->isAllocated(first) || this->isAllocated(inst.result))) {
+            return this->getResultRegister(
+                liveness, inst.result, inst.bid, GPR
+            );
+        }
+    return source;
+}
 
+void CodeGenerator::setResultRegister(
+    const tac_line_t &inst,
+    const std::string &first,
+    const RegPtr &reg
+) {
+    // An operand that was not copied is dead, and its register now holds 
+    // the result.
+    if (inst.result != first && 
+        this->addressTable.isInRegister(first) &&
+        this->addressTable.getRegister(first) == reg) {
+            if (this->isInMemory(first)) {
+                this->addressTable.insert(first, this->memoryLocation(first));
+            } else {
+                this->addressTable.remove(first);
+            }
+        }
+
+    this->releaseOldRegister(inst.result, reg);
     this->addressTable.insert(inst.result, Location(LT_REGISTER).setReg(reg));
     this->regTable.setRegisterValue(reg, inst.result);
 }
 
+void CodeGenerator::generateDivision(
+    const tac_line_t &inst,
+    const LivenessTable &liveness
+) {
+    const Location &divisor = this->addressTable.getLocation(inst.argument2);
+    if (divisor.isImmediate()) {
+        const long long value = std::stoll(divisor.getImmValueOrGlobal());
+        unsigned int shift;
+        if (value != LLONG_MIN && 
+            findPowerOfTwo(value < 0 ? -value : value, shift)) {
+                this->generateShiftDivision(inst, shift, value < 0, liveness);
+                return;
+            }
+    }
+    this->generateWideDivision(inst, liveness);
+}
+
+void CodeGenerator::generateShiftDivision(
+    const tac_line_t &inst,
+    const unsigned int shift,
+    const bool negative,
+    const LivenessTable &liveness
+) {
+    const RegPtr source = 
+        this->forceRegister(liveness, inst.argument1, inst.bid, GPR);
+    const RegPtr reg = 
+        this->getOperationRegister(inst, inst.argument1, source, liveness);
+
+    if (shift == 0) {
+        if (reg != source) {
+            this->context.insertText(
+                "\tmovq " + source->getName() + ", " + reg->getName()
+            );
+        }
+    } else {
+        // A negative dividend is biased by the divisor less one, so that 
+        // the arithmetic shift rounds it toward zero.
+        RegPtr bias = reg;
+        if (reg == source) {
+            const std::set<RegPtr> reserved = this->regTable.getReserved();
+            std::set<RegPtr> kept = reserved;
+            kept.insert(source);
+            this->regTable.setReserved(kept);
+            bias = this->getScratchRegister(liveness, GPR);
+            this->regTable.setReserved(reserved);
+        }
+
+        this->context.insertText(
+            "\tmovq " + source->getName() + ", " + bias->getName()
+        );
+        if (shift > 1) {
+            this->context.insertText("\tsarq $63, " + bias->getName());
+        }
+        this->context.insertText("\tshrq $" + std::to_string(64 - shift) + 
+            ", " + bias->getName());
+        this->context.insertText(
+            "\taddq " + (bias == reg ? source : bias)->getName() + ", " + 
+                reg->getName()
+        );
+        this->context.insertText(
+            "\tsarq $" + std::to_string(shift) + ", " + reg->getName()
+        );
+    }
+
+    if (negative) {
+        this->context.insertText("\tnegq " + reg->getName());
+    }
+    this->setResultRegister(inst, inst.argument1, reg);
+}
+
+void CodeGenerator::generateWideDivision(
+    const tac_line_t &inst,
+    const LivenessTable &liveness
+) {
+    const RegPtr rax = Registers::getWideRegisters().first;
+    const RegPtr rdx = Registers::getWideRegisters().second;
+
+    // The operands are kept out of rax and rdx, which the division writes.
+    this->evictRegister(liveness, rax);
+    this->evictRegister(liveness, rdx);
+    const std::set<RegPtr> reserved = this->regTable.getReserved();
+    std::set<RegPtr> kept = reserved;
+    kept.insert({ rax, rdx });
+    this->regTable.setReserved(kept);
+
+    const RegPtr source = 
+        this->forceRegister(liveness, inst.argument1, inst.bid, GPR);
+    const Location &divisor = this->addressTable.getLocation(inst.argument2);
+
+    const long long value = divisor.isImmediate() ? 
+        std::stoll(divisor.getImmValueOrGlobal()) : 0;
+
+    RegPtr quotient;
+    if (value != 0 && value != LLONG_MIN) {
+            long long magic;
+            unsigned int shift;
+            findMagicNumber(value, magic, shift);
+
+            // The high half of the product is the quotient, rounded down 
+            // and then toward zero.
+            this->context.insertText(
+                "\tmovq $" + std::to_string(magic) + ", \%rax"
+            );
+            this->context.insertText("\timulq " + source->getName());
+            if (value > 0 && magic < 0) {
+                this->context.insertText(
+                    "\taddq " + source->getName() + ", \%rdx"
+                );
+            } else if (value < 0 && magic > 0) {
+                this->context.insertText(
+                    "\tsubq " + source->getName() + ", \%rdx"
+                );
+            }
+            if (shift != 0) {
+                this->context.insertText(
+                    "\tsarq $" + std::to_string(shift) + ", \%rdx"
+                );
+            }
+            this->context.insertText("\tmovq \%rdx, \%rax");
+            this->context.insertText("\tshrq $63, \%rax");
+            this->context.insertText("\taddq \%rax, \%rdx");
+            quotient = rdx;
+        } else {
+            kept.insert(source);
+            this->regTable.setReserved(kept);
+            const RegPtr by = 
+                this->forceRegister(liveness, inst.argument2, inst.bid, GPR);
+
+            this->context.insertText(
+                "\tmovq " + source->getName() + ", \%rax"
+            );
+            this->context.insertText("\tcqto");
+            this->context.insertText("\tidivq " + by->getName());
+            quotient = rax;
+        }
+    this->regTable.setReserved(reserved);
+
+    RegPtr reg = quotient;
+    if (this->isAllocated(inst.result)) {
+        reg = this->claimRegister(inst.result, false);
+        this->context.insertText(
+            "\tmovq " + quotient->getName() + ", " + reg->getName()
+        );
+    }
+    this->setResultRegister(inst, inst.argument1, reg);
+}
+
 void CodeGenerator::generateConditional(
     const tac_line_t &inst,
     const LivenessTable &liveness
@@ -186,8 +1253,10 @@ void CodeGenerator::generateConditional(
     // Two cases in which the comparison is stored or not.
     const std::string instStr = this->tacToInstruction(inst.operation);
 
-    const RegPtr &reg = 
-        this->getRegister(liveness, inst.argument1, inst.bid, GPR);
+    // The operand may already be in a register if it was defined earlier in 
+    // the block, such as in the footer of a rotated loop.
+    const RegPtr reg = 
+        this->forceRegister(liveness, inst.argument1, inst.bid, GPR);
     ASSERT(this->regTable.getVariableInRegister(reg) == inst.argument1);
     ASSERT(this->addressTable.getLocation(inst.argument1).inRegister());
     
@@ -210,20 +1279,26 @@ void CodeGenerator::generateArrayIndex(
     const tac_line_t &inst,
     const LivenessTable &liveness
 ) {
-    // Load the index and the array into registers. The index will be an 
-    // immediate value stored in the register while the array is an address.
-    const RegPtr idxReg = 
-        this->forceRegister(liveness, inst.argument2, inst.bid, GPR);
+    Location element;
+    if (this->findConstantElement(inst, element)) {
+        this->releaseOldRegister(inst.result, nullptr);
+        this->addressTable.insert(inst.result, element);
+        return;
+    }
 
-    const RegPtr arrayReg = 
-        this->forceRegister(liveness, inst.argument1, inst.bid, GPR, true);
+    const std::string operand = this->selectElement(inst, liveness);
 
+    // The address is computed again in its own register, as the registers 
+    // of the operand may be reused before the element is.
+    if (this->addressTable.contains(inst.result) && 
+        !this->addressTable.isInRegister(inst.result)) {
+            this->addressTable.remove(inst.result);
+        }
     const RegPtr result = 
         this->getRegister(liveness, inst.result, inst.bid, GPR, true);
 
     this->context.insertText(
-        "\tleaq (" + arrayReg->getName() + ", " + idxReg->getName() + 
-            ", 8), " + result->getName()
+        "\tleaq " + operand + ", " + result->getName()
     );
 
     this->addressTable
@@ -234,13 +1309,98 @@ void CodeGenerator::generateArrayIndex(
     this->regTable.setRegisterValue(result, inst.result);
 }
 
+bool CodeGenerator::findConstantElement(
+    const tac_line_t &inst,
+    Location &element
+) {
+    const std::string &array = inst.argument1;
+    const Location &index = this->addressTable.getLocation(inst.argument2);
+    if (!index.isImmediate() || this->references.count(array)) {
+        return false;
+    }
+
+    const long long offset = 8 * std::stoll(index.getImmValueOrGlobal());
+    if (offset < 0 || offset > INT_MAX) {
+        return false;
+    }
+
+    if (this->stackTable.inStack(array)) {
+        element = Location(LT_MEMORY_STACK)
+            .setStack(this->stackTable.getAddress(array) + offset);
+        return true;
+    }
+    if (this->globalTable.isGlobal(array)) {
+        const std::string label = this->globalTable.getLabel(array);
+        element = Location(LT_MEMORY_GLOBAL).setImmValueOrGlobal(
+            offset == 0 ? label : label + "+" + std::to_string(offset)
+        );
+        return true;
+    }
+    return false;
+}
+
+std::string CodeGenerator::selectElement(
+    const tac_line_t &inst,
+    const LivenessTable &liveness
+) {
+    Location element;
+    if (this->findConstantElement(inst, element)) {
+        return element.address();
+    }
+
+    const std::string &array = inst.argument1;
+    const Location &index = this->addressTable.getLocation(inst.argument2);
+
+    // An array parameter holds the address of the array, which is loaded 
+    // into a register, and the constant index becomes the displacement.
+    if (index.isImmediate()) {
+        const RegPtr arrayReg = 
+            this->forceRegister(liveness, array, inst.bid, GPR, true);
+        const long long offset = 8 * std::stoll(index.getImmValueOrGlobal());
+        return (offset == 0 ? "" : std::to_string(offset)) + 
+            arrayReg->getNameAsMemory();
+    }
+
+    const RegPtr idxReg = 
+        this->forceRegister(liveness, inst.argument2, inst.bid, GPR);
+
+    // An array in the frame is found from the frame pointer.
+    if (this->stackTable.inStack(array) && !this->references.count(array)) {
+        return std::to_string(this->stackTable.getAddress(array)) + 
+            "(\%rbp, " + idxReg->getName() + ", 8)";
+    }
+
+    const RegPtr arrayReg = 
+        this->forceRegister(liveness, array, inst.bid, GPR, true);
+    return "(" + arrayReg->getName() + ", " + idxReg->getName() + ", 8)";
+}
+
+bool CodeGenerator::isElementInMemory(const std::string &variable) {
+    return !tac_line_t::is_user_defined_var(variable) && 
+        !this->isInMemory(variable) && 
+        this->addressTable.contains(variable) &&
+        this->addressTable.getLocation(variable).inMemory();
+}
+
 void CodeGenerator::generateVaribleDeclaration(
     const tac_line_t &inst
 ) {
     if (this->stackTable.inGlobalScope()) {
-        this->storeVariableInGlobalMemoryInit(inst.result, inst.table);
+        this->storeVariableInGlobalMemoryInit(inst);
+        return;
+    }
+
+    unsigned int level;
+    st_entry_t entry;
+    const bool success = inst.table->lookup(inst.result, &level, &entry);
+    ASSERT(success);
+
+    // Arrays are aligned for the vector instructions that load them.
+    if (entry.variable.isArray) {
+        this->storeVariableInStack(inst.result, 
+            entry.variable.arraySize * 8, StackTable::STACK_ALIGNMENT);
     } else {
-        this->storeVariableInStack(inst.result, 8);
+        this->storeVariableInStack(inst.result, 8, 8);
     }
 }
 
@@ -271,10 +1431,15 @@ void CodeGenerator::generateGeneralYmmOperation(
     ASSERT(rhs.inRegister());
 
     RegPtr result;
-    if (!lmap.isLive(inst.argument1) && !lmap.hasNextUse(inst.argument1)) {
+    if (this->isAllocated(inst.result)) {
+        result = this->claimRegister(inst.result, false);
+    }
+    else if (!this->isAllocated(inst.argument1) &&
+        !lmap.isLive(inst.argument1) && !lmap.hasNextUse(inst.argument1)) {
         result = lhs.getRegister();
     } 
-    else if (!lmap.isLive(inst.argument2) && !lmap.hasNextUse(inst.argument2)) {
+    else if (!this->isAllocated(inst.argument2) &&
+        !lmap.isLive(inst.argument2) && !lmap.hasNextUse(inst.argument2)) {
         result = rhs.getRegister();
     } else {
         result = this->getRegister(liveness, inst.result, inst.bid, AVX);
@@ -295,14 +1460,7 @@ void CodeGenerator::generateYmmLoad(
     const LivenessTable &liveness,
     const tac_line_t &inst
 ) {
-    const RegPtr idxReg = 
-        this->forceRegister(liveness, inst.argument2, inst.bid, GPR);
-
-    const RegPtr arrayReg = 
-        this->forceRegister(liveness, inst.argument1, inst.bid, GPR, true);
-
-    const std::string memory = 
-        "(" + arrayReg->getName() + ", " + idxReg->getName() + ", 8)";
+    const std::string memory = this->selectElement(inst, liveness);
 
     RegPtr result =
         this->getRegister(liveness, inst.result, inst.bid, AVX, false);
@@ -317,14 +1475,7 @@ void CodeGenerator::generateYmmStore(
     const LivenessTable &liveness,
     const tac_line_t &inst
 ) {
-    const RegPtr idxReg = 
-        this->forceRegister(liveness, inst.argument2, inst.bid, GPR);
-
-    const RegPtr arrayReg = 
-        this->forceRegister(liveness, inst.argument1, inst.bid, GPR, true);
-
-    const std::string memory = 
-        "(" + arrayReg->getName() + ", " + idxReg->getName() + ", 8)";
+    const std::string memory = this->selectElement(inst, liveness);
 
     RegPtr result =
         this->getRegister(liveness, inst.result, inst.bid, AVX);
@@ -352,7 +1503,7 @@ void CodeGenerator::generateYmmAssign(
     );
     this->addressTable
         .insert(inst.result, Location(LT_REGISTER).setReg(result));
-    this->regTable.setRegisterValue(result, inst.argument1);
+    this->regTable.setRegisterValue(result, inst.result);
 }
 
 Location CodeGenerator::getLargeImmediate(const Location immediate) {
@@ -398,6 +1549,10 @@ RegPtr CodeGenerator::getRegister(
     const register_type_t &type,
     const bool address
 ) {
+    if (this->isAllocated(variable)) {
+        return this->claimRegister(variable, true);
+    }
+
     RegPtr reg;
 
     if (
@@ -405,19 +1560,18 @@ RegPtr CodeGenerator::getRegister(
         && !liveness.getLivenessAndNextUse(instid).isLive(variable)
     ) {
         reg = this->addressTable.getRegister(variable);
-        if (this->globalTable.isGlobal(variable) 
-            || this->stackTable.inStack(variable)) {
-                this->storeContentFromRegister(reg);
+        if (this->isInMemory(variable)) {
+            this->storeContentFromRegister(reg);
         }
     } 
     else if (this->regTable.atLeastOneRegisterUnused(type)) {
         reg = this->regTable.getUnusedRegister(type);
     } 
     else {
-        reg = this->regTable.getARegisterInUse(type);
-        this->storeContentFromRegister(reg);
+        reg = this->spillRegister(liveness, type);
     }
 
+    this->releaseOldRegister(variable, reg);
     this->generateMovToRegisterIfInMemory(variable, reg, address);
     this->regTable.setRegisterValue(reg, variable);
     this->addressTable.insert(variable, Location(LT_REGISTER)
@@ -427,6 +1581,99 @@ RegPtr CodeGenerator::getRegister(
     return reg;
 }
 
+void CodeGenerator::releaseOldRegister(
+    const std::string &variable,
+    const RegPtr &reg
+) {
+    if (!this->addressTable.isInRegister(variable)) {
+        return;
+    }
+
+    const RegPtr old = this->addressTable.getRegister(variable);
+    if (old != reg && this->regTable.getAllRegistersInUse().count(old) != 0 &&
+        this->regTable.getVariableInRegister(old) == variable) {
+            this->regTable.freeRegister(old);
+        }
+}
+
+RegPtr CodeGenerator::chooseSpilledRegister(
+    const LivenessTable &liveness,
+    const register_type_t &type
+) const {
+    const size_t index = this->position - this->blockStart;
+
+    RegPtr chosen = nullptr;
+    STID chosenRead = 0;
+    bool chosenUpdated = true;
+    for (const RegPtr &reg : this->regTable.getRegistersInUse(type)) {
+        const std::string variable = this->regTable.getVariableInRegister(reg);
+        STID read = liveness.getNextRead(index, variable);
+        if (read == NEVER_USED) {
+            read = INT_MAX;
+        }
+        const bool updated = liveness.isUpdated(variable);
+
+        if (chosen == nullptr || read > chosenRead || 
+            (read == chosenRead && chosenUpdated && !updated)) {
+                chosen = reg;
+                chosenRead = read;
+                chosenUpdated = updated;
+            }
+    }
+
+    ASSERT(chosen != nullptr);
+    return chosen;
+}
+
+RegPtr CodeGenerator::spillRegister(
+    const LivenessTable &liveness,
+    const register_type_t &type
+) {
+    const RegPtr reg = this->chooseSpilledRegister(liveness, type);
+    this->evictRegister(liveness, reg);
+    return reg;
+}
+
+void CodeGenerator::evictRegister(
+    const LivenessTable &liveness,
+    const RegPtr &reg
+) {
+    if (!this->regTable.getAllRegistersInUse().count(reg)) {
+        return;
+    }
+
+    const std::string spilled = this->regTable.getVariableInRegister(reg);
+    if (this->addressTable.isInRegister(spilled) && 
+        this->addressTable.getRegister(spilled) == reg) {
+            this->storeVariable(spilled, reg, liveness.isUpdated(spilled));
+        } else {
+            // A value with no name of its own is loaded again if needed.
+            this->regTable.freeRegister(reg);
+        }
+}
+
+RegPtr CodeGenerator::getScratchRegister(
+    const LivenessTable &liveness,
+    const register_type_t &type
+) {
+    if (this->regTable.atLeastOneRegisterUnused(type)) {
+        return this->regTable.getUnusedRegister(type);
+    }
+    return this->spillRegister(liveness, type);
+}
+
+RegPtr CodeGenerator::getResultRegister(
+    const LivenessTable &liveness,
+    const std::string &variable,
+    const TID &instid,
+    const register_type_t &type
+) {
+    if (this->isAllocated(variable)) {
+        return this->claimRegister(variable, false);
+    }
+    return this->getRegister(liveness, variable, instid, type);
+}
+
 RegPtr CodeGenerator::forceRegister(
     const LivenessTable &liveness,
     const std::string &variable,
@@ -434,6 +1681,20 @@ RegPtr CodeGenerator::forceRegister(
     const register_type_t &type,
     const bool address
 ) {
+    // An element used in place stays where it is while it is written again, 
+    // so its value is loaded into a register of no name.
+    if (!address && this->isElementInMemory(variable) && 
+        liveness.getLivenessAndNextUse(instid).hasNextUse(variable)) {
+            const RegPtr reg = this->getScratchRegister(liveness, type);
+            const std::string element = 
+                this->addressTable.getLocation(variable).address();
+            this->context.insertText(
+                "\tmovq " + element + ", " + reg->getName()
+            );
+            this->regTable.setRegisterValue(reg, "*" + element);
+            return reg;
+        }
+
     const bool existsOutsideRegister = this->addressTable.contains(variable);
 
     if (existsOutsideRegister) {
@@ -443,6 +1704,13 @@ RegPtr CodeGenerator::forceRegister(
         if (location.inRegister()) {
 
             if (location.isRegAddress() && !address) {
+                // An address that is used again, such as by the store of 
+                // a[i] := a[i] + 1, keeps its register if one is free.
+                if (liveness.getLivenessAndNextUse(instid).hasNextUse(variable) &&
+                    this->regTable.atLeastOneRegisterUnused(type)) {
+                        return this->loadThroughAddress(location, type);
+                    }
+
                 // Allocate a new register to store the value of the address.
                 RegPtr reg = 
                     this->getRegister(liveness, variable, instid, type, address);
@@ -464,6 +1732,21 @@ RegPtr CodeGenerator::forceRegister(
     return this->getRegister(liveness, variable, instid, type, address);
 }
 
+RegPtr CodeGenerator::loadThroughAddress(
+    const Location &location,
+    const register_type_t &type
+) {
+    const RegPtr reg = this->regTable.getUnusedRegister(type);
+    this->context.insertText(
+        "\tmovq " + location.address(true) + ", " + reg->getName()
+    );
+
+    // The value has no name of its own, so it is only held until the 
+    // register is needed again.
+    this->regTable.setRegisterValue(reg, "*" + location.address(true));
+    return reg;
+}
+
 void CodeGenerator::generateMovToRegisterIfInMemory(
     const std::string &variable,
     const RegPtr &reg,
@@ -472,7 +1755,13 @@ void CodeGenerator::generateMovToRegisterIfInMemory(
     if (this->addressTable.contains(variable)) {
         const Location oldLocation = this->addressTable.getLocation(variable);
         if (!oldLocation.inRegister()) {
-            const std::string instStr = (address) ? "leaq" : "movq";
+            // An array parameter holds the address of the array.
+            std::string instStr = 
+                (address && !this->references.count(variable)) ? 
+                    "leaq" : "movq";
+            if (isVectorRegister(reg)) {
+                instStr = "vmovapd";
+            }
 
             this->context.insertText(
                 "\t" + instStr + " " + oldLocation.address() + ", " + 
@@ -490,12 +1779,14 @@ void CodeGenerator::storeContentFromRegister(RegPtr &reg) {
 
 void CodeGenerator::storeVariable(
     const std::string &variable, 
-    const RegPtr &reg
+    const RegPtr &reg,
+    const bool updated
 ) {
-    if (this->globalTable.isGlobal(variable)) {
-        this->storeVariableInGlobalMemory(variable, reg);
+    if (this->stackTable.inStack(variable) || 
+        !this->globalTable.isGlobal(variable)) {
+            this->storeVariableInStack(variable, reg, updated);
     } else {
-        this->storeVariableInStack(variable, reg);
+        this->storeVariableInGlobalMemory(variable, reg, updated);
     }
 }
 
@@ -504,49 +1795,36 @@ void CodeGenerator::storeVariableInGlobalMemory(
     const RegPtr &reg,
     const bool updated
 ) {
+    const std::string label = this->globalTable.getLabel(variable);
     if (updated) {
         const std::string storeInst = 
-            "\tmovq " + reg->getName() + ", " + variable + "(%rip)";
+            "\tmovq " + reg->getName() + ", " + label + "(%rip)";
         this->context.insertText(storeInst);
     }
     this->regTable.freeRegister(reg);
     this->addressTable
         .insert(variable, Location(LT_MEMORY_GLOBAL)
-        .setImmValueOrGlobal(variable));
+        .setImmValueOrGlobal(label));
 }
 
-void CodeGenerator::storeVariableInGlobalMemoryInit(
-    const std::string &variable,
-    std::shared_ptr<SymbolTable> table
-) {
-    unsigned int level;
-    st_entry_t entry;
-    const bool success = table->lookup(variable, &level, &entry);
-
-    ASSERT(success);
-    ASSERT(entry.entry_type == ST_VARIABLE);
+void CodeGenerator::storeVariableInGlobalMemoryInit(const tac_line_t &inst) {
+    const st_entry_t entry = this->declareGlobal(inst);
 
     if (entry.variable.isArray) {
         const size_t arrSize = entry.variable.arraySize * 8;
-        this->context.insertGlobalArray(variable, arrSize);
-        this->globalTable.insertGlobalArray(variable, arrSize);
+        this->context.insertGlobalArray(inst.result, arrSize);
     } else {
-        this->context.insertGlobalVariable(variable, 8, 0);
-        this->globalTable.insertGlobalVariable(variable, 8);
+        this->context.insertGlobalVariable(inst.result, 8, 0);
     }
-
-    this->addressTable
-        .insert(variable, Location(LT_MEMORY_GLOBAL)
-        .setImmValueOrGlobal(variable));
 }
 
 void CodeGenerator::storeVariableInStack(
     const std::string &variable,
-    const unsigned int size
+    const unsigned int size,
+    const unsigned int alignment
 ) {
-    unsigned int offset = this->stackTable.allocate(variable, size);
-    this->addressTable
-        .insert(variable, Location(LT_MEMORY_STACK).setStack(offset));
+    this->stackTable.allocate(variable, size, alignment);
+    this->addressTable.insert(variable, this->memoryLocation(variable));
 }
 
 void CodeGenerator::storeVariableInStack(
@@ -554,21 +1832,36 @@ void CodeGenerator::storeVariableInStack(
     const RegPtr &reg,
     const bool updated
 ) {
-    unsigned int offset;
+    // The address of an array element is loaded back into a register 
+    // before it is used, like the address held by an array parameter.
+    if (!tac_line_t::is_user_defined_var(variable) &&
+        this->addressTable.isInRegister(variable) && 
+        this->addressTable.getLocation(variable).isRegAddress()) {
+            this->references.insert(variable);
+        }
 
-    if (this->stackTable.inStack(variable)) {
-        offset = this->stackTable.getAddress(variable);
-    } else {
-        offset = this->stackTable.allocate(variable, 8);
+    // A value that has no slot yet is only held by the register.
+    const bool vector = isVectorRegister(reg);
+    const bool placed = this->stackTable.inStack(variable);
+    if (!placed) {
+        if (vector) {
+            this->stackTable.allocate(
+                variable, 32, StackTable::STACK_ALIGNMENT
+            );
+        } else {
+            this->stackTable.allocate(variable, 8);
+        }
     }
 
-    const std::string storeInst = 
-        "\tmovq " + reg->getName() + ", " + std::to_string(offset) + "(%rbp)";
+    const Location location = this->memoryLocation(variable);
+    if (updated || !placed) {
+        this->context.insertText("\t" + 
+            std::string(vector ? "vmovapd " : "movq ") + 
+            reg->getName() + ", " + location.address());
+    }
 
     this->regTable.freeRegister(reg);
-
-    this->addressTable
-        .insert(variable, Location(LT_MEMORY_STACK).setStack(offset));
+    this->addressTable.insert(variable, location);
 }
 
 std::string CodeGenerator::tacToInstruction(const tac_op_t operation) const {
@@ -581,7 +1874,11 @@ std::string CodeGenerator::tacToInstruction(const tac_op_t operation) const {
             return "call";
         case TAC_JMP_E:
             return "je";
-        case TAC_JMP_LE: // jmpl and jmpg are unused on purpose.
+        case TAC_JMP_L:
+            return "jl";
+        case TAC_JMP_G:
+            return "jg";
+        case TAC_JMP_LE:
             return "jle";
         case TAC_JMP_GE:
             return "jge";
@@ -612,36 +1909,147 @@ std::string CodeGenerator::tacToInstruction(const tac_op_t operation) const {
     exit(EXIT_FAILURE);
 }
 
-std::stack<RegPtr> CodeGenerator::pushRegisters() {
-    std::set<RegPtr> toPush = this->regTable.getAllRegistersInUse();
+/**
+ * @param name A name an instruction uses.
+ * @param table The symbol table of the instruction.
+ * @return True if the name is a literal, which can be loaded again.
+ */
+static bool isLiteral(
+    const std::string &name, 
+    const std::shared_ptr<SymbolTable> &table
+) {
+    unsigned int level;
+    st_entry_t entry;
+    return table->lookup(name, &level, &entry) && 
+        entry.entry_type == ST_LITERAL;
+}
+
+std::stack<RegPtr> CodeGenerator::saveRegisters(
+    const tac_line_t &inst,
+    const LivenessTable &liveness,
+    const bool call
+) {
+    const size_t index = this->position - this->blockStart;
+
+    std::vector<RegPtr> pushed;
+    for (const RegPtr &reg : this->regTable.getAllRegistersInUse()) {
+        const std::string variable = this->regTable.getVariableInRegister(reg);
+        const bool calleeSaved = Registers::isCalleeSaved(reg);
+
+        // Values with no name of their own are loaded again when needed.
+        if (!this->addressTable.isInRegister(variable) || 
+            this->addressTable.getRegister(variable) != reg) {
+                if (!calleeSaved) {
+                    this->regTable.freeRegister(reg);
+                }
+                continue;
+            }
+
+        // The frame of the caller is left alone by the call, so only its 
+        // variables in the registers the call may overwrite are stored.
+        if (call && tac_line_t::is_user_defined_var(variable) && 
+            this->isInMemory(variable) && 
+            !(calleeSaved && this->stackTable.inStack(variable))) {
+                this->storeVariable(variable, reg, 
+                    this->isAllocated(variable) ? 
+                        this->intervals->isDefined(variable) :
+                        liveness.isUpdated(variable)
+                );
+                continue;
+            }
+
+        if (calleeSaved) {
+            continue;
+        }
+
+        const bool live = liveness.isLiveAfter(index, variable);
+        if (this->isAllocated(variable)) {
+            if (live) {
+                pushed.push_back(reg);
+            }
+            continue;
+        }
+
+        if (!live || isLiteral(variable, inst.table)) {
+            if (this->isInMemory(variable)) {
+                this->storeVariable(variable, reg, false);
+            } else {
+                this->addressTable.remove(variable);
+                this->regTable.freeRegister(reg);
+                this->addressTable.insertIfLiteral(variable, inst.table);
+            }
+            continue;
+        }
+
+        const RegPtr kept = isVectorRegister(reg) ? nullptr :
+            this->regTable.getUnusedCalleeSavedRegister(GPR);
+        if (kept == nullptr) {
+            pushed.push_back(reg);
+            continue;
+        }
+
+        this->context.insertText(
+            "\tmovq " + reg->getName() + ", " + kept->getName()
+        );
+        Location location = this->addressTable.getLocation(variable);
+        this->addressTable.insert(variable, location.setReg(kept));
+        this->regTable.setRegisterValue(kept, variable);
+        this->regTable.freeRegister(reg);
+    }
+
+    // Vector registers are saved in aligned slots of the frame.
     std::stack<RegPtr> regStack;
-    for (auto i = toPush.begin(); i != toPush.end(); i++) {
-        regStack.push(*i);
-        this->context.insertText("\tpushq " + (*i)->getName());
+    for (const RegPtr &reg : pushed) {
+        if (isVectorRegister(reg)) {
+            this->context.insertText("\tvmovapd " + reg->getName() + 
+                ", " + this->getSaveSlot(reg));
+        } else {
+            this->context.insertText("\tpushq " + reg->getName());
+        }
+        regStack.push(reg);
     }
     return regStack;
 }
 
 void CodeGenerator::popRegisters(std::stack<RegPtr> &toPop) {
     while (!toPop.empty()) {
-        this->context.insertText("\tpopq " + toPop.top()->getName());
+        const RegPtr reg = toPop.top();
         toPop.pop();
+        if (isVectorRegister(reg)) {
+            this->context.insertText("\tvmovapd " + 
+                this->getSaveSlot(reg) + ", " + reg->getName());
+        } else {
+            this->context.insertText("\tpopq " + reg->getName());
+        }
     }
 }
 
 void CodeGenerator::freeRegisters(const LivenessTable &liveness) {
+    this->loadEntryValues();
+
     const auto registerLocations = 
         this->addressTable.getValueAndLocationInRegisters();
+
+    // Allocated variables are still in their registers when the next block 
+    // starts, so they are only stored when leaving the procedure.
+    const bool leaving = 
+        this->intervals != nullptr && this->intervals->isExit(this->block);
     
+    // The frame is gone once the procedure is left.
     for (const std::pair<std::string, Location> &p : registerLocations) {
-        if (this->globalTable.isGlobal(p.first)) {
-            this->storeVariableInGlobalMemory(
-                p.first, p.second.getRegister(), liveness.isUpdated(p.first)
-            );
-        } 
-        else if (this->stackTable.inStack(p.first)) {
-            this->storeVariableInStack(
-                p.first, p.second.getRegister(), liveness.isUpdated(p.first)
+        if (this->isAllocated(p.first)) {
+            if (this->isInMemory(p.first)) {
+                this->storeVariable(
+                    p.first, p.second.getRegister(), 
+                    leaving && !this->stackTable.inStack(p.first) && 
+                        this->intervals->isDefined(p.first)
+                );
+            }
+        }
+        else if (this->isInMemory(p.first)) {
+            this->storeVariable(
+                p.first, p.second.getRegister(), 
+                liveness.isUpdated(p.first) && liveness.isLiveOut(p.first)
             );
         }
     }
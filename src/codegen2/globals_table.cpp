@@ -5,6 +5,15 @@ GlobalAttributes::GlobalAttributes() {}
 GlobalAttributes::GlobalAttributes(const unsigned int sizeBytes) 
 : sizeBytes(sizeBytes) {}
 
+GlobalAttributes::GlobalAttributes(
+    const unsigned int sizeBytes, 
+    const std::string &label
+) : sizeBytes(sizeBytes), label(label) {}
+
+const std::string &GlobalAttributes::getLabel() const {
+    return this->label;
+}
+
 GlobalTable::GlobalTable() {}
 
 void GlobalTable::insertGlobalVariable(
@@ -14,6 +23,14 @@ void GlobalTable::insertGlobalVariable(
     this->table[name] = GlobalAttributes(size);
 }
 
+void GlobalTable::insertGlobalVariable(
+    const std::string &name,
+    const unsigned int size,
+    const std::string &label
+) {
+    this->table[name] = GlobalAttributes(size, label);
+}
+
 void GlobalTable::insertGlobalArray(
     const std::string &name, 
     const unsigned int size
@@ -24,3 +41,11 @@ void GlobalTable::insertGlobalArray(
 bool GlobalTable::isGlobal(const std::string &name) const {
     return this->table.count(name) > 0;
 }
+
+std::string GlobalTable::getLabel(const std::string &name) const {
+    const auto found = this->table.find(name);
+    if (found == this->table.end() || found->second.getLabel() == "") {
+        return name;
+    }
+    return found->second.getLabel();
+}
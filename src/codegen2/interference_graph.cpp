@@ -0,0 +1,98 @@
+#include <codegen2/interference_graph.h>
+
+#include <algorithm>
+
+InterferenceGraph::InterferenceGraph(const LiveIntervals &liveness) {
+    const std::vector<std::string> &variables = liveness.getVariables();
+    this->neighbours.resize(variables.size());
+    this->spillCosts.assign(variables.size(), 0);
+
+    for (const BBP &bb : liveness.getBlocks()) {
+        double weight = 1;
+        for (unsigned int d = 0; d < liveness.getLoopDepth(bb); d++) {
+            weight *= 10;
+        }
+
+        // The variables live into the procedure are all loaded on entry.
+        if (liveness.isEntry(bb)) {
+            const BitVector &live = liveness.getLiveInSet(bb);
+            live.forEach([&](size_t a) {
+                live.forEach([&](size_t b) {
+                    this->addEdge(a, b);
+                });
+            });
+        }
+
+        liveness.forEachLivePoint(bb,
+            [&](const tac_line_t &inst, const unsigned int position,
+                const BitVector &live) {
+                    // The globals read after a call are loaded by it.
+                    if (inst.operation == TAC_CALL) {
+                        live.forEach([&](size_t a) {
+                            if (tac_line_t::is_user_defined_var(variables[a])) {
+                                live.forEach([&](size_t b) {
+                                    this->addEdge(a, b);
+                                });
+                            }
+                        });
+                        return;
+                    }
+
+                    std::vector<size_t> uses;
+                    std::vector<size_t> defs;
+                    liveness.forEachVariable(inst, 
+                        [&](const size_t v, const bool write) {
+                            (write ? defs : uses).push_back(v);
+                            this->spillCosts[v] += weight;
+                        });
+
+                    const bool copy = inst.operation == TAC_ASSIGN && 
+                        defs.size() == 1 && uses.size() == 1;
+                    for (const size_t d : defs) {
+                        live.forEach([&](size_t v) {
+                            this->addEdge(d, v);
+                        });
+                        if (!copy) {
+                            for (const size_t u : uses) {
+                                this->addEdge(d, u);
+                            }
+                        }
+                    }
+
+                    if (copy && defs.front() != uses.front()) {
+                        this->moves.push_back(
+                            std::make_pair(defs.front(), uses.front())
+                        );
+                    }
+                });
+    }
+
+    for (std::vector<size_t> &adjacent : this->neighbours) {
+        std::sort(adjacent.begin(), adjacent.end());
+        adjacent.erase(
+            std::unique(adjacent.begin(), adjacent.end()), adjacent.end()
+        );
+    }
+}
+
+const std::vector<size_t> &InterferenceGraph::getNeighbours(
+    const size_t variable
+) const {
+    return this->neighbours.at(variable);
+}
+
+const std::vector<std::pair<size_t, size_t>> &
+InterferenceGraph::getMoves() const {
+    return this->moves;
+}
+
+double InterferenceGraph::getSpillCost(const size_t variable) const {
+    return this->spillCosts.at(variable);
+}
+
+void InterferenceGraph::addEdge(const size_t a, const size_t b) {
+    if (a != b) {
+        this->neighbours[a].push_back(b);
+        this->neighbours[b].push_back(a);
+    }
+}
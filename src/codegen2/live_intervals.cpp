@@ -0,0 +1,564 @@
+#include <codegen2/live_intervals.h>
+
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <assertions.h>
+#include <optimizer/cfg.h>
+#include <optimizer/dominator.h>
+
+/**
+ * Calls an action on each variable that an instruction reads or writes,
+ * with the variables read before the variable written.
+ * @param inst The instruction.
+ * @param addresses The addresses of array elements, which are read by the
+ * stores through them.
+ * @param action The action, given the variable, the type of register that
+ * holds it and whether it is written.
+ */
+static void forEachAccess(
+    const tac_line_t &inst,
+    const std::set<std::string> &addresses,
+    const std::function<void(
+        const std::string &,
+        const register_type_t,
+        const bool
+    )> &action
+) {
+    // Values written out or passed to a procedure are read from registers.
+    if (inst.operation == TAC_WRITE || inst.operation == TAC_PROC_PARAM ||
+        inst.operation == TAC_RETVAL) {
+            action(inst.argument1, GPR, false);
+            return;
+        }
+
+    if (!inst.is_simple()) {
+        return;
+    }
+
+    const bool vector =
+        inst.operation == TAC_VADD || inst.operation == TAC_VSUB;
+
+    if (inst.argument1 != "") {
+        action(inst.argument1,
+            vector || inst.operation == TAC_VASSIGN ? AVX : GPR, false);
+    }
+    if (inst.argument2 != "") {
+        action(inst.argument2, vector ? AVX : GPR, false);
+    }
+
+    // Comparisons only set the flags, whatever their result is named.
+    if (inst.result == "" || inst.operation == TAC_ARRAY_INDEX ||
+        tac_line_t::is_comparision(inst) || addresses.count(inst.result)) {
+            return;
+        }
+
+    // The vector store writes memory through the value it names.
+    action(inst.result, inst.operation >= TAC_VADD ? AVX : GPR,
+        inst.operation != TAC_VSTORE);
+}
+
+/**
+ * @param bb A block.
+ * @return True if the block does nothing but mark the start of a
+ * procedure, which is entered at the label that follows it.
+ */
+static bool onlyEntersProcedure(const BBP bb) {
+    for (const tac_line_t &inst : bb->getInstructions()) {
+        if (inst.operation != TAC_ENTER_PROC) {
+            return false;
+        }
+    }
+    return true;
+}
+
+LiveIntervals::LiveIntervals(
+    const std::vector<BBP> &blocks, 
+    const BBP graphEntry
+) : blocks(blocks) {
+    this->numberInstructions();
+    this->findVariables();
+    this->computeLiveness();
+    this->buildIntervals();
+    this->findLiveAfterCalls();
+    this->findLoops(graphEntry);
+}
+
+const std::vector<live_interval_t> &LiveIntervals::getIntervals() const {
+    return this->intervals;
+}
+
+const live_interval_t &LiveIntervals::getInterval(
+    const std::string &variable
+) const {
+    return this->intervals.at(this->intervalIndices.at(variable));
+}
+
+std::vector<std::string> LiveIntervals::getLiveIn(const BBP block) const {
+    std::vector<std::string> result;
+    this->liveIn.at(this->blockIndices.at(block)).forEach([&](size_t v) {
+        if (this->intervalIndices.count(this->names[v])) {
+            result.push_back(this->names[v]);
+        }
+    });
+    return result;
+}
+
+bool LiveIntervals::isEntry(const BBP block) const {
+    return this->entries.at(this->blockIndices.at(block));
+}
+
+bool LiveIntervals::isExit(const BBP block) const {
+    return this->exits.at(this->blockIndices.at(block));
+}
+
+bool LiveIntervals::isLiveOut(
+    const BBP block, 
+    const std::string &variable
+) const {
+    return this->liveOut.at(this->blockIndices.at(block))
+        .test(this->nameIndices.at(variable));
+}
+
+bool LiveIntervals::isVariable(const std::string &variable) const {
+    return this->nameIndices.count(variable) != 0;
+}
+
+bool LiveIntervals::isDefined(const std::string &variable) const {
+    const auto found = this->nameIndices.find(variable);
+    return found != this->nameIndices.end() &&
+        this->defined.test(found->second);
+}
+
+bool LiveIntervals::isLiveAfterCall(
+    const std::string &variable, 
+    const unsigned int position
+) const {
+    return this->liveAfterCalls.at(position)
+        .test(this->nameIndices.at(variable));
+}
+
+unsigned int LiveIntervals::getLoopDepth(const BBP block) const {
+    return this->loopDepths.at(this->blockIndices.at(block));
+}
+
+const std::vector<BBP> &LiveIntervals::getBlocks() const {
+    return this->blocks;
+}
+
+const std::vector<std::string> &LiveIntervals::getVariables() const {
+    return this->names;
+}
+
+const BitVector &LiveIntervals::getLiveInSet(const BBP block) const {
+    return this->liveIn.at(this->blockIndices.at(block));
+}
+
+void LiveIntervals::forEachVariable(
+    const tac_line_t &inst,
+    const std::function<void(const size_t, const bool)> &action
+) const {
+    forEachAccess(inst, this->addresses,
+        [&](const std::string &name, const register_type_t type,
+            const bool write) {
+                const auto found = this->nameIndices.find(name);
+                if (found != this->nameIndices.end()) {
+                    action(found->second, write);
+                }
+            });
+}
+
+void LiveIntervals::forEachLivePoint(
+    const BBP block,
+    const std::function<void(
+        const tac_line_t &, 
+        const unsigned int, 
+        const BitVector &
+    )> &action
+) const {
+    const size_t b = this->blockIndices.at(block);
+    const std::vector<tac_line_t> &instructions = block->getInstructions();
+
+    BitVector read = this->globals;
+    read.intersectWith(this->defined);
+
+    BitVector live = this->liveOut[b];
+    unsigned int position = this->lastPositions[b];
+    for (auto i = instructions.rbegin(); i != instructions.rend(); i++) {
+        action(*i, position--, live);
+
+        // The same transfer as the blocks are given in computeLiveness.
+        if (i->operation == TAC_CALL) {
+            live.subtract(this->globals);
+            live.unionWith(read);
+            continue;
+        }
+
+        std::vector<size_t> uses;
+        this->forEachVariable(*i, [&](const size_t v, const bool write) {
+            if (write) {
+                live.reset(v);
+            } else {
+                uses.push_back(v);
+            }
+        });
+        for (const size_t v : uses) {
+            live.set(v);
+        }
+    }
+}
+
+unsigned int LiveIntervals::getFirstPosition(const BBP block) const {
+    return this->firstPositions.at(this->blockIndices.at(block));
+}
+
+unsigned int LiveIntervals::getLastPosition(const BBP block) const {
+    return this->lastPositions.at(this->blockIndices.at(block));
+}
+
+void LiveIntervals::numberInstructions() {
+    unsigned int position = 0;
+    for (size_t b = 0; b < this->blocks.size(); b++) {
+        const BBP bb = this->blocks[b];
+        ASSERT(!bb->getInstructions().empty());
+
+        this->blockIndices[bb] = b;
+        this->firstPositions.push_back(position);
+        for (const tac_line_t &inst : bb->getInstructions()) {
+            if (inst.operation == TAC_CALL) {
+                this->callPositions.push_back(position);
+            } else if (inst.operation == TAC_ARRAY_INDEX) {
+                this->addresses.insert(inst.result);
+            }
+            position++;
+        }
+        this->lastPositions.push_back(position - 1);
+    }
+
+    for (const BBP &bb : this->blocks) {
+        bool fromOutside = false;
+        bool fromInside = false;
+        for (const BBP &predecessor : bb->getPredecessors()) {
+            if (!this->blockIndices.count(predecessor)) {
+                fromOutside = true;
+            } else if (!onlyEntersProcedure(predecessor)) {
+                fromInside = true;
+            }
+        }
+
+        bool toOutside = bb->getHasExitProcedure();
+        bool toInside = false;
+        for (const BBP &successor : bb->getSuccessors()) {
+            if (this->blockIndices.count(successor)) {
+                toInside = true;
+            } else {
+                toOutside = true;
+            }
+        }
+
+        const bool entry =
+            !onlyEntersProcedure(bb) && (fromOutside || !fromInside);
+        this->entries.push_back(entry);
+        this->reentered.push_back(entry && fromInside);
+        this->exits.push_back(toOutside || !toInside);
+    }
+}
+
+bool LiveIntervals::isCandidate(
+    const tac_line_t &inst,
+    const std::string &name
+) {
+    if (name == "" || this->addresses.count(name)) {
+        return false;
+    }
+
+    const auto found = this->candidates.find(name);
+    if (found != this->candidates.end()) {
+        return found->second;
+    }
+
+    unsigned int level;
+    st_entry_t entry;
+    bool candidate;
+    if (inst.table->lookup(name, &level, &entry)) {
+        candidate = entry.entry_type == ST_VARIABLE &&
+            !entry.variable.isArray && !entry.variable.isConstant;
+    } else {
+        // Temporaries are not in the symbol table.
+        candidate = !tac_line_t::is_user_defined_var(name);
+    }
+
+    this->candidates.emplace(name, candidate);
+    return candidate;
+}
+
+/**
+ * @param blocks The blocks of a procedure in the order of the code.
+ * @return The variables kept in the frame of the procedure, which are its 
+ * parameters, its return value and the variables it declares. The code 
+ * between the procedures has none, since it declares the globals.
+ */
+static std::set<std::string> findLocals(const std::vector<BBP> &blocks) {
+    std::set<std::string> locals;
+    if (blocks.empty() || !blocks.front()->getHasEnterProcedure()) {
+        return locals;
+    }
+
+    for (const BBP &bb : blocks) {
+        for (const tac_line_t &inst : bb->getInstructions()) {
+            if (inst.operation == TAC_ASSIGN && inst.result != "" && 
+                inst.argument1 == "") {
+                    locals.insert(inst.result);
+                    continue;
+                }
+            if (inst.operation != TAC_ENTER_PROC) {
+                continue;
+            }
+
+            unsigned int level;
+            st_entry_t entry;
+            const bool success = 
+                inst.table->lookup(inst.argument1, &level, &entry);
+            ASSERT(success);
+            for (uint8_t i = 0; i < entry.procedure.argumentsLength; i++) {
+                locals.insert(entry.procedure.argumentNames[i]);
+            }
+            if (entry.procedure.returnType != VOID) {
+                locals.insert(entry.procedure.returnTypeName);
+            }
+        }
+    }
+    return locals;
+}
+
+void LiveIntervals::findVariables() {
+    const std::set<std::string> locals = findLocals(this->blocks);
+
+    std::map<std::string, register_type_t> found;
+    std::set<std::string> written;
+    // The vectorizer may name a vector and a scalar the same.
+    std::set<std::string> mixed;
+    for (const BBP &bb : this->blocks) {
+        for (const tac_line_t &inst : bb->getInstructions()) {
+            forEachAccess(inst, this->addresses,
+                [&](const std::string &name, const register_type_t type,
+                    const bool write) {
+                        if (!this->isCandidate(inst, name)) {
+                            return;
+                        }
+                        const auto previous = found.find(name);
+                        if (previous == found.end()) {
+                            found[name] = type;
+                        } else if (previous->second != type) {
+                            mixed.insert(name);
+                        }
+                        if (write) {
+                            written.insert(name);
+                        }
+                    });
+        }
+    }
+
+    for (const std::string &name : mixed) {
+        found.erase(name);
+    }
+
+    this->userVariables = BitVector(found.size());
+    this->globals = BitVector(found.size());
+    this->defined = BitVector(found.size());
+    for (const auto &p : found) {
+        const size_t index = this->names.size();
+        this->names.push_back(p.first);
+        this->types.push_back(p.second);
+        this->nameIndices[p.first] = index;
+        if (tac_line_t::is_user_defined_var(p.first)) {
+            this->userVariables.set(index);
+            if (!locals.count(p.first)) {
+                this->globals.set(index);
+            }
+        }
+        if (written.count(p.first)) {
+            this->defined.set(index);
+        }
+    }
+}
+
+void LiveIntervals::computeLiveness() {
+    const size_t count = this->names.size();
+    const size_t blockCount = this->blocks.size();
+
+    std::vector<BitVector> uses(blockCount, BitVector(count));
+    std::vector<BitVector> defs(blockCount, BitVector(count));
+    for (size_t b = 0; b < blockCount; b++) {
+        for (const tac_line_t &inst : this->blocks[b]->getInstructions()) {
+            // The called procedure reads the globals written here from 
+            // memory, and may write any global.
+            if (inst.operation == TAC_CALL) {
+                BitVector read = this->globals;
+                read.intersectWith(this->defined);
+                read.subtract(defs[b]);
+                uses[b].unionWith(read);
+                defs[b].unionWith(this->globals);
+                continue;
+            }
+
+            this->forEachVariable(inst, [&](const size_t v, const bool write) {
+                if (write) {
+                    defs[b].set(v);
+                } else if (!defs[b].test(v)) {
+                    uses[b].set(v);
+                }
+            });
+        }
+    }
+
+    // The globals written by the procedure are read once it returns, but 
+    // nothing is read once the program ends.
+    BitVector written = this->globals;
+    written.intersectWith(this->defined);
+    std::vector<bool> returns(blockCount);
+    for (size_t b = 0; b < blockCount; b++) {
+        const BBP bb = this->blocks[b];
+        returns[b] = this->exits[b] && 
+            (bb->getHasExitProcedure() || !bb->getSuccessors().empty());
+    }
+
+    this->liveIn.assign(blockCount, BitVector(count));
+    this->liveOut.assign(blockCount, BitVector(count));
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t b = blockCount; b-- > 0;) {
+            BitVector out = returns[b] ? written : BitVector(count);
+            for (const BBP &successor : this->blocks[b]->getSuccessors()) {
+                const auto found = this->blockIndices.find(successor);
+                if (found != this->blockIndices.end()) {
+                    out.unionWith(this->liveIn[found->second]);
+                }
+            }
+
+            BitVector in = out;
+            in.subtract(defs[b]);
+            in.unionWith(uses[b]);
+
+            if (out != this->liveOut[b] || in != this->liveIn[b]) {
+                this->liveOut[b] = out;
+                this->liveIn[b] = in;
+                changed = true;
+            }
+        }
+    }
+}
+
+void LiveIntervals::buildIntervals() {
+    const size_t count = this->names.size();
+
+    std::vector<unsigned int> starts(count, UINT_MAX);
+    std::vector<unsigned int> ends(count, 0);
+    const auto extend = [&](const size_t v, const unsigned int position) {
+        starts[v] = std::min(starts[v], position);
+        ends[v] = std::max(ends[v], position);
+    };
+
+    // Values loaded on entry are only correct if nothing else flows in.
+    BitVector excluded(count);
+    BitVector temporaries(count, true);
+    temporaries.subtract(this->userVariables);
+
+    for (size_t b = 0; b < this->blocks.size(); b++) {
+        unsigned int position = this->firstPositions[b];
+        for (const tac_line_t &inst : this->blocks[b]->getInstructions()) {
+            this->forEachVariable(inst, [&](const size_t v, const bool write) {
+                extend(v, position);
+            });
+            position++;
+        }
+
+        this->liveIn[b].forEach([&](size_t v) {
+            extend(v, this->firstPositions[b]);
+        });
+        this->liveOut[b].forEach([&](size_t v) {
+            extend(v, this->lastPositions[b]);
+        });
+
+        if (this->reentered[b]) {
+            excluded.unionWith(this->liveIn[b]);
+        } else if (this->entries[b]) {
+            BitVector undefined = this->liveIn[b];
+            undefined.intersectWith(temporaries);
+            excluded.unionWith(undefined);
+        }
+    }
+
+    for (size_t v = 0; v < count; v++) {
+        if (starts[v] == UINT_MAX || excluded.test(v)) {
+            continue;
+        }
+
+        bool crossesCall = false;
+        for (const unsigned int call : this->callPositions) {
+            crossesCall |= starts[v] < call && call < ends[v];
+        }
+
+        this->intervalIndices[this->names[v]] = this->intervals.size();
+        this->intervals.push_back({
+            this->names[v], this->types[v], starts[v], ends[v], crossesCall
+        });
+    }
+}
+
+void LiveIntervals::findLiveAfterCalls() {
+    for (size_t b = 0; b < this->blocks.size(); b++) {
+        this->forEachLivePoint(this->blocks[b],
+            [&](const tac_line_t &inst, const unsigned int position,
+                const BitVector &live) {
+                    if (inst.operation == TAC_CALL) {
+                        this->liveAfterCalls.emplace(position, live);
+                    }
+                });
+    }
+}
+
+void LiveIntervals::findLoops(const BBP graphEntry) {
+    this->loopDepths.assign(this->blocks.size(), 0);
+
+    CFG cfg("", graphEntry);
+    const Dominator dominator(&cfg);
+
+    // The blocks of each natural loop, where the loops that share a header 
+    // are counted as one.
+    std::map<BBP, std::set<size_t>> bodies;
+    for (const auto &edge : cfg.computeBackwardsEdges()) {
+        const BBP footer = edge.first;
+        const BBP header = edge.second;
+        if (!this->blockIndices.count(header) || 
+            !this->blockIndices.count(footer) ||
+            !dominator.dominates(header, footer)) {
+                continue;
+            }
+
+        // As in NaturalLoop::forEachBBInBody, the search backwards from the 
+        // footer stops at the header.
+        std::set<size_t> &body = bodies[header];
+        body.insert(this->blockIndices.at(header));
+        std::vector<BBP> stack = { footer };
+        while (!stack.empty()) {
+            const BBP current = stack.back();
+            stack.pop_back();
+            const auto found = this->blockIndices.find(current);
+            if (current == header || found == this->blockIndices.end() ||
+                !body.insert(found->second).second) {
+                    continue;
+                }
+            const std::vector<BBP> &preds = current->getPredecessors();
+            stack.insert(stack.end(), preds.rbegin(), preds.rend());
+        }
+    }
+
+    for (const auto &p : bodies) {
+        for (const size_t b : p.second) {
+            this->loopDepths[b]++;
+        }
+    }
+}
@@ -1,36 +1,51 @@
 #include <codegen2/liveness.h>
 
+#include <algorithm>
+#include <set>
+#include <codegen2/live_intervals.h>
+
 LivenessMap::LivenessMap() {}
 
-bool LivenessMap::isLive(const std::string &name) const {
+bool LivenessMap::isLive(const Symbol &name) const {
     return this->entries.at(name).isLive();
 }
 
-bool LivenessMap::hasNextUse(const std::string &name) const {
+bool LivenessMap::hasNextUse(const Symbol &name) const {
     return this->entries.at(name).getNextUse() != NEVER_USED;
 }
 
-STID LivenessMap::getNextUse(const std::string &name) const {
+STID LivenessMap::getNextUse(const Symbol &name) const {
     return this->entries.at(name).getNextUse();
 }
 
-Liveness &LivenessMap::getEntry(const std::string &name) {
+Liveness &LivenessMap::getEntry(const Symbol &name) {
     return this->entries.at(name);
 }
 
-void LivenessMap::putEntry(const std::string &name, const Liveness &liveness) {
-    this->entries.insert(std::make_pair(name, liveness));
+void LivenessMap::putEntry(const Symbol &name, const Liveness &liveness) {
+    this->entries.insert(name, liveness);
 }
 
 std::string LivenessMap::to_string() const {
     std::string result = "";
     for (auto p : this->entries) {
-        result += p.first + p.second.to_string() + " ";
+        result += Interner::lookup(p.first) + p.second.to_string() + " ";
     }
     return result;
 }
 
-LivenessTable::LivenessTable(const BBP bb) : block(bb) {
+/**
+ * @param inst An instruction.
+ * @return True if the instruction passes a value to or from a procedure.
+ */
+static bool isPassed(const tac_line_t &inst) {
+    return inst.operation == TAC_PROC_PARAM || inst.operation == TAC_RETVAL;
+}
+
+LivenessTable::LivenessTable(
+    const BBP bb, 
+    const LiveIntervals &intervals
+) : block(bb), intervals(intervals) {
     this->computeLiveness(bb);
 }
 
@@ -38,54 +53,144 @@ const LivenessMap& LivenessTable::getLivenessAndNextUse(const STID tid) const {
     return this->table.at(tid);
 }
 
-bool LivenessTable::isUpdated(const std::string &variable) const {
+bool LivenessTable::isUpdated(const Symbol &variable) const {
     return !this->block->isNeverDefined(variable);
 }
 
+bool LivenessTable::isLiveOut(const Symbol &variable) const {
+    return this->getLivenessForVariable(variable).isLive();
+}
+
+STID LivenessTable::getNextRead(
+    const size_t index, 
+    const Symbol &variable
+) const {
+    if (!this->accesses.count(variable)) {
+        return NEVER_USED;
+    }
+
+    const std::vector<std::pair<size_t, bool>> &positions = 
+        this->accesses.at(variable);
+    const auto next = std::lower_bound(positions.begin(), positions.end(), 
+        std::make_pair(index, false));
+    if (next == positions.end() || next->second) {
+        return NEVER_USED;
+    }
+    return next->first;
+}
+
+bool LivenessTable::isLiveAfter(
+    const size_t index, 
+    const Symbol &variable
+) const {
+    if (this->accesses.count(variable)) {
+        const std::vector<std::pair<size_t, bool>> &positions = 
+            this->accesses.at(variable);
+        const auto next = std::lower_bound(positions.begin(), 
+            positions.end(), std::make_pair(index + 1, false));
+        if (next != positions.end()) {
+            return !next->second;
+        }
+    }
+    return this->isLiveOut(variable);
+}
+
 void LivenessTable::computeLiveness(const BBP bb) {
-    std::map<std::string, Liveness> table;
+    SymbolMap<Liveness> table;
 
     this->defaultTable(table, bb);
 
     const std::vector<tac_line_t> &instructions = bb->getInstructions();
+
+    // A store through the address of an array element reads the address.
+    std::set<std::string> addresses;
+    for (const tac_line_t &inst : instructions) {
+        if (inst.operation == TAC_ARRAY_INDEX) {
+            addresses.insert(inst.result);
+        }
+    }
+
     for (auto i = instructions.rbegin(); i != instructions.rend(); i++) {
         if ((*i).is_simple()) {
             const tac_line_t &inst = *i;
             this->attachLivenessAndNextUse(table, inst.bid, inst.result);
             this->attachLivenessAndNextUse(table, inst.bid, inst.argument1);
             this->attachLivenessAndNextUse(table, inst.bid, inst.argument2);
-            this->updateResult(inst.bid, table, inst.result);
+            if (inst.operation == TAC_ASSIGN && addresses.count(inst.result)) {
+                this->updateOperand(inst.bid, table, inst.result);
+            } else {
+                this->updateResult(inst.bid, table, inst.result);
+            }
             this->updateOperand(inst.bid, table, inst.argument1);
             this->updateOperand(inst.bid, table, inst.argument2);
+        } else if (isPassed(*i)) {
+            this->attachLivenessAndNextUse(table, i->bid, i->argument1);
+            this->updateOperand(i->bid, table, i->argument1);
         }
     }
+
+    for (size_t index = 0; index < instructions.size(); index++) {
+        const tac_line_t &inst = instructions[index];
+        if (inst.operation == TAC_WRITE || isPassed(inst)) {
+            this->recordAccess(index, inst.argument1, false);
+        }
+        if (!inst.is_simple()) {
+            continue;
+        }
+
+        this->recordAccess(index, inst.argument1, false);
+        this->recordAccess(index, inst.argument2, false);
+
+        // Comparisons only set the flags, and the stores through an 
+        // address read the address.
+        if (tac_line_t::is_comparision(inst)) {
+            continue;
+        }
+        const bool store = inst.operation == TAC_VSTORE || 
+            (inst.operation == TAC_ASSIGN && addresses.count(inst.result));
+        this->recordAccess(index, inst.result, !store);
+    }
+}
+
+void LivenessTable::recordAccess(
+    const size_t index, 
+    const Symbol &variable, 
+    const bool write
+) {
+    if (variable != "") {
+        this->accesses[variable].push_back(std::make_pair(index, write));
+    }
 }
 
 void LivenessTable::defaultTable(
-    std::map<std::string, Liveness> &table, const BBP bb
+    SymbolMap<Liveness> &table, const BBP bb
 ) const {
     for (const tac_line_t &inst : bb->getInstructions()) {
         if (inst.is_simple()) {
             this->tryInsertTableEntry(table, inst.result);
             this->tryInsertTableEntry(table, inst.argument1);
             this->tryInsertTableEntry(table, inst.argument2);
+        } else if (isPassed(inst)) {
+            this->tryInsertTableEntry(table, inst.argument1);
         }
     }
 }
 
 void LivenessTable::tryInsertTableEntry(
-    std::map<std::string, Liveness> &table, 
-    const std::string variable
+    SymbolMap<Liveness> &table, 
+    const Symbol &variable
 ) const {
     if (variable != "") {
-        table.insert(std::make_pair(
-            variable,
-            this->getLivenessForVariable(variable)
-        ));
+        table.insert(variable, this->getLivenessForVariable(variable));
     }
 }
 
-Liveness LivenessTable::getLivenessForVariable(const std::string &name) const {
+Liveness LivenessTable::getLivenessForVariable(const Symbol &name) const {
+    if (this->intervals.isVariable(name)) {
+        return Liveness(
+            this->intervals.isLiveOut(this->block, name), NEVER_USED
+        );
+    }
     if (tac_line_t::is_user_defined_var(name)) {
         return this->getUserVarDefaultLiveness(name);
     }
@@ -93,21 +198,21 @@ Liveness LivenessTable::getLivenessForVariable(const std::string &name) const {
 }
 
 Liveness LivenessTable::getUserVarDefaultLiveness(
-    const std::string &name
+    const Symbol &name
 ) const {
     return Liveness(true, NEVER_USED);
 }
 
 Liveness LivenessTable::getTempVarDefaultLiveness(
-    const std::string &name
+    const Symbol &name
 ) const {
     return Liveness(false, NEVER_USED);
 }
 
 void LivenessTable::attachLivenessAndNextUse(
-    std::map<std::string, Liveness> &table, 
+    SymbolMap<Liveness> &table, 
     const STID &tid, 
-    const std::string &variable
+    const Symbol &variable
 ) {
     if (variable != "") {
         this->insert(tid, variable, table.at(variable));
@@ -116,7 +221,7 @@ void LivenessTable::attachLivenessAndNextUse(
 
 void LivenessTable::insert(
     const STID &tid, 
-    const std::string &variable, 
+    const Symbol &variable, 
     const Liveness &liveness
 ) {
     if (!this->table.count(tid)) {
@@ -128,8 +233,8 @@ void LivenessTable::insert(
 
 void LivenessTable::updateOperand(
     const STID &tid,
-    std::map<std::string, Liveness> &table, 
-    const std::string &variable
+    SymbolMap<Liveness> &table, 
+    const Symbol &variable
 ) const {
     if (variable != "") {
         table.at(variable).setLive(true);
@@ -139,8 +244,8 @@ void LivenessTable::updateOperand(
 
 void LivenessTable::updateResult(
     const STID &tid,
-    std::map<std::string, Liveness> &table, 
-    const std::string &variable
+    SymbolMap<Liveness> &table, 
+    const Symbol &variable
 ) const {
     if (variable != "") {
         table.at(variable).setLive(false);
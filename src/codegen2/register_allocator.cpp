@@ -0,0 +1,442 @@
+#include <codegen2/register_allocator.h>
+
+#include <algorithm>
+#include <cstdint>
+
+RegisterAllocator::~RegisterAllocator() {}
+
+std::map<std::string, RegPtr> LinearScanAllocator::allocate(
+    const LiveIntervals &liveness,
+    const std::vector<live_interval_t> &intervals
+) {
+    std::map<std::string, RegPtr> allocation;
+    this->allocateType(intervals, GPR, allocation);
+    this->allocateType(intervals, AVX, allocation);
+    return allocation;
+}
+
+void LinearScanAllocator::allocateType(
+    const std::vector<live_interval_t> &intervals,
+    const register_type_t type,
+    std::map<std::string, RegPtr> &allocation
+) const {
+    std::vector<const live_interval_t *> unhandled;
+    for (const live_interval_t &interval : intervals) {
+        if (interval.type == type) {
+            unhandled.push_back(&interval);
+        }
+    }
+
+    std::sort(unhandled.begin(), unhandled.end(),
+        [](const live_interval_t *a, const live_interval_t *b) {
+            if (a->start != b->start) {
+                return a->start < b->start;
+            }
+            return a->variable < b->variable;
+        });
+
+    const std::vector<RegPtr> registers =
+        Registers::getAllocatableRegisters(type);
+    std::vector<bool> taken(registers.size(), false);
+
+    // The intervals holding a register, with the index of the register.
+    std::vector<std::pair<const live_interval_t *, size_t>> active;
+
+    for (const live_interval_t *interval : unhandled) {
+        // Intervals include their ends, so one that ends where this one
+        // starts still holds its register.
+        for (auto i = active.begin(); i != active.end();) {
+            if (i->first->end < interval->start) {
+                taken[i->second] = false;
+                i = active.erase(i);
+            } else {
+                i++;
+            }
+        }
+
+        const auto unused = std::find(taken.begin(), taken.end(), false);
+        if (unused != taken.end()) {
+            const size_t index = unused - taken.begin();
+            taken[index] = true;
+            active.push_back(std::make_pair(interval, index));
+            allocation[interval->variable] = registers[index];
+            continue;
+        }
+
+        if (active.empty()) {
+            continue;
+        }
+
+        auto spill = active.begin();
+        for (auto i = active.begin(); i != active.end(); i++) {
+            if (i->first->end > spill->first->end) {
+                spill = i;
+            }
+        }
+
+        if (spill->first->end > interval->end) {
+            allocation.erase(spill->first->variable);
+            allocation[interval->variable] = registers[spill->second];
+            spill->first = interval;
+        }
+    }
+}
+
+std::map<std::string, RegPtr> GraphColoringAllocator::allocate(
+    const LiveIntervals &liveness,
+    const std::vector<live_interval_t> &intervals
+) {
+    const InterferenceGraph graph(liveness);
+    std::map<std::string, RegPtr> allocation;
+    this->allocateType(liveness, graph, intervals, GPR, allocation);
+    this->allocateType(liveness, graph, intervals, AVX, allocation);
+    return allocation;
+}
+
+void GraphColoringAllocator::allocateType(
+    const LiveIntervals &liveness,
+    const InterferenceGraph &graph,
+    const std::vector<live_interval_t> &intervals,
+    const register_type_t type,
+    std::map<std::string, RegPtr> &allocation
+) {
+    // The variables are ordered by name, as are the intervals.
+    const std::vector<std::string> &names = liveness.getVariables();
+    std::vector<size_t> variables;
+    for (const live_interval_t &interval : intervals) {
+        if (interval.type == type) {
+            variables.push_back(
+                std::lower_bound(names.begin(), names.end(), 
+                    interval.variable) - names.begin()
+            );
+        }
+    }
+
+    const std::vector<RegPtr> registers = 
+        Registers::getAllocatableRegisters(type);
+    this->colors = registers.size();
+
+    this->build(liveness, graph, variables);
+    this->makeWorklist();
+    while (!this->simplifyWorklist.empty() || 
+        !this->worklistMoves.empty() || 
+        !this->freezeWorklist.empty() || 
+        !this->spillWorklist.empty()) {
+            if (!this->simplifyWorklist.empty()) {
+                this->simplify();
+            } else if (!this->worklistMoves.empty()) {
+                this->coalesce();
+            } else if (!this->freezeWorklist.empty()) {
+                this->freeze();
+            } else {
+                this->selectSpill();
+            }
+        }
+
+    const std::vector<int> assigned = this->assignColors();
+    for (size_t n = 0; n < variables.size(); n++) {
+        if (assigned[n] >= 0) {
+            allocation[names[variables[n]]] = registers[assigned[n]];
+        }
+    }
+}
+
+void GraphColoringAllocator::build(
+    const LiveIntervals &liveness,
+    const InterferenceGraph &graph,
+    const std::vector<size_t> &variables
+) {
+    const size_t count = variables.size();
+
+    // The nodes are numbered in the order of the variables given.
+    std::vector<size_t> nodes(liveness.getVariables().size(), SIZE_MAX);
+    for (size_t n = 0; n < count; n++) {
+        nodes[variables[n]] = n;
+    }
+
+    this->adjacency.assign(count, std::set<size_t>());
+    this->degrees.assign(count, 0);
+    this->costs.assign(count, 0);
+    this->aliases.assign(count, 0);
+    this->nodeStates.assign(count, NODE_SIMPLIFY);
+    this->simplifyWorklist.clear();
+    this->freezeWorklist.clear();
+    this->spillWorklist.clear();
+    this->selectStack.clear();
+    this->moves.clear();
+    this->moveStates.clear();
+    this->moveLists.assign(count, std::vector<size_t>());
+    this->worklistMoves.clear();
+
+    for (size_t n = 0; n < count; n++) {
+        this->aliases[n] = n;
+        this->costs[n] = graph.getSpillCost(variables[n]);
+        for (const size_t neighbour : graph.getNeighbours(variables[n])) {
+            if (nodes[neighbour] != SIZE_MAX) {
+                this->addEdge(n, nodes[neighbour]);
+            }
+        }
+    }
+
+    for (const auto &move : graph.getMoves()) {
+        const size_t a = nodes[move.first];
+        const size_t b = nodes[move.second];
+        if (a == SIZE_MAX || b == SIZE_MAX) {
+            continue;
+        }
+
+        const size_t index = this->moves.size();
+        this->moves.push_back(std::make_pair(a, b));
+        this->moveStates.push_back(MOVE_WORKLIST);
+        this->moveLists[a].push_back(index);
+        this->moveLists[b].push_back(index);
+        this->worklistMoves.insert(index);
+    }
+}
+
+void GraphColoringAllocator::makeWorklist() {
+    for (size_t n = 0; n < this->nodeStates.size(); n++) {
+        if (this->degrees[n] >= this->colors) {
+            this->setNodeState(n, NODE_SPILL);
+        } else if (this->isMoveRelated(n)) {
+            this->setNodeState(n, NODE_FREEZE);
+        } else {
+            this->setNodeState(n, NODE_SIMPLIFY);
+        }
+    }
+}
+
+void GraphColoringAllocator::simplify() {
+    const size_t n = *this->simplifyWorklist.begin();
+    this->setNodeState(n, NODE_SELECTED);
+    this->selectStack.push_back(n);
+    for (const size_t m : this->adjacent(n)) {
+        this->decrementDegree(m);
+    }
+}
+
+void GraphColoringAllocator::coalesce() {
+    const size_t m = *this->worklistMoves.begin();
+    this->worklistMoves.erase(m);
+
+    const size_t u = this->getAlias(this->moves[m].first);
+    const size_t v = this->getAlias(this->moves[m].second);
+
+    if (u == v) {
+        this->moveStates[m] = MOVE_COALESCED;
+        this->addWorklist(u);
+    } else if (this->adjacency[u].count(v)) {
+        this->moveStates[m] = MOVE_CONSTRAINED;
+        this->addWorklist(u);
+        this->addWorklist(v);
+    } else {
+        // Briggs' test: the combined node is colorable if it has fewer 
+        // neighbours of significant degree than there are colors.
+        std::vector<size_t> nodes = this->adjacent(u);
+        const std::vector<size_t> others = this->adjacent(v);
+        nodes.insert(nodes.end(), others.begin(), others.end());
+        std::sort(nodes.begin(), nodes.end());
+        nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+
+        if (this->isConservative(nodes)) {
+            this->moveStates[m] = MOVE_COALESCED;
+            this->combine(u, v);
+            this->addWorklist(u);
+        } else {
+            this->moveStates[m] = MOVE_ACTIVE;
+        }
+    }
+}
+
+void GraphColoringAllocator::freeze() {
+    const size_t u = *this->freezeWorklist.begin();
+    this->setNodeState(u, NODE_SIMPLIFY);
+    this->freezeMoves(u);
+}
+
+void GraphColoringAllocator::selectSpill() {
+    auto chosen = this->spillWorklist.begin();
+    for (auto i = this->spillWorklist.begin(); 
+        i != this->spillWorklist.end(); i++) {
+            if (this->costs[*i] / this->degrees[*i] < 
+                this->costs[*chosen] / this->degrees[*chosen]) {
+                    chosen = i;
+                }
+        }
+
+    const size_t m = *chosen;
+    this->setNodeState(m, NODE_SIMPLIFY);
+    this->freezeMoves(m);
+}
+
+std::vector<int> GraphColoringAllocator::assignColors() const {
+    std::vector<int> assigned(this->nodeStates.size(), -1);
+
+    for (auto n = this->selectStack.rbegin(); 
+        n != this->selectStack.rend(); n++) {
+            std::vector<bool> used(this->colors, false);
+            for (const size_t w : this->adjacency[*n]) {
+                const int color = assigned[this->getAlias(w)];
+                if (color >= 0) {
+                    used[color] = true;
+                }
+            }
+
+            // Nodes that cannot be colored stay in memory.
+            const auto unused = std::find(used.begin(), used.end(), false);
+            if (unused != used.end()) {
+                assigned[*n] = unused - used.begin();
+            }
+        }
+
+    for (size_t n = 0; n < this->nodeStates.size(); n++) {
+        if (this->nodeStates[n] == NODE_COALESCED) {
+            assigned[n] = assigned[this->getAlias(n)];
+        }
+    }
+    return assigned;
+}
+
+std::vector<size_t> GraphColoringAllocator::adjacent(const size_t node) const {
+    std::vector<size_t> result;
+    for (const size_t n : this->adjacency[node]) {
+        if (this->nodeStates[n] != NODE_SELECTED && 
+            this->nodeStates[n] != NODE_COALESCED) {
+                result.push_back(n);
+            }
+    }
+    return result;
+}
+
+std::vector<size_t> GraphColoringAllocator::nodeMoves(
+    const size_t node
+) const {
+    std::vector<size_t> result;
+    for (const size_t m : this->moveLists[node]) {
+        if (this->moveStates[m] == MOVE_WORKLIST || 
+            this->moveStates[m] == MOVE_ACTIVE) {
+                result.push_back(m);
+            }
+    }
+    return result;
+}
+
+bool GraphColoringAllocator::isMoveRelated(const size_t node) const {
+    return !this->nodeMoves(node).empty();
+}
+
+void GraphColoringAllocator::addEdge(const size_t a, const size_t b) {
+    if (a != b && !this->adjacency[a].count(b)) {
+        this->adjacency[a].insert(b);
+        this->adjacency[b].insert(a);
+        this->degrees[a]++;
+        this->degrees[b]++;
+    }
+}
+
+void GraphColoringAllocator::decrementDegree(const size_t node) {
+    const size_t degree = this->degrees[node]--;
+    if (degree != this->colors) {
+        return;
+    }
+
+    this->enableMoves(node);
+    for (const size_t n : this->adjacent(node)) {
+        this->enableMoves(n);
+    }
+
+    if (this->isMoveRelated(node)) {
+        this->setNodeState(node, NODE_FREEZE);
+    } else {
+        this->setNodeState(node, NODE_SIMPLIFY);
+    }
+}
+
+void GraphColoringAllocator::enableMoves(const size_t node) {
+    for (const size_t m : this->nodeMoves(node)) {
+        if (this->moveStates[m] == MOVE_ACTIVE) {
+            this->moveStates[m] = MOVE_WORKLIST;
+            this->worklistMoves.insert(m);
+        }
+    }
+}
+
+void GraphColoringAllocator::addWorklist(const size_t node) {
+    if (this->nodeStates[node] == NODE_FREEZE && 
+        !this->isMoveRelated(node) && this->degrees[node] < this->colors) {
+            this->setNodeState(node, NODE_SIMPLIFY);
+        }
+}
+
+bool GraphColoringAllocator::isConservative(
+    const std::vector<size_t> &nodes
+) const {
+    size_t significant = 0;
+    for (const size_t n : nodes) {
+        if (this->degrees[n] >= this->colors) {
+            significant++;
+        }
+    }
+    return significant < this->colors;
+}
+
+size_t GraphColoringAllocator::getAlias(const size_t node) const {
+    size_t alias = node;
+    while (this->nodeStates[alias] == NODE_COALESCED) {
+        alias = this->aliases[alias];
+    }
+    return alias;
+}
+
+void GraphColoringAllocator::combine(const size_t u, const size_t v) {
+    this->setNodeState(v, NODE_COALESCED);
+    this->aliases[v] = u;
+    this->costs[u] += this->costs[v];
+    this->moveLists[u].insert(this->moveLists[u].end(), 
+        this->moveLists[v].begin(), this->moveLists[v].end());
+    this->enableMoves(v);
+
+    for (const size_t t : this->adjacent(v)) {
+        this->addEdge(t, u);
+        this->decrementDegree(t);
+    }
+
+    if (this->degrees[u] >= this->colors && 
+        this->nodeStates[u] == NODE_FREEZE) {
+            this->setNodeState(u, NODE_SPILL);
+        }
+}
+
+void GraphColoringAllocator::freezeMoves(const size_t node) {
+    for (const size_t m : this->nodeMoves(node)) {
+        const size_t x = this->getAlias(this->moves[m].first);
+        const size_t y = this->getAlias(this->moves[m].second);
+        const size_t v = y == this->getAlias(node) ? x : y;
+
+        this->worklistMoves.erase(m);
+        this->moveStates[m] = MOVE_FROZEN;
+
+        if (this->nodeStates[v] == NODE_FREEZE && 
+            !this->isMoveRelated(v) && this->degrees[v] < this->colors) {
+                this->setNodeState(v, NODE_SIMPLIFY);
+            }
+    }
+}
+
+void GraphColoringAllocator::setNodeState(
+    const size_t node, 
+    const coloring_node_state_t state
+) {
+    this->simplifyWorklist.erase(node);
+    this->freezeWorklist.erase(node);
+    this->spillWorklist.erase(node);
+
+    this->nodeStates[node] = state;
+    if (state == NODE_SIMPLIFY) {
+        this->simplifyWorklist.insert(node);
+    } else if (state == NODE_FREEZE) {
+        this->freezeWorklist.insert(node);
+    } else if (state == NODE_SPILL) {
+        this->spillWorklist.insert(node);
+    }
+}
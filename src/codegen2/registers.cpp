@@ -48,6 +48,7 @@ std::set<RegPtr> Registers::generalPurposeRegisters = {
     std::make_shared<Register>("rsi"),
     std::make_shared<Register>("rdx"),
     std::make_shared<Register>("rcx"),
+    std::make_shared<Register>("rbx"),
     std::make_shared<Register>("rax")
 };
 
@@ -70,6 +71,60 @@ std::set<RegPtr> Registers::vectorRegisters = {
     std::make_shared<Register>("ymm0")
 };
 
+std::vector<RegPtr> Registers::getAllocatableRegisters(
+    const register_type_t &type
+) {
+    // The scratch registers hold the values used within a single block, 
+    // such as literals and the addresses of array elements.
+    static const std::set<std::string> scratch = {
+        "\%rax", "\%rcx", "\%rdx", "\%rsi", "\%ymm0", "\%ymm1", "\%ymm2"
+    };
+
+    std::vector<RegPtr> result;
+    for (const RegPtr &reg : Registers::selectRegisters(type)) {
+        if (!scratch.count(reg->getName())) {
+            result.push_back(reg);
+        }
+    }
+    return result;
+}
+
+bool Registers::isCalleeSaved(const RegPtr &reg) {
+    static const std::set<std::string> calleeSaved = {
+        "\%rbx", "\%r12", "\%r13", "\%r14", "\%r15"
+    };
+    return calleeSaved.count(reg->getName()) != 0;
+}
+
+const std::vector<RegPtr> &Registers::getArgumentRegisters() {
+    static const std::vector<RegPtr> arguments = {
+        Registers::findRegister("\%rdi"), Registers::findRegister("\%rsi"),
+        Registers::findRegister("\%rdx"), Registers::findRegister("\%rcx"),
+        Registers::findRegister("\%r8"), Registers::findRegister("\%r9")
+    };
+    return arguments;
+}
+
+RegPtr Registers::getReturnRegister() {
+    return Registers::findRegister("\%rax");
+}
+
+std::pair<RegPtr, RegPtr> Registers::getWideRegisters() {
+    return { 
+        Registers::findRegister("\%rax"), Registers::findRegister("\%rdx") 
+    };
+}
+
+RegPtr Registers::findRegister(const std::string &name) {
+    for (const RegPtr &reg : Registers::generalPurposeRegisters) {
+        if (reg->getName() == name) {
+            return reg;
+        }
+    }
+    ERROR_LOG("no register named %s", name.c_str());
+    exit(EXIT_FAILURE);
+}
+
 RegisterAllocationTable::RegisterAllocationTable() {}
 
 void RegisterAllocationTable::setRegisterValue(
@@ -77,37 +132,61 @@ void RegisterAllocationTable::setRegisterValue(
     const std::string &value
 ) {
     this->registerTable[reg] = value;
+    this->written.insert(reg);
+}
+
+void RegisterAllocationTable::setReserved(const std::set<RegPtr> &reserved) {
+    this->reserved = reserved;
+}
+
+const std::set<RegPtr> &RegisterAllocationTable::getReserved() const {
+    return this->reserved;
 }
 
 bool RegisterAllocationTable::atLeastOneRegisterUnused(
     const register_type_t &type
 ) const {
-    return Registers::selectRegisters(type).size() 
-        != this->registerTable.size();
+    return this->getUnusedRegister(type) != nullptr;
 }
 
 RegPtr RegisterAllocationTable::getUnusedRegister(
     const register_type_t &type
 ) const {
     for (auto reg : Registers::selectRegisters(type)) {
-        if (this->registerTable.count(reg) == 0) {
+        if (this->registerTable.count(reg) == 0 && 
+            this->reserved.count(reg) == 0) {
             return reg;
         }
     }
     return nullptr;
 }
 
-RegPtr RegisterAllocationTable::getARegisterInUse(
+RegPtr RegisterAllocationTable::getUnusedCalleeSavedRegister(
     const register_type_t &type
 ) const {
     for (auto reg : Registers::selectRegisters(type)) {
-        if (this->registerTable.count(reg) != 0) {
+        if (Registers::isCalleeSaved(reg) &&
+            this->registerTable.count(reg) == 0 && 
+            this->reserved.count(reg) == 0) {
             return reg;
         }
     }
     return nullptr;
 }
 
+std::vector<RegPtr> RegisterAllocationTable::getRegistersInUse(
+    const register_type_t &type
+) const {
+    std::vector<RegPtr> result;
+    for (auto reg : Registers::selectRegisters(type)) {
+        if (this->registerTable.count(reg) != 0 && 
+            this->reserved.count(reg) == 0) {
+            result.push_back(reg);
+        }
+    }
+    return result;
+}
+
 std::string RegisterAllocationTable::getVariableInRegister(RegPtr reg) const {
     return this->registerTable.at(reg);
 }
@@ -128,6 +207,10 @@ std::set<RegPtr> RegisterAllocationTable::getAllRegistersInUse() {
     return usedRegs;
 }
 
+const std::set<RegPtr> &RegisterAllocationTable::getRegistersWritten() const {
+    return this->written;
+}
+
 std::string RegisterAllocationTable::to_string() const {
     std::string result = "";
     for (auto p : this->registerTable) {
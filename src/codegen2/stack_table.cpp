@@ -2,30 +2,39 @@
 
 #include <assertions.h>
 
-StackTable::StackTable() : baseAddress(0), stackSize(0) {}
+// Pushing the frame pointer on an aligned stack leaves it 24 bytes above an
+// aligned address. A procedure is entered with its return address already
+// pushed, which leaves the frame pointer 16 bytes above one.
+StackTable::StackTable() : procedure(false), baseAddress(24), stackSize(0) {}
 
-StackAddr StackTable::allocate(const std::string &variable, unsigned int size) {
-    StackAddr ret = this->stackSize;
-    this->varsInStack.insert(std::make_pair(variable, ret));
-    this->stackSize += size;
-    return ret;
+void StackTable::newBaseAddress() {
+    ASSERT(this->stackSize == 0);
+    this->procedure = true;
+    this->baseAddress = 16;
 }
 
-void StackTable::resetToPreviousBaseAddress() {
-    ASSERT(!this->prevBaseAddresses.empty());
-    this->baseAddress = this->prevBaseAddresses.top();
-    this->stackSize = this->baseAddress;
-    this->prevBaseAddresses.pop();
-    this->clearVarsInStackToBaseAddress();
+bool StackTable::inGlobalScope() const {
+    return !this->procedure;
 }
 
-void StackTable::newBaseAddress() {
-    this->baseAddress = this->stackSize;
-    this->prevBaseAddresses.push(this->baseAddress);
+StackAddr StackTable::allocate(
+    const std::string &variable,
+    unsigned int size,
+    unsigned int alignment
+) {
+    ASSERT(STACK_ALIGNMENT % alignment == 0);
+    this->stackSize = this->alignBelowBase(this->stackSize + size, alignment);
+    const StackAddr ret = -static_cast<StackAddr>(this->stackSize);
+    this->varsInStack[variable] = ret;
+    return ret;
 }
 
-bool StackTable::inGlobalScope() const {
-    return this->baseAddress == 0;
+void StackTable::insertArgument(
+    const std::string &variable,
+    StackAddr address
+) {
+    ASSERT(address > 0);
+    this->varsInStack[variable] = address;
 }
 
 bool StackTable::inStack(const std::string &variable) const {
@@ -36,12 +45,21 @@ StackAddr StackTable::getAddress(const std::string &variable) const {
     return this->varsInStack.at(variable);
 }
 
-void StackTable::clearVarsInStackToBaseAddress() {
-    for (
-        auto p = this->varsInStack.begin(); p != this->varsInStack.end(); p++
-    ) {
-        if (p->second > this->baseAddress) {
-            this->varsInStack.erase(p);
-        }
-    }
+unsigned int StackTable::getStackSize() const {
+    return this->stackSize;
+}
+
+unsigned int StackTable::getFrameSize() const {
+    return this->alignBelowBase(this->stackSize, STACK_ALIGNMENT);
+}
+
+unsigned int StackTable::alignBelowBase(
+    const unsigned int size,
+    const unsigned int alignment
+) const {
+    // The address is aligned once the size less the distance of the frame
+    // pointer above an aligned address is a multiple of the alignment.
+    const unsigned int remainder =
+        (size + STACK_ALIGNMENT - this->baseAddress) % alignment;
+    return remainder == 0 ? size : size + alignment - remainder;
 }
@@ -0,0 +1,68 @@
+#include <interner.h>
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <assertions.h>
+
+// Names are stored in chunks that never move, so that a name can be looked
+// up without taking the lock. Another thread only learns the ID of a name
+// after the name is stored.
+#define CHUNK_BITS 12
+#define CHUNK_SIZE (1u << CHUNK_BITS)
+#define MAX_CHUNKS (1u << (32 - CHUNK_BITS))
+
+static const std::string **chunks[MAX_CHUNKS];
+static std::atomic<SymbolId> nameCount(0);
+static std::mutex internLock;
+
+// The table is created on first use, as symbols may be constructed during
+// static initialization. Nodes of an unordered map are never moved, so the
+// interned strings are the keys of the map.
+static std::unordered_map<std::string, SymbolId> &getIds() {
+    static std::unordered_map<std::string, SymbolId> ids;
+    return ids;
+}
+
+// Must be called with the lock held.
+static SymbolId store(const std::string &name) {
+    std::unordered_map<std::string, SymbolId> &ids = getIds();
+
+    const SymbolId id = nameCount.load(std::memory_order_relaxed);
+    const auto result = ids.emplace(name, id);
+    if (!result.second) {
+        return result.first->second;
+    }
+
+    const std::string **&chunk = chunks[id >> CHUNK_BITS];
+    if (chunk == nullptr) {
+        chunk = new const std::string *[CHUNK_SIZE];
+    }
+    chunk[id & (CHUNK_SIZE - 1)] = &result.first->first;
+    nameCount.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+SymbolId Interner::intern(const std::string &name) {
+    std::lock_guard<std::mutex> guard(internLock);
+    if (nameCount.load(std::memory_order_relaxed) == 0) {
+        store("");
+    }
+    return store(name);
+}
+
+const std::string &Interner::lookup(const SymbolId id) {
+    if (id == EMPTY_SYMBOL &&
+        nameCount.load(std::memory_order_acquire) == 0) {
+            Interner::intern("");
+        }
+    ASSERT(id < nameCount.load(std::memory_order_acquire));
+    return *chunks[id >> CHUNK_BITS][id & (CHUNK_SIZE - 1)];
+}
+
+size_t Interner::size() {
+    if (nameCount.load(std::memory_order_acquire) == 0) {
+        Interner::intern("");
+    }
+    return nameCount.load(std::memory_order_acquire);
+}
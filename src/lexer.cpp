@@ -10,6 +10,7 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <timer.h>
 
 std::string tokenTypeToString(const token_class_t type) {
     return type_to_string.at(type);
@@ -148,6 +149,7 @@ Lexer::Lexer()
 Lexer::~Lexer() {}
 
 token_stream_t Lexer::lex(const std::string &file_path) {
+    ScopedTimer timer("Lexer::lex");
     token_stream_t token_stream;
     Scanner scanner = Scanner(file_path);
     token_t token;
@@ -6,11 +6,16 @@
  *  Department of Computer Science
  */
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
 #include <argp.h>
 #include <lexer.h>
 #include <parser.h>
 #include <past.h>
 #include <3ac.h>
+#include <thread_pool.h>
+#include <timer.h>
 #include <optimizer/optimizer.h>
 //#include <codegen/asm_generator.h>
 #include <codegen2/code_generator.h>
@@ -18,10 +23,45 @@
 const char *argp_program_version = "Dalton\'s Toy Compiler";
 const char *argp_program_bug_address = "dpcaron@csu.fullerton.edu";
 static char doc[] = "A compiler program for demonstrating an optimizer.";
-static char args_doc[] = "<source code file> [-v]";
+static char args_doc[] = "<source code file> [-v] [-u] [-r] [-t] [-s] [-c] [-g] [-p] [-d] [-i] [-e] [-O<level>] [-j<jobs>] [--passes=<pipeline>] [--time-report[=<format>]] [--regalloc=<allocator>]";
+// The key of options that only have a long name.
+#define OPTION_PASSES 256
+#define OPTION_TIME_REPORT 257
+#define OPTION_REGALLOC 258
+
 static struct argp_option options[] = {
     {"vectorize", 'v', 0, 0, 
         "Boolean flag for enabling automatic vectorization"},
+    {"unswitch", 'u', 0, 0, 
+        "Boolean flag for enabling loop unswitching"},
+    {"unroll", 'r', 0, 0, 
+        "Boolean flag for enabling full unrolling of small loops"},
+    {"rotate", 't', 0, 0, 
+        "Boolean flag for enabling rotation of loops into bottom tested form"},
+    {"ssa", 's', 0, 0, 
+        "Boolean flag for enabling conversion into and out of SSA form"},
+    {"sccp", 'c', 0, 0, 
+        "Boolean flag for enabling sparse conditional constant propagation"},
+    {"gvn", 'g', 0, 0, 
+        "Boolean flag for enabling global value numbering"},
+    {"copyprop", 'p', 0, 0, 
+        "Boolean flag for enabling global copy propagation"},
+    {"dce", 'd', 0, 0, 
+        "Boolean flag for enabling dead code elimination"},
+    {"inline", 'i', 0, 0, 
+        "Boolean flag for enabling inlining of small procedures"},
+    {"tailcall", 'e', 0, 0, 
+        "Boolean flag for turning tail calls into jumps and tail recursion into loops"},
+    {"optimize", 'O', "LEVEL", 0, 
+        "Optimization level from 0 to 2, adding to the enabled passes"},
+    {"jobs", 'j', "JOBS", 0, 
+        "Number of threads that optimize and translate procedures in parallel"},
+    {"passes", OPTION_PASSES, "PIPELINE", 0, 
+        "Comma separated passes to run in order, replacing the level and flags"},
+    {"time-report", OPTION_TIME_REPORT, "FORMAT", OPTION_ARG_OPTIONAL, 
+        "Report the time and memory used by each phase as a table or as json"},
+    {"regalloc", OPTION_REGALLOC, "ALLOCATOR", 0, 
+        "Allocate registers within each block (local) or across blocks (linear, or graph at -O2)"},
     { 0 }
 };
 
@@ -29,6 +69,23 @@ static struct argp_option options[] = {
 struct arguments {
     char *args[1];
     bool vectorize;
+    bool unswitch;
+    bool unroll;
+    bool rotate;
+    bool ssa;
+    bool sccp;
+    bool gvn;
+    bool copyprop;
+    bool dce;
+    bool inlining;
+    bool tailCalls;
+    unsigned int level;
+    unsigned int jobs;
+    char *passes;
+    bool timeReport;
+    bool timeReportJson;
+    register_allocator_kind_t regalloc;
+    bool regallocChosen;
 };
 
 struct arguments arguments;
@@ -39,6 +96,79 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
         case 'v':
             arguments->vectorize = true;
             break;
+        case 'u':
+            arguments->unswitch = true;
+            break;
+        case 'r':
+            arguments->unroll = true;
+            break;
+        case 't':
+            arguments->rotate = true;
+            break;
+        case 's':
+            arguments->ssa = true;
+            break;
+        case 'c':
+            arguments->sccp = true;
+            break;
+        case 'g':
+            arguments->gvn = true;
+            break;
+        case 'p':
+            arguments->copyprop = true;
+            break;
+        case 'd':
+            arguments->dce = true;
+            break;
+        case 'i':
+            arguments->inlining = true;
+            break;
+        case 'e':
+            arguments->tailCalls = true;
+            break;
+        case 'O': {
+            char *end;
+            const long level = strtol(arg, &end, 10);
+            if (*arg == '\0' || *end != '\0' || level < 0 || 
+                level > MAX_OPTIMIZATION_LEVEL) {
+                    argp_error(state, "invalid optimization level %s", arg);
+                }
+            arguments->level = level;
+            break;
+        }
+        case 'j': {
+            char *end;
+            const long jobs = strtol(arg, &end, 10);
+            if (*arg == '\0' || *end != '\0' || jobs < 1 || jobs > 1024) {
+                argp_error(state, "invalid number of jobs %s", arg);
+            }
+            arguments->jobs = jobs;
+            break;
+        }
+        case OPTION_PASSES:
+            arguments->passes = arg;
+            break;
+        case OPTION_TIME_REPORT:
+            if (arg != nullptr && strcmp(arg, "table") != 0 && 
+                strcmp(arg, "json") != 0) {
+                    argp_error(state, "invalid time report format %s", arg);
+                }
+            arguments->timeReport = true;
+            arguments->timeReportJson = arg != nullptr && 
+                strcmp(arg, "json") == 0;
+            break;
+        case OPTION_REGALLOC:
+            if (strcmp(arg, "local") == 0) {
+                arguments->regalloc = REGALLOC_LOCAL;
+            } else if (strcmp(arg, "linear") == 0) {
+                arguments->regalloc = REGALLOC_LINEAR;
+            } else if (strcmp(arg, "graph") == 0) {
+                arguments->regalloc = REGALLOC_GRAPH;
+            } else {
+                argp_error(state, "invalid register allocator %s", arg);
+            }
+            arguments->regallocChosen = true;
+            break;
         case ARGP_KEY_ARG:
             if (state->arg_num >= 1) {
                 // To many arguments.
@@ -61,13 +191,60 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
 static struct argp argp = { options, parse_opt, args_doc, doc, 0, 0, 0 };
 
 bool AUTOMATIC_VECTORIZATION_ENABLED = false;
+bool LOOP_UNSWITCHING_ENABLED = false;
+bool LOOP_UNROLLING_ENABLED = false;
+bool LOOP_ROTATION_ENABLED = false;
+bool SSA_ENABLED = false;
+bool SCCP_ENABLED = false;
+bool GVN_ENABLED = false;
+bool COPY_PROPAGATION_ENABLED = false;
+bool DCE_ENABLED = false;
+bool INLINING_ENABLED = false;
+bool TAIL_CALLS_ENABLED = false;
+unsigned int OPTIMIZATION_LEVEL = 0;
+unsigned int JOBS = 1;
+char *PASS_PIPELINE = nullptr;
+bool TIME_REPORT_ENABLED = false;
+bool TIME_REPORT_JSON = false;
+register_allocator_kind_t REGISTER_ALLOCATOR = REGALLOC_LINEAR;
 
 int main(int argc, char *argv[]) {
 
+    arguments.jobs = 1;
+    arguments.regalloc = REGALLOC_LINEAR;
     argp_parse(&argp, argc, argv, 0, 0, &arguments);
 
     char *source_file = arguments.args[0];
     AUTOMATIC_VECTORIZATION_ENABLED = arguments.vectorize;
+    LOOP_UNSWITCHING_ENABLED = arguments.unswitch;
+    LOOP_UNROLLING_ENABLED = arguments.unroll;
+    LOOP_ROTATION_ENABLED = arguments.rotate;
+    SSA_ENABLED = arguments.ssa;
+    SCCP_ENABLED = arguments.sccp;
+    GVN_ENABLED = arguments.gvn;
+    COPY_PROPAGATION_ENABLED = arguments.copyprop;
+    DCE_ENABLED = arguments.dce;
+    INLINING_ENABLED = arguments.inlining;
+    TAIL_CALLS_ENABLED = arguments.tailCalls;
+    OPTIMIZATION_LEVEL = arguments.level;
+    JOBS = arguments.jobs;
+    PASS_PIPELINE = arguments.passes;
+    TIME_REPORT_ENABLED = arguments.timeReport;
+    TIME_REPORT_JSON = arguments.timeReportJson;
+    REGISTER_ALLOCATOR = arguments.regalloc;
+
+    // Coloring takes longer than the linear scan, which -O2 is willing to 
+    // spend for the better allocation.
+    if (!arguments.regallocChosen && 
+        arguments.level >= 2) {
+            REGISTER_ALLOCATOR = REGALLOC_GRAPH;
+        }
+
+    // The code generator makes tail calls as well, so the flag is settled 
+    // here rather than by the optimizer.
+    if (arguments.passes == nullptr && arguments.level >= 2) {
+        TAIL_CALLS_ENABLED = true;
+    }
 
     if (source_file == NULL) {
         (void) printf("Please provide a source file.\n");
@@ -81,26 +258,45 @@ int main(int argc, char *argv[]) {
 
     AST ast = parser.parse();
 
-    ExprAST::treeTraversal(ast, [](EASTPtr parent) {
-        parent->typeChecker();
-    });
+    {
+        ScopedTimer timer("typeChecker");
+        ExprAST::treeTraversal(ast, [](EASTPtr parent) {
+            parent->typeChecker();
+        });
+    }
 
     TACGenerator tacGenerator;
     std::vector<tac_line_t> tacCode;
-    ast->generateCode(tacGenerator, tacCode);
-    ast = nullptr;
+    {
+        ScopedTimer timer("TACGenerator");
+        ast->generateCode(tacGenerator, tacCode);
+        ast = nullptr;
+    }
 
     INFO_LOG("TAC Code before optimizer");
     for (const tac_line_t &inst : tacCode) {
         INFO_LOG("%s", TACGenerator::tacLineToString(inst).c_str());
     }
 
-    Optimizer optimizer(tacCode);
+    // The procedures are optimized and translated in parallel.
+    ThreadPool pool(JOBS);
+
+    std::unique_ptr<Optimizer> optimizer;
+    {
+        ScopedTimer timer("Optimizer");
+        optimizer = std::make_unique<Optimizer>(tacCode, pool);
+    }
 
     //AssemblyGenerator generator;
     //generator.generateAssembly(optimizer.getBlocks());
     CodeGenerator generator;
-    generator.generate(optimizer.getBlocks());
+    generator.generate(optimizer->getBlocks(), pool);
+
+    if (TIME_REPORT_ENABLED) {
+        const std::string report = TIME_REPORT_JSON ? 
+            TimeReport::to_json() + "\n" : TimeReport::to_table();
+        (void) fprintf(stderr, "%s", report.c_str());
+    }
 
     return EXIT_SUCCESS;
 }
\ No newline at end of file
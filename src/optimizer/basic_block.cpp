@@ -1,10 +1,14 @@
 #include <optimizer/basic_block.h>
 
 #include <algorithm>
+#include <assertions.h>
 
 void BasicBlock::resetGlobalState() {
     BasicBlock::functionCount = 0;
-    BasicBlock::globalVarDefinitions.clear();
+    {
+        std::lock_guard<std::mutex> guard(BasicBlock::globalVarDefinitionsLock);
+        BasicBlock::globalVarDefinitions.clear();
+    }
     BasicBlock::basicBlockIdGenerator = 0;
     BasicBlock::minorIdGenerator = 0;
 }
@@ -13,11 +17,70 @@ unsigned int BasicBlock::functionCount = 0;
 
 std::set<tac_line_t, decltype(set_id_cmp)> BasicBlock::globalVarDefinitions;
 
+std::mutex BasicBlock::globalVarDefinitionsLock;
+
+TIDSet BasicBlock::copyGlobalVarDefinitions() {
+    std::lock_guard<std::mutex> guard(BasicBlock::globalVarDefinitionsLock);
+    return BasicBlock::globalVarDefinitions;
+}
+
+unsigned int BasicBlock::getNextMinorId() {
+    return BasicBlock::minorIdGenerator;
+}
+
+void BasicBlock::setNextMinorId(const unsigned int next) {
+    BasicBlock::minorIdGenerator = next;
+}
+
+/**
+ * Renumbers the instructions of a set in place. The order of the IDs is kept,
+ * so the set stays sorted, and every block holds a copy of the definitions of
+ * the global variables, which is too many to copy.
+ * @param set A set of instructions.
+ * @param renumber Maps each ID to its new ID, keeping their order.
+ */
+static void renumberSet(
+    TIDSet &set,
+    const std::function<TID(TID)> &renumber
+) {
+    for (const tac_line_t &inst : set) {
+        const_cast<tac_line_t &>(inst).bid = renumber(inst.bid);
+    }
+}
+
+/**
+ * @param chain A def or use chain.
+ * @param renumber Maps each ID to its new ID.
+ */
+static void renumberChain(
+    SymbolMap<std::vector<tac_line_t>> &chain,
+    const std::function<TID(TID)> &renumber
+) {
+    for (auto &entry : chain) {
+        for (tac_line_t &inst : entry.second) {
+            inst.bid = renumber(inst.bid);
+        }
+    }
+}
+
+void BasicBlock::renumberGlobalVarDefinitions(
+    const std::function<TID(TID)> &renumber
+) {
+    std::lock_guard<std::mutex> guard(BasicBlock::globalVarDefinitionsLock);
+    renumberSet(BasicBlock::globalVarDefinitions, renumber);
+}
+
 BasicBlock::BasicBlock() 
     : id(BasicBlock::basicBlockIdGenerator++), minorId(0), 
     hasProcedureCall(false), hasEnterProcedure(false), hasExitProcedure(false),
     controlChangesAtEnd(false), 
-    localVariableDefinitions(BasicBlock::globalVarDefinitions) {}
+    localVariableDefinitions(BasicBlock::copyGlobalVarDefinitions()) {}
+
+BasicBlock::BasicBlock(const unsigned int majorId)
+    : id(majorId), minorId(BasicBlock::minorIdGenerator++), 
+    hasProcedureCall(false), hasEnterProcedure(false), hasExitProcedure(false),
+    controlChangesAtEnd(false), 
+    localVariableDefinitions(BasicBlock::copyGlobalVarDefinitions()) {}
 
 BasicBlock::BasicBlock(
     const unsigned int newMajorId, 
@@ -44,6 +107,15 @@ BasicBlock::BasicBlock(
 BasicBlock::~BasicBlock() {}
 
 void BasicBlock::insertInstruction(const tac_line_t instruction) {
+    if (instruction.operation == TAC_ENTER_PROC) {
+        BasicBlock::functionCount++;
+    }
+
+    this->recordInstruction(instruction);
+    this->instructions.push_back(instruction);
+}
+
+void BasicBlock::recordInstruction(const tac_line_t &instruction) {
     this->controlChangesAtEnd = false;
     if (tac_line_t::transfers_control(instruction)) {
         this->controlChangesAtEnd = true;
@@ -55,7 +127,6 @@ void BasicBlock::insertInstruction(const tac_line_t instruction) {
             break;
         case TAC_ENTER_PROC:
             this->hasEnterProcedure = true;
-            BasicBlock::functionCount++;
             break;
         case TAC_EXIT_PROC:
             this->hasExitProcedure = true;
@@ -65,37 +136,25 @@ void BasicBlock::insertInstruction(const tac_line_t instruction) {
     }
 
     if (tac_line_t::has_result(instruction)) {
-        this->globalVarDefinitions.insert(instruction);
+        {
+            std::lock_guard<std::mutex> guard(
+                BasicBlock::globalVarDefinitionsLock
+            );
+            BasicBlock::globalVarDefinitions.insert(instruction);
+        }
         this->localVariableDefinitions.insert(instruction);
         this->variableAssignments.insert(instruction.result);
 
-        if (!this->defChain.count(instruction.result)) {
-            this->defChain.insert(
-                std::make_pair(instruction.result, std::vector<tac_line_t>())
-            );
-        }
-        this->defChain.at(instruction.result).push_back(instruction);
+        this->defChain[instruction.result].push_back(instruction);
     }
 
     if (instruction.argument1 != "") {
-        if (!this->useChain.count(instruction.argument1)) {
-            this->useChain.insert(
-                std::make_pair(instruction.argument1, std::vector<tac_line_t>())
-            );
-        }
-        this->useChain.at(instruction.argument1).push_back(instruction);
+        this->useChain[instruction.argument1].push_back(instruction);
     }
 
     if (instruction.argument2 != "") {
-        if (!this->useChain.count(instruction.argument2)) {
-            this->useChain.insert(
-                std::make_pair(instruction.argument2, std::vector<tac_line_t>())
-            );
-        }
-        this->useChain.at(instruction.argument2).push_back(instruction);
+        this->useChain[instruction.argument2].push_back(instruction);
     }
-
-    this->instructions.push_back(instruction);
 }
 
 void BasicBlock::insertInstructions(
@@ -119,6 +178,67 @@ void BasicBlock::removeInstruction(const tac_line_t instruction) {
     ), this->instructions.end());
 }
 
+void BasicBlock::recomputeInstructionInfo() {
+    this->hasProcedureCall = false;
+    this->hasEnterProcedure = false;
+    this->hasExitProcedure = false;
+    this->controlChangesAtEnd = false;
+    this->variableAssignments.clear();
+    this->defChain.clear();
+    this->useChain.clear();
+
+    for (const tac_line_t &instruction : this->instructions) {
+        this->recordInstruction(instruction);
+    }
+}
+
+void BasicBlock::renumberInstructions(
+    const std::function<TID(TID)> &renumber
+) {
+    for (tac_line_t &inst : this->instructions) {
+        inst.bid = renumber(inst.bid);
+    }
+
+    renumberSet(this->localVariableDefinitions, renumber);
+    renumberSet(this->generated, renumber);
+    renumberSet(this->killed, renumber);
+    renumberChain(this->defChain, renumber);
+    renumberChain(this->useChain, renumber);
+}
+
+void BasicBlock::mergeWithSuccessor(BBP successor) {
+    ASSERT(this->successors.size() == 1);
+    ASSERT(this->successors.at(0) == successor);
+    ASSERT(successor->predecessors.size() == 1);
+
+    // A jump to the successor is now a fall through.
+    if (this->blockEndsWithUnconditionalJump()) {
+        this->instructions.pop_back();
+    }
+
+    for (const tac_line_t &inst : successor->instructions) {
+        if (inst.operation != TAC_LABEL) {
+            this->instructions.push_back(inst);
+        }
+    }
+
+    // The only predecessor of the successor is the shared pointer to this.
+    BBP self = successor->predecessors.at(0);
+
+    this->successors = successor->successors;
+    for (BBP after : this->successors) {
+        std::replace(
+            after->predecessors.begin(), after->predecessors.end(),
+            successor, self
+        );
+    }
+
+    successor->clearPredecessors();
+    successor->clearSuccessors();
+
+    this->recomputeInstructionInfo();
+}
+
 void BasicBlock::insertPredecessor(BBP block) {
     this->predecessors.push_back(block);
 }
@@ -173,6 +293,10 @@ unsigned int BasicBlock::getID() const {
     return this->id;
 }
 
+uint32_t BasicBlock::getIndex() const {
+    return this->index;
+}
+
 unsigned int BasicBlock::getMinorId() const {
     return this->minorId;
 }
@@ -181,6 +305,10 @@ void BasicBlock::setMinorId(const unsigned int mid) {
     this->minorId = mid;
 }
 
+void BasicBlock::renewMinorId() {
+    this->minorId = BasicBlock::minorIdGenerator++;
+}
+
 bool BasicBlock::getHasProcedureCall() const {
     return this->hasProcedureCall;
 }
@@ -202,15 +330,15 @@ bool BasicBlock::changesControlAtEnd() const {
     return this->controlChangesAtEnd;
 }
 
-std::set<tac_line_t, decltype(set_id_cmp)> BasicBlock::getGenSet() const {
+const TIDSet &BasicBlock::getGenSet() const {
     return this->generated;
 }
 
-std::set<tac_line_t, decltype(set_id_cmp)> BasicBlock::getKillSet() const {
+const TIDSet &BasicBlock::getKillSet() const {
     return this->killed;
 }
 
-const std::map<std::string, std::vector<tac_line_t>> &BasicBlock::getDefChain() const {
+const SymbolMap<std::vector<tac_line_t>> &BasicBlock::getDefChain() const {
     return this->defChain;
 }
 
@@ -229,6 +357,7 @@ bool BasicBlock::isNeverDefined(const std::string &variable) const {
 }
 
 void BasicBlock::computeGenAndKillSets() {
+    this->generated.clear();
     this->killed = TIDSet(this->localVariableDefinitions);
     for (
         auto t = this->getInstructions().begin();
@@ -260,4 +389,4 @@ std::string BasicBlock::to_string() const {
 
 unsigned int BasicBlock::basicBlockIdGenerator = 0;
 
-unsigned int BasicBlock::minorIdGenerator = 1;
\ No newline at end of file
+thread_local unsigned int BasicBlock::minorIdGenerator = 1;
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include <optimizer/bit_vector.h>
+
+#include <assertions.h>
+
+#define WORD_BITS 64
+
+BitVector::BitVector() : bits(0) {}
+
+BitVector::BitVector(const size_t size, const bool value)
+: bits(size), words((size + WORD_BITS - 1) / WORD_BITS, value ? ~0ull : 0) {
+    this->clearUnusedBits();
+}
+
+size_t BitVector::size() const {
+    return this->bits;
+}
+
+size_t BitVector::count() const {
+    size_t result = 0;
+    for (const uint64_t word : this->words) {
+        result += __builtin_popcountll(word);
+    }
+    return result;
+}
+
+bool BitVector::none() const {
+    for (const uint64_t word : this->words) {
+        if (word != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BitVector::test(const size_t index) const {
+    ASSERT(index < this->bits);
+    return (this->words[index / WORD_BITS] >> (index % WORD_BITS)) & 1;
+}
+
+void BitVector::set(const size_t index) {
+    ASSERT(index < this->bits);
+    this->words[index / WORD_BITS] |= 1ull << (index % WORD_BITS);
+}
+
+void BitVector::reset(const size_t index) {
+    ASSERT(index < this->bits);
+    this->words[index / WORD_BITS] &= ~(1ull << (index % WORD_BITS));
+}
+
+void BitVector::setAll() {
+    for (uint64_t &word : this->words) {
+        word = ~0ull;
+    }
+    this->clearUnusedBits();
+}
+
+void BitVector::resetAll() {
+    for (uint64_t &word : this->words) {
+        word = 0;
+    }
+}
+
+bool BitVector::unionWith(const BitVector &other) {
+    ASSERT(this->bits == other.bits);
+    uint64_t changed = 0;
+    for (size_t i = 0; i < this->words.size(); i++) {
+        const uint64_t word = this->words[i] | other.words[i];
+        changed |= word ^ this->words[i];
+        this->words[i] = word;
+    }
+    return changed != 0;
+}
+
+bool BitVector::intersectWith(const BitVector &other) {
+    ASSERT(this->bits == other.bits);
+    uint64_t changed = 0;
+    for (size_t i = 0; i < this->words.size(); i++) {
+        const uint64_t word = this->words[i] & other.words[i];
+        changed |= word ^ this->words[i];
+        this->words[i] = word;
+    }
+    return changed != 0;
+}
+
+bool BitVector::subtract(const BitVector &other) {
+    ASSERT(this->bits == other.bits);
+    uint64_t changed = 0;
+    for (size_t i = 0; i < this->words.size(); i++) {
+        const uint64_t word = this->words[i] & ~other.words[i];
+        changed |= word ^ this->words[i];
+        this->words[i] = word;
+    }
+    return changed != 0;
+}
+
+void BitVector::forEach(std::function<void(size_t index)> action) const {
+    for (size_t i = 0; i < this->words.size(); i++) {
+        uint64_t word = this->words[i];
+        while (word != 0) {
+            action(i * WORD_BITS + __builtin_ctzll(word));
+            // Clears the lowest set bit.
+            word &= word - 1;
+        }
+    }
+}
+
+bool BitVector::operator==(const BitVector &other) const {
+    return this->bits == other.bits && this->words == other.words;
+}
+
+bool BitVector::operator!=(const BitVector &other) const {
+    return !(*this == other);
+}
+
+std::string BitVector::to_string() const {
+    std::string result;
+    for (size_t i = 0; i < this->bits; i++) {
+        result += this->test(i) ? '1' : '0';
+    }
+    return result;
+}
+
+void BitVector::clearUnusedBits() {
+    // Bits past the size are kept clear so that whole words can be compared.
+    if (this->bits % WORD_BITS != 0) {
+        this->words.back() &= (1ull << (this->bits % WORD_BITS)) - 1;
+    }
+}
@@ -0,0 +1,8 @@
+#include <optimizer/block_arena.h>
+
+BlockArena::BlockArena() {}
+
+uint32_t BlockArena::size() const {
+    std::lock_guard<std::mutex> guard(this->lock);
+    return this->blocks.size();
+}
@@ -0,0 +1,113 @@
+#include <optimizer/block_types.h>
+
+#include <assertions.h>
+
+BlockSet::BlockSet() : arena(std::make_shared<BlockArena>()) {}
+
+BlockSet::BlockSet(const BlockSet &other) {
+    std::lock_guard<std::mutex> guard(other.lock);
+    this->blocks = other.blocks;
+    this->arena = other.arena;
+}
+
+BlockSet &BlockSet::operator=(const BlockSet &other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    std::scoped_lock guard(this->lock, other.lock);
+    this->blocks = other.blocks;
+    this->arena = other.arena;
+    return *this;
+}
+
+uint32_t BlockSet::getArenaSize() const {
+    return this->arena->size();
+}
+
+void BlockSet::insert(const BBP block) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->blocks.insert(block);
+}
+
+void BlockSet::erase(const BBP block) {
+    std::lock_guard<std::mutex> guard(this->lock);
+    this->blocks.erase(block);
+}
+
+void BlockSet::insertAfter(const BBP block, const BBP inserted) {
+    std::lock_guard<std::mutex> guard(this->lock);
+
+    auto position = this->blocks.find(block);
+    ASSERT(position != this->blocks.end());
+
+    std::vector<BBP> following;
+    for (position++; position != this->blocks.end() &&
+        (*position)->getID() == block->getID(); position++) {
+            following.push_back(*position);
+        }
+
+    // The minor IDs order the blocks, so they only change outside the set.
+    for (const BBP &bb : following) {
+        this->blocks.erase(bb);
+        bb->renewMinorId();
+    }
+
+    this->blocks.insert(inserted);
+    this->blocks.insert(following.begin(), following.end());
+}
+
+BBP BlockSet::getNext(const BBP block) const {
+    std::lock_guard<std::mutex> guard(this->lock);
+
+    auto position = this->blocks.find(block);
+    ASSERT(position != this->blocks.end());
+    if (position == this->blocks.end()) {
+        return nullptr;
+    }
+
+    position++;
+    return position != this->blocks.end() ? *position : nullptr;
+}
+
+BBP BlockSet::getPrevious(const BBP block) const {
+    std::lock_guard<std::mutex> guard(this->lock);
+
+    auto position = this->blocks.find(block);
+    ASSERT(position != this->blocks.end());
+    if (position == this->blocks.end() || position == this->blocks.begin()) {
+        return nullptr;
+    }
+    return *std::prev(position);
+}
+
+std::vector<BBP> BlockSet::getBlocksFrom(
+    const BBP first,
+    const size_t count
+) const {
+    std::lock_guard<std::mutex> guard(this->lock);
+
+    std::vector<BBP> result;
+    for (auto position = this->blocks.find(first);
+        position != this->blocks.end() && result.size() < count;
+        position++) {
+            result.push_back(*position);
+        }
+    return result;
+}
+
+BlockSet::const_iterator BlockSet::begin() const {
+    return this->blocks.begin();
+}
+
+BlockSet::const_iterator BlockSet::end() const {
+    return this->blocks.end();
+}
+
+size_t BlockSet::size() const {
+    return this->blocks.size();
+}
+
+bool BlockSet::empty() const {
+    return this->blocks.empty();
+}
@@ -35,7 +35,7 @@ BlockSet Blocker::computeBasicBlocks(
 
     BlockSet resultSet;
 
-    BBP block = std::make_shared<BasicBlock>();
+    BBP block = resultSet.create();
     firstBlock = block;
     tac_line_t leader = *instructions.begin();
     block->insertInstruction(leader);
@@ -47,7 +47,7 @@ BlockSet Blocker::computeBasicBlocks(
         // If the current instruction is a leader, it starts a new basic block.
         if (this->isInstructionLeader(current_instruction, followsJump)) {
             resultSet.insert(block);
-            block = std::make_shared<BasicBlock>();
+            block = resultSet.create();
         }
 
         block->insertInstruction(current_instruction);
@@ -85,6 +85,7 @@ void Blocker::computeControlFlowInformation() {
     auto i = this->basicBlocks.begin();
     BBP savedPreviousBlock = nullptr;
     BBP previousBlock = *i;
+    this->insertJumpEdges(previousBlock);
     for (++i; i != this->basicBlocks.end(); i++) {
 
         BBP currentBlock = *i;
@@ -109,31 +110,25 @@ void Blocker::computeControlFlowInformation() {
             previousBlock = currentBlock;
         }
 
-        // Now to deal with jumps.
-        for (
-            auto t = currentBlock->getInstructions().begin();
-            t != currentBlock->getInstructions().end();
-            t++
-        ) {
-            const tac_line_t &tac = *t;
-            // Function calls do transfer control but are ignored for this
-            // analysis.
-            if (
-                tac_line_t::transfers_control(tac) && tac.operation != TAC_CALL
-            ) {
-                BBP controlGoesTo = this->labelLocationInBlock.at(tac.argument1);
-                controlGoesTo->insertPredecessor(currentBlock);
-                currentBlock->insertSuccessor(controlGoesTo);
-                controlGoesTo = nullptr;
-            }
-        }
-
+        this->insertJumpEdges(currentBlock);
     }
 
     previousBlock = nullptr;
     savedPreviousBlock = nullptr;
 }
 
+void Blocker::insertJumpEdges(BBP block) {
+    for (const tac_line_t &tac : block->getInstructions()) {
+        // Function calls do transfer control but are ignored for this
+        // analysis.
+        if (tac_line_t::transfers_control(tac) && tac.operation != TAC_CALL) {
+            BBP controlGoesTo = this->labelLocationInBlock.at(tac.argument1);
+            controlGoesTo->insertPredecessor(block);
+            block->insertSuccessor(controlGoesTo);
+        }
+    }
+}
+
 bool Blocker::isInstructionLeader(
     const tac_line_t &line, const bool followsJump
 ) const {
@@ -1,7 +1,5 @@
 #include <optimizer/cfg.h>
 
-#include <optimizer/loop_vectorizer.h>
-
 #include <algorithm>
 #include <cstdio>
 #include <logging.h>
@@ -9,31 +7,34 @@
 
 CFG::CFG() {};
 
-CFG::CFG(BlockSet &allBlocks, std::string &name, BBP firstBlock) : name(name), 
-    entryBlock(firstBlock), dominator(Dominator(this)), reach(Reach(this)) {
-        printf("%s\n\n", this->to_graph().c_str());
-        printf("%s", this->dominator.to_graph().c_str());
-        auto backedges = this->computeBackwardsEdges();
-        printf("Back edges\n");
-        for (auto p : backedges) {
-            printf("(%d, %d)\n", p.first->getID(), p.second->getID());
-        }
-        auto nloops = this->computeNaturalLoops(backedges, allBlocks);
-        printf("Natural Loops\n");
-        for (auto p : nloops) {
-            printf("(%d, %d)\n", p.getHeader()->getID(), p.getFooter()->getID());
-        }
-        printf("Reach Analysis\n%s\n", this->reach.to_string().c_str());
-
-        if (AUTOMATIC_VECTORIZATION_ENABLED) {
-            for (NaturalLoop &loop : nloops) {
-                LoopVectorizer(loop).vectorize();
-            }
-
-            INFO_LOG("CFG after vectorization");
-            printf("%s\n\n", this->to_graph().c_str());
-        }
+CFG::CFG(const std::string &name, BBP firstBlock) : name(name), 
+    entryBlock(firstBlock) {}
+
+std::string CFG::to_report(BlockSet &allBlocks) {
+    // The analyses are computed here only to be printed. The pass manager 
+    // maintains its own copies while optimizing.
+    Dominator dominator(this);
+    const Reach reach(this);
+
+    std::string result = this->to_graph() + "\n\n";
+    result += dominator.to_graph();
+    auto backedges = this->computeBackwardsEdges();
+    result += "Back edges\n";
+    for (auto p : backedges) {
+        result += "(" + std::to_string(p.first->getID()) + ", " + 
+            std::to_string(p.second->getID()) + ")\n";
+    }
+    auto nloops = this->computeNaturalLoops(
+        backedges, &dominator, &reach, allBlocks
+    );
+    result += "Natural Loops\n";
+    for (auto p : nloops) {
+        result += "(" + std::to_string(p.getHeader()->getID()) + ", " + 
+            std::to_string(p.getFooter()->getID()) + ")\n";
     }
+    result += "Reach Analysis\n" + reach.to_string() + "\n";
+    return result;
+}
 
 BBP CFG::getEntryBlock() const {
     return this->entryBlock;
@@ -115,18 +116,20 @@ std::set<std::pair<BBP, BBP>> CFG::computeBackwardsEdges() {
 
 std::vector<NaturalLoop> CFG::computeNaturalLoops(
     std::set<std::pair<BBP, BBP>> backedges,
+    const Dominator *dominator,
+    const Reach *reach,
     BlockSet &allBlocks
 ) const {
     std::vector<NaturalLoop> loops;
 
     for (auto e = backedges.begin(); e != backedges.end(); e++) {
-        if (this->dominator.dominates(e->second, e->first)) {
+        if (dominator->dominates(e->second, e->first)) {
             loops.push_back(
                 NaturalLoop(
                     e->second, 
                     e->first, 
-                    &this->reach, 
-                    &this->dominator, 
+                    reach, 
+                    dominator, 
                     allBlocks
                 )
             );
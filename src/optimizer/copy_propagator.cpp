@@ -0,0 +1,249 @@
+#include <optimizer/copy_propagator.h>
+
+#include <optimizer/cfg.h>
+#include <optimizer/dataflow.h>
+
+#include <algorithm>
+#include <logging.h>
+
+/**
+ * @param name The name to check.
+ * @return True if the name is a temporary.
+ */
+static bool isTemporary(const std::string &name) {
+    return !tac_line_t::is_user_defined_var(name);
+}
+
+/**
+ * @param inst The current instruction.
+ * @param addresses Temporaries that hold the address of an array element.
+ * @return The name the instruction defines, or an empty string if there is
+ * no such name. Stores through addresses define no name.
+ */
+static std::string getDefinition(
+    const tac_line_t &inst,
+    const std::set<std::string> &addresses
+) {
+    switch (inst.operation) {
+        case TAC_READ:
+            return inst.argument1;
+        case TAC_ASSIGN:
+            return addresses.count(inst.result) ? "" : inst.result;
+        case TAC_NEGATE:
+        case TAC_ADD ... TAC_ARRAY_INDEX:
+        case TAC_VADD ... TAC_VLOAD:
+            return inst.result;
+        default:
+            return "";
+    }
+}
+
+/**
+ * @param inst The current instruction.
+ * @return The operands of the instruction that are read as scalar values.
+ */
+static std::vector<Symbol *> getUses(tac_line_t &inst) {
+    switch (inst.operation) {
+        case TAC_ASSIGN:
+            // Declarations have no operands.
+            if (inst.argument1 == "" || inst.argument2 != "") {
+                return {};
+            }
+            return {&inst.argument1};
+        case TAC_NEGATE:
+        case TAC_WRITE:
+        case TAC_PROC_PARAM:
+        case TAC_RETVAL:
+            return {&inst.argument1};
+        case TAC_ADD ... TAC_NOT_EQUALS:
+            return {&inst.argument1, &inst.argument2};
+        // The first operand is the array.
+        case TAC_ARRAY_INDEX:
+            return {&inst.argument2};
+        default:
+            return {};
+    }
+}
+
+CopyPropagator::CopyPropagator(CFG *cfg) : cfg(cfg) {
+    cfg->performPostorderTraversal([this](BBP block) {
+        this->blocks.push_back(block);
+    });
+    std::sort(this->blocks.begin(), this->blocks.end(), bb_cmp);
+
+    for (const BBP &bb : this->blocks) {
+        for (const tac_line_t &inst : bb->getInstructions()) {
+            if (inst.operation == TAC_ARRAY_INDEX) {
+                this->addresses.insert(inst.result);
+            }
+        }
+    }
+
+    for (const BBP &bb : this->blocks) {
+        for (const tac_line_t &inst : bb->getInstructions()) {
+            if (this->isCopy(inst) && !isTemporary(inst.result) &&
+                !isTemporary(inst.argument1)) {
+                    this->universe.insert(
+                        std::make_pair(inst.result, inst.argument1)
+                    );
+                }
+        }
+    }
+}
+
+bool CopyPropagator::propagate() {
+    this->computeReachingCopies();
+
+    bool changed = false;
+    for (const BBP &bb : this->blocks) {
+        changed |= this->propagateInBlock(bb);
+    }
+    return changed;
+}
+
+void CopyPropagator::computeReachingCopies() {
+    // Number the copies, so that each set of copies is a bit vector.
+    std::vector<std::pair<std::string, std::string>> copies;
+    std::map<std::pair<std::string, std::string>, unsigned int> numbers;
+    // The copies that are killed by defining each name.
+    std::map<std::string, BitVector> involving;
+    for (const std::pair<std::string, std::string> &copy : this->universe) {
+        numbers[copy] = copies.size();
+        copies.push_back(copy);
+    }
+    for (unsigned int i = 0; i < copies.size(); i++) {
+        for (const std::string &name : {copies[i].first, copies[i].second}) {
+            if (!involving.count(name)) {
+                involving[name] = BitVector(copies.size());
+            }
+            involving.at(name).set(i);
+        }
+    }
+
+    // A copy reaches a block only if it reaches along every edge, and no
+    // copy reaches the entry block.
+    DataflowSolver solver(
+        this->cfg, DATAFLOW_FORWARD, DATAFLOW_INTERSECTION, copies.size()
+    );
+    for (const BBP &bb : this->blocks) {
+        BitVector gen(copies.size());
+        BitVector kill(copies.size());
+
+        for (const tac_line_t &inst : bb->getInstructions()) {
+            const std::string def = getDefinition(inst, this->addresses);
+
+            // Every copy in the universe is between variables, which the 
+            // called procedure may define.
+            if (inst.operation == TAC_CALL) {
+                gen.resetAll();
+                kill.setAll();
+            } else if (involving.count(def)) {
+                gen.subtract(involving.at(def));
+                kill.unionWith(involving.at(def));
+            }
+
+            const std::pair<std::string, std::string> copy
+                = std::make_pair(inst.result, inst.argument1);
+            if (this->isCopy(inst) && numbers.count(copy)) {
+                gen.set(numbers.at(copy));
+            }
+        }
+
+        solver.setTransfer(bb, gen, kill);
+    }
+    solver.solve();
+
+    for (const BBP &bb : this->blocks) {
+        CopySet &in = this->in[bb];
+        solver.getIn(bb).forEach([&copies, &in](size_t number) {
+            in.insert(copies[number]);
+        });
+    }
+}
+
+bool CopyPropagator::propagateInBlock(const BBP block) {
+    CopySet copies = this->in.at(block);
+    bool changed = false;
+
+    for (tac_line_t &inst : block->getInstructions()) {
+        for (Symbol *use : getUses(inst)) {
+            auto copy = std::find_if(copies.begin(), copies.end(),
+                [use](const std::pair<std::string, std::string> &p) {
+                    return p.first == *use;
+                }
+            );
+            if (copy == copies.end()) {
+                continue;
+            }
+
+            INFO_LOG(
+                "Propagating %s for %s in %s",
+                copy->second.c_str(), use->c_str(),
+                block->id_to_string().c_str()
+            );
+            *use = copy->second;
+            changed = true;
+        }
+
+        this->transfer(inst, copies);
+    }
+
+    if (changed) {
+        block->recomputeInstructionInfo();
+    }
+
+    return changed;
+}
+
+void CopyPropagator::transfer(
+    const tac_line_t &inst,
+    CopySet &copies
+) const {
+    const std::string def = getDefinition(inst, this->addresses);
+
+    for (auto i = copies.begin(); i != copies.end();) {
+        // The called procedure may define any variable.
+        const bool killed = (def != "" &&
+            (i->first == def || i->second == def)) ||
+            (inst.operation == TAC_CALL &&
+            (!isTemporary(i->first) || !isTemporary(i->second)));
+
+        if (killed) {
+            i = copies.erase(i);
+        } else {
+            i++;
+        }
+    }
+
+    if (this->isCopy(inst)) {
+        copies.insert(std::make_pair(inst.result, inst.argument1));
+    }
+}
+
+bool CopyPropagator::isCopy(const tac_line_t &inst) const {
+    return inst.operation == TAC_ASSIGN && inst.argument2 == "" &&
+        inst.result != inst.argument1 &&
+        this->isCopyOperand(inst, inst.result) &&
+        this->isCopyOperand(inst, inst.argument1);
+}
+
+bool CopyPropagator::isCopyOperand(
+    const tac_line_t &inst,
+    const std::string &name
+) const {
+    // Using an address as an operand loads the element it points to.
+    if (name == "" || this->addresses.count(name)) {
+        return false;
+    }
+
+    if (isTemporary(name)) {
+        return true;
+    }
+
+    // Constants are left for constant propagation.
+    unsigned int level;
+    st_entry_t entry;
+    return inst.table->lookup(name, &level, &entry) &&
+        entry.entry_type == ST_VARIABLE && !entry.variable.isConstant &&
+        !entry.variable.isArray;
+}
@@ -0,0 +1,146 @@
+#include <optimizer/dataflow.h>
+
+#include <optimizer/cfg.h>
+
+#include <set>
+#include <assertions.h>
+
+DataflowSolver::DataflowSolver(
+    CFG *cfg,
+    const dataflow_direction_t direction,
+    const dataflow_meet_t meet,
+    const size_t size
+) : direction(direction), meet(meet), size(size), boundary(size) {
+    std::vector<BBP> postorder;
+    cfg->performPostorderTraversal([&postorder](BBP block) {
+        postorder.push_back(block);
+    });
+
+    // The traversal visits the entry block a second time if it is the
+    // target of a loop, and it must stay first in reverse postorder.
+    for (auto i = postorder.rbegin(); i != postorder.rend(); i++) {
+        if (!this->indices.count(*i)) {
+            this->indices[*i] = this->blocks.size();
+            this->blocks.push_back(*i);
+        }
+    }
+
+    // Without a transfer function a block creates and destroys nothing.
+    this->gen.assign(this->blocks.size(), BitVector(size));
+    this->kill.assign(this->blocks.size(), BitVector(size));
+}
+
+void DataflowSolver::setTransfer(
+    const BBP block,
+    const BitVector &gen,
+    const BitVector &kill
+) {
+    ASSERT(gen.size() == this->size && kill.size() == this->size);
+    const unsigned int index = this->indices.at(block);
+    this->gen[index] = gen;
+    this->kill[index] = kill;
+}
+
+void DataflowSolver::setBoundary(const BitVector &boundary) {
+    ASSERT(boundary.size() == this->size);
+    this->boundary = boundary;
+}
+
+void DataflowSolver::solve() {
+    const unsigned int count = this->blocks.size();
+    const bool forward = this->direction == DATAFLOW_FORWARD;
+
+    // An intersection starts from every fact and removes those that do not
+    // hold, while a union starts from none and adds those that do.
+    const BitVector initial(this->size, this->meet == DATAFLOW_INTERSECTION);
+    this->in.assign(count, initial);
+    this->out.assign(count, initial);
+
+    std::vector<BitVector> &inputs = forward ? this->in : this->out;
+    std::vector<BitVector> &outputs = forward ? this->out : this->in;
+
+    // The worklist holds positions in the visiting order, so the earliest
+    // block in that order is always processed next.
+    std::set<unsigned int> worklist;
+    for (unsigned int i = 0; i < count; i++) {
+        worklist.insert(i);
+    }
+
+    while (!worklist.empty()) {
+        const unsigned int position = *worklist.begin();
+        worklist.erase(worklist.begin());
+        const unsigned int index = forward ? position : count - 1 - position;
+
+        inputs[index] = this->meetInputs(index);
+
+        BitVector result = inputs[index];
+        result.subtract(this->kill[index]);
+        result.unionWith(this->gen[index]);
+
+        if (result == outputs[index]) {
+            continue;
+        }
+        outputs[index] = result;
+
+        const BBP block = this->blocks[index];
+        const std::vector<BBP> &dependents = forward
+            ? block->getSuccessors() : block->getPredecessors();
+        for (const BBP &dependent : dependents) {
+            if (!this->indices.count(dependent)) {
+                continue;
+            }
+            const unsigned int other = this->indices.at(dependent);
+            worklist.insert(forward ? other : count - 1 - other);
+        }
+    }
+}
+
+const std::vector<BBP> &DataflowSolver::getBlocks() const {
+    return this->blocks;
+}
+
+const BitVector &DataflowSolver::getIn(const BBP block) const {
+    return this->in.at(this->indices.at(block));
+}
+
+const BitVector &DataflowSolver::getOut(const BBP block) const {
+    return this->out.at(this->indices.at(block));
+}
+
+BitVector DataflowSolver::meetInputs(const unsigned int index) const {
+    const bool forward = this->direction == DATAFLOW_FORWARD;
+    const BBP block = this->blocks[index];
+    const std::vector<BBP> &sources = forward
+        ? block->getPredecessors() : block->getSuccessors();
+    const std::vector<BitVector> &outputs = forward ? this->out : this->in;
+
+    // The boundary acts as an extra edge into the entry block, or out of the
+    // blocks that leave the graph.
+    const bool atBoundary = forward ? index == 0 : sources.empty();
+
+    BitVector result(this->size, this->meet == DATAFLOW_INTERSECTION);
+    bool first = true;
+    if (atBoundary) {
+        result = this->boundary;
+        first = false;
+    }
+
+    for (const BBP &source : sources) {
+        // Unreachable blocks do not affect reachable ones.
+        if (!this->indices.count(source)) {
+            continue;
+        }
+
+        const BitVector &facts = outputs[this->indices.at(source)];
+        if (first) {
+            result = facts;
+            first = false;
+        } else if (this->meet == DATAFLOW_UNION) {
+            result.unionWith(facts);
+        } else {
+            result.intersectWith(facts);
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,345 @@
+#include <optimizer/dce.h>
+
+#include <optimizer/cfg.h>
+#include <optimizer/dataflow.h>
+
+#include <algorithm>
+#include <assertions.h>
+#include <logging.h>
+
+/**
+ * @param inst The current instruction.
+ * @return True if the instruction declares a variable.
+ */
+static bool isDeclaration(const tac_line_t &inst) {
+    return inst.operation == TAC_ASSIGN && inst.argument1 == "";
+}
+
+/**
+ * @param inst The current instruction.
+ * @param addresses Temporaries that hold the address of an array element.
+ * @return True if the instruction stores through an address.
+ */
+static bool isStore(
+    const tac_line_t &inst,
+    const std::set<std::string> &addresses
+) {
+    return inst.operation == TAC_ASSIGN && addresses.count(inst.result) > 0;
+}
+
+/**
+ * @param inst The current instruction.
+ * @param addresses Temporaries that hold the address of an array element.
+ * @return The name the instruction defines, or an empty string if there is
+ * no such name.
+ */
+static std::string getDefinition(
+    const tac_line_t &inst,
+    const std::set<std::string> &addresses
+) {
+    switch (inst.operation) {
+        case TAC_READ:
+            return inst.argument1;
+        case TAC_ASSIGN:
+            if (isDeclaration(inst) || isStore(inst, addresses)) {
+                return "";
+            }
+            return inst.result;
+        case TAC_NEGATE:
+        case TAC_ADD ... TAC_ARRAY_INDEX:
+        case TAC_VADD ... TAC_VLOAD:
+            return inst.result;
+        default:
+            return "";
+    }
+}
+
+/**
+ * @param inst The current instruction.
+ * @param addresses Temporaries that hold the address of an array element.
+ * @return The names the instruction uses.
+ */
+static std::vector<std::string> getUses(
+    const tac_line_t &inst,
+    const std::set<std::string> &addresses
+) {
+    switch (inst.operation) {
+        case TAC_NEGATE:
+        case TAC_WRITE:
+            return {inst.argument1};
+        case TAC_ASSIGN:
+            if (isDeclaration(inst)) {
+                return {};
+            }
+            if (isStore(inst, addresses)) {
+                return {inst.result, inst.argument1};
+            }
+            return {inst.argument1, inst.argument2};
+        case TAC_ADD ... TAC_ARRAY_INDEX:
+        case TAC_VADD ... TAC_VLOAD:
+            return {inst.argument1, inst.argument2};
+        case TAC_RETVAL:
+        case TAC_PROC_PARAM:
+        case TAC_VSTORE:
+            return {inst.result, inst.argument1, inst.argument2};
+        default:
+            return {};
+    }
+}
+
+/**
+ * @param inst The current instruction.
+ * @param addresses Temporaries that hold the address of an array element.
+ * @return True if the instruction has no effect other than defining its
+ * result, so it may be removed when the result is not used.
+ */
+static bool isRemovable(
+    const tac_line_t &inst,
+    const std::set<std::string> &addresses
+) {
+    switch (inst.operation) {
+        case TAC_ASSIGN:
+            return !isDeclaration(inst) && !isStore(inst, addresses);
+        // Comparisons without a result set the flags for the jump after them.
+        case TAC_LESS_THAN ... TAC_NOT_EQUALS:
+            return tac_line_t::has_result(inst);
+        case TAC_NEGATE:
+        case TAC_ADD ... TAC_MULT:
+        case TAC_ARRAY_INDEX:
+        case TAC_VADD ... TAC_VLOAD:
+            return true;
+        default:
+            return false;
+    }
+}
+
+DCE::DCE(CFG *cfg, BlockSet &allBlocks) : cfg(cfg), allBlocks(allBlocks) {
+    cfg->performPostorderTraversal([this](BBP block) {
+        this->blocks.push_back(block);
+    });
+    std::sort(this->blocks.begin(), this->blocks.end(), bb_cmp);
+
+    std::set<std::string> declared;
+    for (const BBP &bb : this->blocks) {
+        for (const tac_line_t &inst : bb->getInstructions()) {
+            if (inst.operation == TAC_ARRAY_INDEX) {
+                this->addresses.insert(inst.result);
+            }
+            if (isDeclaration(inst)) {
+                declared.insert(inst.result);
+            }
+        }
+    }
+
+    for (const BBP &bb : this->blocks) {
+        for (const tac_line_t &inst : bb->getInstructions()) {
+            for (const std::string &name :
+                {inst.result, inst.argument1, inst.argument2}) {
+                    if (tac_line_t::is_user_defined_var(name)) {
+                        this->variables.insert(name);
+                    }
+                }
+        }
+    }
+
+    for (const std::string &name : this->variables) {
+        if (!declared.count(name)) {
+            this->nonLocals.insert(name);
+        }
+    }
+}
+
+bool DCE::eliminate() {
+    bool changed = false;
+    bool removed = true;
+
+    while (removed) {
+        this->computeLiveness();
+        removed = this->sweep();
+        changed |= removed;
+    }
+
+    if (changed) {
+        this->removeEmptyBlocks();
+    }
+
+    return changed;
+}
+
+void DCE::computeLiveness() {
+    // Number every name, so that each set of live names is a bit vector. 
+    // Calls keep every variable live, including those whose instructions 
+    // were removed.
+    std::vector<std::string> names(
+        this->variables.begin(), this->variables.end()
+    );
+    std::map<std::string, unsigned int> numbers;
+    for (unsigned int i = 0; i < names.size(); i++) {
+        numbers[names[i]] = i;
+    }
+    for (const BBP &bb : this->blocks) {
+        for (const tac_line_t &inst : bb->getInstructions()) {
+            for (const std::string &name :
+                {inst.result, inst.argument1, inst.argument2}) {
+                    if (name != "" && !numbers.count(name)) {
+                        numbers[name] = names.size();
+                        names.push_back(name);
+                    }
+                }
+        }
+    }
+
+    DataflowSolver solver(
+        this->cfg, DATAFLOW_BACKWARD, DATAFLOW_UNION, names.size()
+    );
+    for (const BBP &bb : this->blocks) {
+        // Walking backwards, the names used before an instruction are live 
+        // and the name it defines is not, unless it is also used.
+        BitVector gen(names.size());
+        BitVector kill(names.size());
+
+        const std::vector<tac_line_t> &insts = bb->getInstructions();
+        for (auto i = insts.rbegin(); i != insts.rend(); i++) {
+            const std::string def = getDefinition(*i, this->addresses);
+            if (def != "") {
+                gen.reset(numbers.at(def));
+                kill.set(numbers.at(def));
+            }
+
+            std::set<std::string> uses;
+            this->transfer(*i, uses);
+            for (const std::string &use : uses) {
+                gen.set(numbers.at(use));
+            }
+        }
+
+        solver.setTransfer(bb, gen, kill);
+    }
+    solver.solve();
+
+    this->liveIn.clear();
+    for (const BBP &bb : this->blocks) {
+        std::set<std::string> &live = this->liveIn[bb];
+        solver.getIn(bb).forEach([&names, &live](size_t number) {
+            live.insert(names[number]);
+        });
+    }
+}
+
+bool DCE::sweep() {
+    bool removed = false;
+
+    for (const BBP &bb : this->blocks) {
+        std::set<std::string> live = this->getLiveOut(bb);
+
+        std::vector<tac_line_t> &insts = bb->getInstructions();
+        std::vector<tac_line_t> kept;
+        bool blockChanged = false;
+        for (auto i = insts.rbegin(); i != insts.rend(); i++) {
+            const std::string def = getDefinition(*i, this->addresses);
+            if (isRemovable(*i, this->addresses) && !live.count(def)) {
+                INFO_LOG(
+                    "Removing dead instruction %s in %s",
+                    TACGenerator::tacLineToString(*i).c_str(),
+                    bb->id_to_string().c_str()
+                );
+                blockChanged = true;
+                continue;
+            }
+
+            this->transfer(*i, live);
+            kept.push_back(*i);
+        }
+
+        // The code generator expects every block to hold an instruction, and
+        // the entry block can not be removed.
+        if (kept.empty() && !insts.empty() &&
+            bb == this->cfg->getEntryBlock()) {
+                tac_line_t nop = insts.front();
+                nop.new_id();
+                nop.operation = TAC_NOP;
+                nop.argument1 = "";
+                nop.argument2 = "";
+                nop.result = "";
+                kept.push_back(nop);
+            }
+
+        if (blockChanged) {
+            insts.assign(kept.rbegin(), kept.rend());
+            bb->recomputeInstructionInfo();
+            removed = true;
+        }
+    }
+
+    return removed;
+}
+
+void DCE::removeEmptyBlocks() {
+    for (const BBP &bb : this->blocks) {
+        if (!bb->getInstructions().empty()) {
+            continue;
+        }
+
+        if (bb == this->cfg->getEntryBlock()) {
+            continue;
+        }
+
+        // A block without a jump falls through to at most one successor.
+        const std::vector<BBP> succs = bb->getSuccessors();
+        ASSERT(succs.size() <= 1);
+
+        INFO_LOG("Removing empty block %s", bb->id_to_string().c_str());
+
+        const std::vector<BBP> preds = bb->getPredecessors();
+        for (const BBP &pred : preds) {
+            pred->removeSuccessor(bb);
+            for (const BBP &succ : succs) {
+                pred->insertSuccessor(succ);
+                succ->insertPredecessor(pred);
+            }
+        }
+        for (const BBP &succ : succs) {
+            succ->removePredecessor(bb);
+        }
+        bb->clearSuccessors();
+        bb->clearPredecessors();
+
+        this->allBlocks.erase(bb);
+    }
+}
+
+void DCE::transfer(
+    const tac_line_t &inst,
+    std::set<std::string> &live
+) const {
+    const std::string def = getDefinition(inst, this->addresses);
+    if (def != "") {
+        live.erase(def);
+    }
+
+    for (const std::string &use : getUses(inst, this->addresses)) {
+        if (use != "") {
+            live.insert(use);
+        }
+    }
+
+    // The called procedure may read any variable.
+    if (inst.operation == TAC_CALL) {
+        live.insert(this->variables.begin(), this->variables.end());
+    }
+    // The caller may read any variable the procedure does not declare.
+    else if (inst.operation == TAC_EXIT_PROC) {
+        live.insert(this->nonLocals.begin(), this->nonLocals.end());
+    }
+}
+
+std::set<std::string> DCE::getLiveOut(const BBP block) const {
+    std::set<std::string> live;
+    for (const BBP &succ : block->getSuccessors()) {
+        if (this->liveIn.count(succ)) {
+            const std::set<std::string> &in = this->liveIn.at(succ);
+            live.insert(in.begin(), in.end());
+        }
+    }
+    return live;
+}
@@ -1,9 +1,11 @@
 #include <optimizer/dominator.h>
 
 #include <optimizer/cfg.h>
+#include <optimizer/block_types.h>
 #include <algorithm>
 #include <assertions.h>
 #include <logging.h>
+#include <timer.h>
 
 Dominator::Dominator() {}
 
@@ -19,6 +21,61 @@ bool Dominator::dominates(const BBP a, const BBP b) const {
     return this->properlyDominates(a, b);
 }
 
+BBP Dominator::getImmediateDominator(const BBP node) const {
+    return this->getNode(node);
+}
+
+std::map<BBP, std::vector<BBP>> Dominator::computeDominatorTreeChildren() const {
+    std::map<BBP, std::vector<BBP>> children;
+
+    // Children are ordered by the layout of the blocks for determinism.
+    std::vector<BBP> nodes;
+    for (const auto &p : this->iDoms) {
+        nodes.push_back(p.first);
+    }
+    std::sort(nodes.begin(), nodes.end(), bb_cmp);
+
+    for (const BBP &node : nodes) {
+        children[node];
+        const BBP idom = this->iDoms.at(node);
+        if (idom != node) {
+            children[idom].push_back(node);
+        }
+    }
+
+    return children;
+}
+
+// This code is based on the algorithm described in the following paper:
+// https://www.cs.rice.edu/~keith/Embed/dom.pdf
+std::map<BBP, std::set<BBP>> Dominator::computeDominanceFrontiers() const {
+    std::map<BBP, std::set<BBP>> frontiers;
+
+    for (const auto &p : this->iDoms) {
+        frontiers[p.first];
+    }
+
+    for (const auto &p : this->iDoms) {
+        const BBP b = p.first;
+        const std::vector<BBP> &preds = b->getPredecessors();
+        if (preds.size() < 2) {
+            continue;
+        }
+
+        for (const BBP &pred : preds) {
+            // Unreachable predecessors are not part of the tree.
+            BBP runner = pred;
+            while (runner != nullptr && runner != p.second) {
+                frontiers[runner].insert(b);
+                const BBP next = this->getNode(runner);
+                runner = next != runner ? next : nullptr;
+            }
+        }
+    }
+
+    return frontiers;
+}
+
 std::string Dominator::to_graph() {
     std::string result = "Dominator tree for " + this->cfg->getName() + ":\n";
     this->cfg->performPostorderTraversal([this, &result](BBP block) {
@@ -47,17 +104,20 @@ bool Dominator::properlyDominates(const BBP a, const BBP b) const {
         return true;
     }
 
+    // Blocks unreachable from the entry are not in the tree.
     BBP idom = this->getNode(b);
-    while (idom != a && idom != this->cfg->getEntryBlock()) {
-        idom = this->getNode(idom);
-    }
+    while (idom != nullptr && idom != a && 
+        idom != this->cfg->getEntryBlock()) {
+            idom = this->getNode(idom);
+        }
 
-    return idom != this->cfg->getEntryBlock();
+    return idom == a;
 }
 
 // This code is based on the algorithm described in the following paper:
 // https://www.cs.rice.edu/~keith/Embed/dom.pdf
 void Dominator::buildDominatorTree() {
+    ScopedTimer timer("Dominator::buildDominatorTree");
     BBP entryBlock = this->cfg->getEntryBlock();
 
     // Collect the nodes in postorder.
@@ -78,15 +138,18 @@ void Dominator::buildDominatorTree() {
             if (BBP b = *i) {
                 if (b->getPredecessors().size() == 0) continue;
                 // Compute the immediate dominance of b.
+                // Start from the first predecessor that has already been 
+                // processed, which need not be the first in the list.
                 std::vector<BBP> preds = b->getPredecessors();
-                BBP new_idiom = *preds.begin();
-                ASSERT(new_idiom != nullptr);
-                for (auto p = ++preds.begin(); p != preds.end(); p++) {
+                BBP new_idiom = nullptr;
+                for (auto p = preds.begin(); p != preds.end(); p++) {
                     // If the dominace of p is already calculated.
                     if (this->iDoms.count(*p) != 0 && this->iDoms[*p] != nullptr) {
-                        new_idiom = this->intersect(*p, new_idiom, pov);
+                        new_idiom = new_idiom == nullptr ? *p :
+                            this->intersect(*p, new_idiom, pov);
                     }
                 }
+                if (new_idiom == nullptr) continue;
                 if (this->iDoms[b] != new_idiom) {
                     this->iDoms[b] = new_idiom;
                     changed = true;
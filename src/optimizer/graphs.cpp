@@ -1,9 +1,11 @@
 #include <optimizer/graphs.h>
 
 #include <algorithm>
+#include <cstdio>
+#include <timer.h>
 
-Graphs::Graphs(BlockSet &blocks) {
-    this->constructCFGs(blocks);
+Graphs::Graphs(BlockSet &blocks, ThreadPool &pool) {
+    this->constructCFGs(blocks, pool);
 }
 
 CFG &Graphs::getEntry() {
@@ -14,16 +16,36 @@ std::vector<CFG> &Graphs::getProcedures() {
     return this->procedures;
 }
 
-void Graphs::constructCFGs(BlockSet &blocks) {
+std::vector<CFG *> Graphs::getAllGraphs() {
+    std::vector<CFG *> graphs = { &this->entry };
+    for (CFG &procedure : this->procedures) {
+        graphs.push_back(&procedure);
+    }
+    return graphs;
+}
+
+void Graphs::constructCFGs(BlockSet &blocks, ThreadPool &pool) {
     BBP entryBlock = *blocks.begin();
-    std::string entry = "entry";
-    this->entry = CFG(blocks, entry, entryBlock);
+    this->entry = CFG("entry", entryBlock);
 
-    std::for_each(++blocks.begin(), blocks.end(), [&blocks, this](BBP block) {
+    std::for_each(++blocks.begin(), blocks.end(), [this](BBP block) {
         if (block->getHasEnterProcedure()) {
             // From the structure of the 3AC.
             std::string proc_name = block->getInstructions().at(0).argument1;
-            this->procedures.push_back(CFG(blocks, proc_name, block));
+            this->procedures.push_back(CFG(proc_name, block));
         }
     });
+
+    // The graphs are described in parallel and printed in order.
+    std::vector<CFG *> graphs = this->getAllGraphs();
+    std::vector<std::string> reports(graphs.size());
+    const unsigned int depth = ScopedTimer::getDepth();
+    pool.run(graphs.size(), [&graphs, &reports, &blocks, depth](size_t i) {
+        ScopedTimer::setDepth(depth);
+        reports[i] = graphs[i]->to_report(blocks);
+    });
+
+    for (const std::string &report : reports) {
+        printf("%s", report.c_str());
+    }
 }
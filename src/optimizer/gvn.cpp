@@ -0,0 +1,270 @@
+#include <optimizer/gvn.h>
+
+#include <optimizer/cfg.h>
+
+#include <algorithm>
+#include <assertions.h>
+#include <logging.h>
+
+/**
+ * @param inst The current instruction.
+ * @param addresses Temporaries that hold the address of an array element.
+ * @return True if the instruction stores through an address.
+ */
+static bool isStore(
+    const tac_line_t &inst,
+    const std::set<std::string> &addresses
+) {
+    return inst.operation == TAC_ASSIGN && addresses.count(inst.result) > 0;
+}
+
+/**
+ * @param inst The current instruction.
+ * @param addresses Temporaries that hold the address of an array element.
+ * @return The name the instruction defines a value for, or nullptr if there
+ * is no such name. Unlike scalar definitions, this includes addresses.
+ */
+static Symbol *getValueDefinition(
+    tac_line_t &inst,
+    const std::set<std::string> &addresses
+) {
+    if (inst.operation == TAC_ARRAY_INDEX) {
+        return &inst.result;
+    }
+    if (isStore(inst, addresses)) {
+        return nullptr;
+    }
+    return SSA::getDefinition(inst);
+}
+
+GVN::GVN(CFG *cfg, SSA &ssa, const Dominator *dominator)
+: cfg(cfg), ssa(ssa), dominator(dominator), changed(false) {
+    std::vector<BBP> blocks;
+    cfg->performPostorderTraversal([&blocks](BBP block) {
+        blocks.push_back(block);
+    });
+
+    for (const BBP &bb : blocks) {
+        for (const tac_line_t &inst : bb->getInstructions()) {
+            if (inst.operation == TAC_ARRAY_INDEX) {
+                this->addresses.insert(inst.result);
+            }
+        }
+    }
+
+    std::map<std::string, unsigned int> definitions;
+    for (const BBP &bb : blocks) {
+        for (tac_line_t &inst : bb->getInstructions()) {
+            Symbol *def = getValueDefinition(inst, this->addresses);
+            if (def != nullptr && !tac_line_t::is_user_defined_var(*def)) {
+                definitions[*def]++;
+            }
+        }
+    }
+
+    for (const auto &p : definitions) {
+        if (p.second == 1) {
+            this->temporaries.insert(p.first);
+        }
+    }
+}
+
+bool GVN::eliminate() {
+    this->eliminateInBlock(
+        this->cfg->getEntryBlock(),
+        this->dominator->computeDominatorTreeChildren()
+    );
+    return this->changed;
+}
+
+void GVN::eliminateInBlock(
+    const BBP block,
+    const std::map<BBP, std::vector<BBP>> &children
+) {
+    // Expressions made available by this block, and the names they shadow.
+    std::vector<std::pair<std::string, std::string>> shadowed;
+    auto makeAvailable = [this, &shadowed](
+        const std::string &key,
+        const std::string &name
+    ) {
+        shadowed.push_back(std::make_pair(key,
+            this->available.count(key) ? this->available.at(key) : ""));
+        this->available[key] = name;
+    };
+
+    std::map<BBP, std::vector<phi_function_t>> &phis
+        = this->ssa.getPhiFunctions();
+    if (phis.count(block)) {
+        for (const phi_function_t &phi : phis.at(block)) {
+            this->valueNumbers[phi.result] = phi.result;
+        }
+    }
+
+    // Temporaries removed from the block and the names that replace them.
+    std::map<std::string, std::string> replaced;
+    std::vector<tac_line_t> insts;
+    bool blockChanged = false;
+
+    for (tac_line_t inst : block->getInstructions()) {
+        for (Symbol *field :
+            {&inst.result, &inst.argument1, &inst.argument2}) {
+                if (replaced.count(*field)) {
+                    *field = replaced.at(*field);
+                }
+            }
+
+        Symbol *def = getValueDefinition(inst, this->addresses);
+        if (def == nullptr || !this->isValue(*def)) {
+            insts.push_back(inst);
+            continue;
+        }
+
+        const std::string name = *def;
+        this->definingBlocks[name] = block;
+
+        // Copies hold the value of their source.
+        if (inst.operation == TAC_ASSIGN && inst.argument2 == "") {
+            const std::string number
+                = this->getValueNumber(inst, inst.argument1);
+            this->valueNumbers[name] = number != "" ? number : name;
+            insts.push_back(inst);
+            continue;
+        }
+
+        const std::string key = this->getExpressionKey(inst);
+        if (key == "" || !this->available.count(key) ||
+            !this->isAvailable(this->available.at(key), block)) {
+                this->valueNumbers[name] = name;
+                if (key != "") {
+                    makeAvailable(key, name);
+                }
+                insts.push_back(inst);
+                continue;
+            }
+
+        const std::string leader = this->available.at(key);
+        this->valueNumbers[name] = this->valueNumbers.at(leader);
+        blockChanged = true;
+
+        INFO_LOG(
+            "Reusing %s for %s in %s",
+            leader.c_str(), name.c_str(), block->id_to_string().c_str()
+        );
+
+        // A temporary is replaced outright, as it is only used in its block.
+        if (!tac_line_t::is_user_defined_var(name) &&
+            !tac_line_t::is_user_defined_var(leader)) {
+                replaced[name] = leader;
+                continue;
+            }
+
+        inst.operation = TAC_ASSIGN;
+        inst.argument1 = leader;
+        inst.argument2 = "";
+        insts.push_back(inst);
+
+        // Unlike the temporary, the version may be reused in other blocks.
+        if (tac_line_t::is_user_defined_var(name) &&
+            !tac_line_t::is_user_defined_var(leader)) {
+                makeAvailable(key, name);
+            }
+    }
+
+    if (blockChanged) {
+        block->getInstructions() = insts;
+        block->recomputeInstructionInfo();
+        this->changed = true;
+    }
+
+    if (children.count(block)) {
+        for (const BBP &child : children.at(block)) {
+            this->eliminateInBlock(child, children);
+        }
+    }
+
+    for (auto i = shadowed.rbegin(); i != shadowed.rend(); i++) {
+        if (i->second == "") {
+            this->available.erase(i->first);
+        } else {
+            this->available[i->first] = i->second;
+        }
+    }
+}
+
+std::string GVN::getValueNumber(
+    const tac_line_t &inst,
+    const std::string &operand
+) const {
+    int64_t constant;
+    if (inst.get_constant_value(operand, constant)) {
+        return std::to_string(constant);
+    }
+
+    // Using an address as an operand loads the element, which may change.
+    if (this->addresses.count(operand)) {
+        return "";
+    }
+
+    if (this->valueNumbers.count(operand)) {
+        return this->valueNumbers.at(operand);
+    }
+
+    // The value a variable holds before the graph is entered.
+    if (this->ssa.isRenamed(operand)) {
+        return operand;
+    }
+
+    return "";
+}
+
+std::string GVN::getExpressionKey(const tac_line_t &inst) const {
+    std::string lhs;
+    std::string rhs;
+
+    switch (inst.operation) {
+        case TAC_ARRAY_INDEX: {
+            // The address of an array does not change.
+            unsigned int level;
+            st_entry_t entry;
+            if (!inst.table->lookup(inst.argument1, &level, &entry) ||
+                entry.entry_type != ST_VARIABLE || !entry.variable.isArray) {
+                    return "";
+                }
+            lhs = inst.argument1;
+            rhs = this->getValueNumber(inst, inst.argument2);
+            break;
+        }
+        case TAC_NEGATE:
+            lhs = this->getValueNumber(inst, inst.argument1);
+            rhs = "-";
+            break;
+        case TAC_ADD ... TAC_MULT:
+            lhs = this->getValueNumber(inst, inst.argument1);
+            rhs = this->getValueNumber(inst, inst.argument2);
+            if ((inst.operation == TAC_ADD || inst.operation == TAC_MULT) &&
+                rhs < lhs) {
+                    std::swap(lhs, rhs);
+                }
+            break;
+        default:
+            return "";
+    }
+
+    if (lhs == "" || rhs == "") {
+        return "";
+    }
+
+    return std::to_string(inst.operation) + "(" + lhs + ", " + rhs + ")";
+}
+
+bool GVN::isValue(const std::string &name) const {
+    if (this->ssa.isRenamed(name)) {
+        return this->ssa.getVariable(name) != name;
+    }
+    return this->temporaries.count(name) > 0;
+}
+
+bool GVN::isAvailable(const std::string &leader, const BBP block) const {
+    return tac_line_t::is_user_defined_var(leader) ||
+        this->definingBlocks.at(leader) == block;
+}
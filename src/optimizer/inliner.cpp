@@ -0,0 +1,398 @@
+#include <optimizer/inliner.h>
+
+#include <algorithm>
+#include <functional>
+#include <assertions.h>
+#include <logging.h>
+
+Inliner::Inliner(std::vector<tac_line_t> &instructions)
+: instructions(instructions),
+    budget(instructions.size() * INLINE_MAX_GROWTH), inlinedCount(0) {
+        this->findSegments();
+        if (this->procedures.empty()) {
+            return;
+        }
+
+        this->findRecursiveProcedures();
+        for (const size_t i : this->findInliningOrder()) {
+            this->inlineCalls(this->segments.at(i));
+        }
+        if (this->inlinedCount == 0) {
+            return;
+        }
+
+        this->removeUncalledProcedures();
+        this->joinSegments();
+    }
+
+void Inliner::findSegments() {
+    segment_t segment = { "", {}, false };
+    for (const tac_line_t &inst : this->instructions) {
+        if (inst.operation == TAC_ENTER_PROC) {
+            if (!segment.code.empty()) {
+                this->segments.push_back(segment);
+            }
+            segment = { inst.argument1, {}, false };
+        }
+
+        segment.code.push_back(inst);
+
+        if (inst.operation == TAC_EXIT_PROC) {
+            this->procedures[segment.procedure] = this->segments.size();
+            this->segments.push_back(segment);
+            segment = { "", {}, false };
+        }
+    }
+
+    if (!segment.code.empty()) {
+        this->segments.push_back(segment);
+    }
+}
+
+void Inliner::findRecursiveProcedures() {
+    for (const auto &procedure : this->procedures) {
+        std::set<std::string> visited;
+        std::vector<std::string> worklist = { procedure.first };
+        while (!worklist.empty()) {
+            const std::string current = worklist.back();
+            worklist.pop_back();
+
+            const auto found = this->procedures.find(current);
+            if (found == this->procedures.end()) {
+                continue;
+            }
+
+            for (const std::string &callee :
+                getCallees(this->segments.at(found->second))) {
+                    if (callee == procedure.first) {
+                        this->recursive.insert(callee);
+                    }
+                    if (visited.insert(callee).second) {
+                        worklist.push_back(callee);
+                    }
+                }
+        }
+    }
+}
+
+std::vector<size_t> Inliner::findInliningOrder() const {
+    std::vector<size_t> order;
+    std::set<std::string> visited;
+
+    const std::function<void(const std::string &)> visit =
+        [&](const std::string &procedure) {
+            const auto found = this->procedures.find(procedure);
+            if (found == this->procedures.end() ||
+                !visited.insert(procedure).second) {
+                    return;
+                }
+            for (const std::string &callee :
+                getCallees(this->segments.at(found->second))) {
+                    visit(callee);
+                }
+            order.push_back(found->second);
+        };
+
+    for (const auto &procedure : this->procedures) {
+        visit(procedure.first);
+    }
+    for (size_t i = 0; i < this->segments.size(); i++) {
+        if (this->segments.at(i).procedure.empty()) {
+            order.push_back(i);
+        }
+    }
+    return order;
+}
+
+void Inliner::inlineCalls(segment_t &segment) {
+    const std::vector<unsigned int> depths =
+        computeLoopDepths(segment.code);
+
+    std::vector<tac_line_t> code;
+    std::vector<tac_line_t> declarations;
+    std::vector<tac_line_t> arguments;
+    for (size_t i = 0; i < segment.code.size(); i++) {
+        const tac_line_t &inst = segment.code.at(i);
+        if (inst.operation == TAC_PROC_PARAM) {
+            arguments.push_back(inst);
+            continue;
+        }
+
+        if (inst.operation == TAC_CALL &&
+            this->shouldInline(segment, inst, depths.at(i))) {
+                this->inlineCall(inst, arguments, code, declarations);
+            } else {
+                code.insert(code.end(), arguments.begin(), arguments.end());
+                code.push_back(inst);
+            }
+        arguments.clear();
+    }
+
+    // The renamed variables are declared with the variables of the caller,
+    // which are the globals between procedures.
+    if (segment.procedure.empty()) {
+        this->globals.insert(this->globals.end(),
+            declarations.begin(), declarations.end());
+    } else {
+        ASSERT(code.size() >= 2 && code.at(1).operation == TAC_LABEL);
+        code.insert(code.begin() + 2,
+            declarations.begin(), declarations.end());
+    }
+    segment.code = code;
+}
+
+bool Inliner::shouldInline(
+    const segment_t &segment,
+    const tac_line_t &call,
+    const unsigned int depth
+) const {
+    const std::string callee = getCallee(call);
+    const auto found = this->procedures.find(callee);
+    if (found == this->procedures.end() || this->recursive.count(callee)) {
+        return false;
+    }
+
+    // Calls in loops run more often, so larger procedures are worth the
+    // code they add there.
+    const std::vector<tac_line_t> &code = this->segments.at(found->second).code;
+    const unsigned int size = getBodySize(code);
+    const unsigned int limit = INLINE_MAX_INSTRUCTIONS *
+        (1 + std::min(depth, (unsigned int) INLINE_MAX_LOOP_DEPTH));
+    if (size > limit || size > this->budget) {
+        return false;
+    }
+
+    // The globals of the procedure must not be hidden by the variables of
+    // the caller, as variables are told apart by name.
+    for (const tac_line_t &inst : code) {
+        for (const std::string &name :
+            { inst.argument1, inst.argument2, inst.result }) {
+                unsigned int level;
+                st_entry_t entry;
+                if (name.empty() ||
+                    !inst.table->lookup(name, &level, &entry) ||
+                    level != 0 || entry.entry_type != ST_VARIABLE) {
+                        continue;
+                    }
+                if (!call.table->lookup(name, &level, &entry) || level != 0) {
+                    INFO_LOG("Not inlining %s into %s, which hides %s",
+                        callee.c_str(), segment.procedure.c_str(),
+                        name.c_str());
+                    return false;
+                }
+            }
+    }
+
+    return true;
+}
+
+void Inliner::inlineCall(
+    const tac_line_t &call,
+    const std::vector<tac_line_t> &arguments,
+    std::vector<tac_line_t> &out,
+    std::vector<tac_line_t> &declarations
+) {
+    const std::string callee = getCallee(call);
+    segment_t &procedure = this->segments.at(this->procedures.at(callee));
+    const std::vector<tac_line_t> &code = procedure.code;
+
+    unsigned int level;
+    st_entry_t procedureEntry;
+    const bool success = call.table->lookup(callee, &level, &procedureEntry);
+    ASSERT(success);
+    ASSERT(procedureEntry.entry_type == ST_FUNCTION);
+    ASSERT(arguments.size() == procedureEntry.procedure.argumentsLength);
+
+    INFO_LOG("Inlining %s", callee.c_str());
+    this->budget -= getBodySize(code);
+    procedure.inlined = true;
+    const std::string suffix = "I" + std::to_string(this->inlinedCount++);
+
+    // The procedure, its label and its exit are not copied. An empty
+    // procedure has nothing to copy.
+    if (code.size() <= 3) {
+        return;
+    }
+    const std::shared_ptr<SymbolTable> scope = code.at(2).table;
+
+    std::map<std::string, std::string> renamed;
+    const std::function<std::string(
+        const std::string &,
+        const std::shared_ptr<SymbolTable> &
+    )> rename = [&](
+        const std::string &name,
+        const std::shared_ptr<SymbolTable> &table
+    ) {
+        if (name.empty()) {
+            return name;
+        }
+        const auto found = renamed.find(name);
+        if (found != renamed.end()) {
+            return found->second;
+        }
+
+        std::string newName = name;
+        unsigned int level;
+        st_entry_t entry;
+        if (tac_line_t::is_label(name) ||
+            !tac_line_t::is_user_defined_var(name)) {
+                newName = name + suffix;
+            } else if (table->lookup(name, &level, &entry) && level > 0) {
+                // Literals keep their names, but must be found from
+                // the caller as well.
+                if (entry.entry_type == ST_VARIABLE) {
+                    newName = name + "." + suffix;
+
+                    tac_line_t declaration;
+                    declaration.operation = TAC_ASSIGN;
+                    declaration.result = newName;
+                    declaration.table = call.table;
+                    declarations.push_back(declaration);
+                }
+                call.table->insert(newName, entry);
+            }
+
+        renamed[name] = newName;
+        return newName;
+    };
+
+    // Arrays are passed by their address, so the array passed is used in
+    // place of the parameter. Other parameters are copied.
+    for (size_t i = 0; i < arguments.size(); i++) {
+        const std::string parameter =
+            procedureEntry.procedure.argumentNames[i];
+        if (procedureEntry.procedure.argumentIsArray[i]) {
+            renamed[parameter] = arguments.at(i).argument1;
+            continue;
+        }
+
+        tac_line_t copy;
+        copy.operation = TAC_ASSIGN;
+        copy.result = rename(parameter, scope);
+        copy.argument1 = arguments.at(i).argument1;
+        copy.table = call.table;
+        out.push_back(copy);
+    }
+
+    for (size_t i = 2; i + 1 < code.size(); i++) {
+        const tac_line_t &inst = code.at(i);
+
+        // Calls are not made in place of the call, so the value returned
+        // is never read.
+        if (inst.operation == TAC_RETVAL) {
+            continue;
+        }
+
+        // The variables are declared with the variables of the caller.
+        if (inst.operation == TAC_ASSIGN && !inst.result.empty() &&
+            inst.argument1.empty()) {
+                rename(inst.result, inst.table);
+                continue;
+            }
+
+        tac_line_t copy = inst;
+        copy.new_id();
+        copy.table = call.table;
+        if (inst.operation != TAC_CALL) {
+            copy.argument1 = rename(inst.argument1, inst.table);
+        }
+        copy.argument2 = rename(inst.argument2, inst.table);
+        copy.result = rename(inst.result, inst.table);
+        out.push_back(copy);
+    }
+}
+
+void Inliner::removeUncalledProcedures() {
+    bool changed = true;
+    while (changed) {
+        std::set<std::string> called;
+        for (const segment_t &segment : this->segments) {
+            const std::set<std::string> callees = getCallees(segment);
+            called.insert(callees.begin(), callees.end());
+        }
+
+        changed = false;
+        for (auto i = this->segments.begin(); i != this->segments.end();) {
+            if (i->inlined && called.count(i->procedure) == 0) {
+                INFO_LOG("Removing inlined procedure %s",
+                    i->procedure.c_str());
+                i = this->segments.erase(i);
+                changed = true;
+            } else {
+                i++;
+            }
+        }
+    }
+    this->procedures.clear();
+}
+
+void Inliner::joinSegments() {
+    this->instructions = this->globals;
+    for (const segment_t &segment : this->segments) {
+        this->instructions.insert(this->instructions.end(),
+            segment.code.begin(), segment.code.end());
+    }
+}
+
+std::set<std::string> Inliner::getCallees(const segment_t &segment) {
+    std::set<std::string> callees;
+    for (const tac_line_t &inst : segment.code) {
+        if (inst.operation == TAC_CALL) {
+            callees.insert(getCallee(inst));
+        }
+    }
+    return callees;
+}
+
+std::vector<unsigned int> Inliner::computeLoopDepths(
+    const std::vector<tac_line_t> &code
+) {
+    std::map<std::string, size_t> labels;
+    for (size_t i = 0; i < code.size(); i++) {
+        if (code.at(i).operation == TAC_LABEL) {
+            labels[code.at(i).argument1] = i;
+        }
+    }
+
+    // Every jump back to a label closes a loop around the code between.
+    std::vector<unsigned int> depths(code.size(), 0);
+    for (size_t i = 0; i < code.size(); i++) {
+        if (!tac_line_t::transfers_control(code.at(i))) {
+            continue;
+        }
+        const auto target = labels.find(code.at(i).argument1);
+        if (target == labels.end() || target->second > i) {
+            continue;
+        }
+        for (size_t j = target->second; j <= i; j++) {
+            depths.at(j)++;
+        }
+    }
+    return depths;
+}
+
+unsigned int Inliner::getBodySize(const std::vector<tac_line_t> &procedure) {
+    unsigned int size = 0;
+    for (const tac_line_t &inst : procedure) {
+        switch (inst.operation) {
+            case TAC_ENTER_PROC:
+            case TAC_EXIT_PROC:
+            case TAC_RETVAL:
+                break;
+            case TAC_ASSIGN:
+                if (!inst.argument1.empty()) {
+                    size++;
+                }
+                break;
+            default:
+                size++;
+                break;
+        }
+    }
+    // The label of the procedure is not copied.
+    return size - 1;
+}
+
+std::string Inliner::getCallee(const tac_line_t &call) {
+    return tac_line_t::extract_label(call.argument1);
+}
@@ -0,0 +1,133 @@
+#include <optimizer/loop_rotator.h>
+
+#include <assertions.h>
+#include <logging.h>
+
+#define FAIL_MESSAGE "Failed to rotate loop: "
+
+LoopRotator::LoopRotator(NaturalLoop &loop, BlockSet &allBlocks)
+: loop(loop), allBlocks(allBlocks) {
+    this->canRotate = this->checkCanLoopBeRotated();
+}
+
+bool LoopRotator::rotate() {
+    if (!this->canRotate) {
+        return false;
+    }
+
+    INFO_LOG("Rotating loop %s", loop.to_string().c_str());
+
+    const BBP header = this->loop.getHeader();
+    const BBP footer = this->loop.getFooter();
+    const BBP first = this->loopBlocks.at(1);
+    const std::vector<tac_line_t> &headerInsts = header->getInstructions();
+
+    const std::string firstLabel = this->labelFirstBodyBlock();
+
+    // The footer repeats the exit test, staying in the loop while the exit
+    // jump would not be taken.
+    tac_line_t compare = headerInsts.at(headerInsts.size() - 2);
+    compare.new_id();
+
+    tac_line_t jump = headerInsts.back();
+    jump.operation = tac_line_t::invert_conditional_jump(jump.operation);
+    jump.argument1 = firstLabel;
+    jump.new_id();
+
+    std::vector<tac_line_t> &footerInsts = footer->getInstructions();
+    footerInsts.pop_back();
+    footerInsts.push_back(compare);
+    footerInsts.push_back(jump);
+    footer->recomputeInstructionInfo();
+
+    // Footer -> First
+    //        -> Exit
+    footer->removeSuccessor(header);
+    header->removePredecessor(footer);
+
+    footer->insertSuccessor(first);
+    first->insertPredecessor(footer);
+
+    footer->insertSuccessor(this->exit);
+    this->exit->insertPredecessor(footer);
+
+    return true;
+}
+
+bool LoopRotator::checkCanLoopBeRotated() {
+    const BBP header = this->loop.getHeader();
+    const BBP footer = this->loop.getFooter();
+
+    if (!this->loop.getContiguousBlocks(this->loopBlocks) ||
+        this->loopBlocks.size() < 2 || this->loopBlocks.back() != footer) {
+            WARNING_LOG(FAIL_MESSAGE "Loop layout is not supported");
+            return false;
+        }
+
+    // The header may only compute the exit condition, as it is copied.
+    const std::vector<tac_line_t> &insts = header->getInstructions();
+    const size_t length = insts.size();
+    if (length < 3 || insts.front().operation != TAC_LABEL) {
+        WARNING_LOG(FAIL_MESSAGE "Header is not an exit test");
+        return false;
+    }
+    for (size_t i = 0; i < length - 2; i++) {
+        if (insts.at(i).operation != TAC_LABEL) {
+            WARNING_LOG(FAIL_MESSAGE "Header is not an exit test");
+            return false;
+        }
+    }
+
+    const tac_line_t &compare = insts.at(length - 2);
+    const tac_line_t &jump = insts.at(length - 1);
+    if (!tac_line_t::is_comparision(compare) ||
+        tac_line_t::has_result(compare) ||
+        tac_line_t::invert_conditional_jump(jump.operation) == TAC_NOP) {
+            WARNING_LOG(FAIL_MESSAGE "Header is not an exit test");
+            return false;
+        }
+
+    const std::vector<tac_line_t> &footerInsts = footer->getInstructions();
+    if (!footer->blockEndsWithUnconditionalJump() ||
+        footerInsts.back().argument1 != insts.front().argument1) {
+            WARNING_LOG(FAIL_MESSAGE "Footer does not jump to the header");
+            return false;
+        }
+
+    // The exit must directly follow the loop to be reached by falling
+    // through the footer.
+    this->exit = this->allBlocks.getNext(footer);
+    if (this->exit == nullptr) {
+        WARNING_LOG(FAIL_MESSAGE "Exit does not follow the loop");
+        return false;
+    }
+
+    const std::vector<tac_line_t> &exitInsts = this->exit->getInstructions();
+    if (exitInsts.empty() || exitInsts.front().operation != TAC_LABEL ||
+        exitInsts.front().argument1 != jump.argument1) {
+            WARNING_LOG(FAIL_MESSAGE "Exit does not follow the loop");
+            return false;
+        }
+
+    return true;
+}
+
+std::string LoopRotator::labelFirstBodyBlock() {
+    const BBP first = this->loopBlocks.at(1);
+    std::vector<tac_line_t> &insts = first->getInstructions();
+
+    if (!insts.empty() && insts.front().operation == TAC_LABEL) {
+        return insts.front().argument1;
+    }
+
+    // Headers are only rotated once, so the new label is unique.
+    const tac_line_t &headerLabel = this->loop.getHeader()->getFirstLabel();
+    tac_line_t label = headerLabel;
+    label.argument1 = headerLabel.argument1 + "R";
+    label.new_id();
+
+    insts.insert(insts.begin(), label);
+    first->recomputeInstructionInfo();
+
+    return label.argument1;
+}
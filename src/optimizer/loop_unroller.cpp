@@ -0,0 +1,111 @@
+#include <optimizer/loop_unroller.h>
+
+#include <assertions.h>
+#include <logging.h>
+
+#define FAIL_MESSAGE "Failed to fully unroll loop: "
+
+LoopUnroller::LoopUnroller(NaturalLoop &loop, BlockSet &allBlocks)
+: loop(loop), allBlocks(allBlocks), tripCount(0) {
+    this->canUnroll = this->checkCanLoopBeUnrolled();
+}
+
+bool LoopUnroller::unroll() {
+    if (!this->canUnroll) {
+        return false;
+    }
+
+    INFO_LOG(
+        "Fully unrolling loop %s with trip count %u",
+        loop.to_string().c_str(), this->tripCount
+    );
+
+    const BBP header = this->loop.getHeader();
+    const BBP exit = this->loop.getExit();
+    std::vector<tac_line_t> &insts = header->getInstructions();
+
+    // The compare and conditional jump are no longer needed.
+    tac_line_t jump = insts.back();
+    insts.pop_back();
+    insts.pop_back();
+
+    for (unsigned int i = 0; i < this->tripCount; i++) {
+        for (tac_line_t inst : this->body) {
+            inst.new_id();
+            insts.push_back(inst);
+        }
+    }
+
+    // The exit is reached by falling through only if it follows the loop.
+    if (this->allBlocks.getNext(this->loopBlocks.back()) != exit) {
+        jump.operation = TAC_UNCOND_JMP;
+        jump.argument2 = "";
+        jump.new_id();
+        insts.push_back(jump);
+    }
+
+    header->recomputeInstructionInfo();
+
+    // Header -> Exit
+    header->clearSuccessors();
+    header->insertSuccessor(exit);
+    header->removePredecessor(this->loop.getFooter());
+
+    for (size_t i = 1; i < this->loopBlocks.size(); i++) {
+        BBP bb = this->loopBlocks.at(i);
+        bb->clearPredecessors();
+        bb->clearSuccessors();
+        this->allBlocks.erase(bb);
+    }
+
+    return true;
+}
+
+bool LoopUnroller::checkCanLoopBeUnrolled() {
+    if (!this->loop.isSimpleLoop()) {
+        WARNING_LOG(FAIL_MESSAGE "Loop is not simple");
+        return false;
+    }
+
+    if (!this->loop.computeConstantTripCount(
+        FULL_UNROLL_MAX_TRIP_COUNT, this->tripCount)) {
+            WARNING_LOG(FAIL_MESSAGE "Trip count is not a small constant");
+            return false;
+        }
+
+    if (!this->loop.getContiguousBlocks(this->loopBlocks) ||
+        !this->loopBlocks.back()->blockEndsWithUnconditionalJump()) {
+            WARNING_LOG(FAIL_MESSAGE "Loop layout is not supported");
+            return false;
+        }
+
+    // A simple loop body is a chain of blocks, so the body of an iteration
+    // is the instructions of the chain without the labels or back edge.
+    for (size_t i = 1; i < this->loopBlocks.size(); i++) {
+        const std::vector<tac_line_t> &insts
+            = this->loopBlocks.at(i)->getInstructions();
+        for (size_t j = 0; j < insts.size(); j++) {
+            const tac_line_t &inst = insts.at(j);
+            if (inst.operation == TAC_LABEL) {
+                continue;
+            }
+            if (tac_line_t::transfers_control(inst)) {
+                const bool isBackEdge = i == this->loopBlocks.size() - 1 &&
+                    j == insts.size() - 1;
+                if (!isBackEdge) {
+                    WARNING_LOG(FAIL_MESSAGE "Loop body changes control");
+                    return false;
+                }
+                continue;
+            }
+            this->body.push_back(inst);
+        }
+    }
+
+    if (this->tripCount * this->body.size() > FULL_UNROLL_MAX_INSTRUCTIONS) {
+        WARNING_LOG(FAIL_MESSAGE "Unrolled loop is too large");
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,407 @@
+#include <optimizer/loop_unswitcher.h>
+
+#include <algorithm>
+#include <assertions.h>
+#include <logging.h>
+
+#define FAIL_MESSAGE "Failed to unswitch loop: "
+
+thread_local unsigned int LoopUnswitcher::unswitchIdGenerator = 0;
+
+LoopUnswitcher::LoopUnswitcher(NaturalLoop &loop, BlockSet &allBlocks)
+: loop(loop), allBlocks(allBlocks) {
+    this->canUnswitch = this->checkCanLoopBeUnswitched();
+}
+
+void LoopUnswitcher::resetIdGenerators() {
+    LoopUnswitcher::unswitchIdGenerator = 0;
+}
+
+bool LoopUnswitcher::unswitch() {
+    if (!this->canUnswitch) {
+        return false;
+    }
+
+    INFO_LOG("Unswitching loop %s", loop.to_string().c_str());
+
+    this->labelSuffix = "U" + std::to_string(
+        LoopUnswitcher::unswitchIdGenerator++
+    );
+
+    this->cloneLoop();
+    this->insertGuard();
+    this->removeConditionalFromOriginal();
+    this->removeConditionalFromClone();
+
+    this->mergeStraightLineBlocks(this->conditional);
+    this->mergeStraightLineBlocks(this->clones.at(this->conditional));
+
+    return true;
+}
+
+bool LoopUnswitcher::checkCanLoopBeUnswitched() {
+    if (!this->checkLoopLayout()) {
+        WARNING_LOG(FAIL_MESSAGE "Loop layout is not supported");
+        return false;
+    }
+
+    // Procedures may modify any variable, so nothing is invariant.
+    for (const BBP &bb : this->loopBlocks) {
+        if (bb->getHasProcedureCall() || bb->getHasEnterProcedure() ||
+            bb->getHasExitProcedure()) {
+                WARNING_LOG(FAIL_MESSAGE "Loop contains a procedure call");
+                return false;
+            }
+        for (const tac_line_t &inst : bb->getInstructions()) {
+            if (tac_line_t::is_procedure_call(inst)) {
+                WARNING_LOG(FAIL_MESSAGE "Loop contains a procedure call");
+                return false;
+            }
+        }
+    }
+
+    if (!this->findInvariantConditional()) {
+        WARNING_LOG(FAIL_MESSAGE "No invariant conditional");
+        return false;
+    }
+
+    return true;
+}
+
+bool LoopUnswitcher::checkLoopLayout() {
+    const BBP header = this->loop.getHeader();
+
+    // The loop blocks must directly follow the header.
+    if (!this->loop.getContiguousBlocks(this->loopBlocks)) {
+        return false;
+    }
+
+    // The only entrance into the loop must fall through from the preheader.
+    this->preheader = this->allBlocks.getPrevious(header);
+    if (this->preheader == nullptr) {
+        return false;
+    }
+    if (this->loop.getPreheader() != this->preheader) {
+        return false;
+    }
+
+    // The clone is placed after the last block using its major ID, so no
+    // other block may follow with that same ID.
+    const BBP last = this->loopBlocks.back();
+    const BBP next = this->getNextBlock(last);
+    if (!last->blockEndsWithUnconditionalJump() || next == nullptr ||
+        next->getID() == last->getID()) {
+            return false;
+        }
+
+    if (header->getInstructions().empty() ||
+        header->getInstructions().front().operation != TAC_LABEL) {
+            return false;
+        }
+
+    const std::vector<BBP> &after = this->preheader->getSuccessors();
+    if (std::find(after.begin(), after.end(), header) == after.end() ||
+        this->preheader->getID() >= header->getID()) {
+            return false;
+        }
+
+    const std::string &headerLabel = header->getFirstLabel().argument1;
+    for (const tac_line_t &inst : this->preheader->getInstructions()) {
+        if (tac_line_t::transfers_control(inst) &&
+            inst.argument1 == headerLabel) {
+                return false;
+            }
+    }
+
+    for (const BBP &bb : this->loopBlocks) {
+        for (const tac_line_t &inst : bb->getInstructions()) {
+            if (inst.operation == TAC_LABEL) {
+                this->loopLabels.insert(inst.argument1);
+            }
+        }
+    }
+
+    return true;
+}
+
+bool LoopUnswitcher::findInvariantConditional() {
+    auto startsWithLabel = [](const BBP &bb, const std::string &label) {
+        const std::vector<tac_line_t> &insts = bb->getInstructions();
+        return !insts.empty() && insts.front().operation == TAC_LABEL &&
+            insts.front().argument1 == label;
+    };
+
+    // The header holds the loop condition, so it is skipped.
+    for (size_t c = 1; c < this->loopBlocks.size(); c++) {
+        const BBP block = this->loopBlocks.at(c);
+        const std::vector<tac_line_t> &insts = block->getInstructions();
+
+        if (insts.size() < 2) {
+            continue;
+        }
+
+        const tac_line_t &jump = insts.back();
+        const tac_line_t &compare = insts.at(insts.size() - 2);
+        if (!tac_line_t::is_conditional_jump(jump) ||
+            !tac_line_t::is_comparision(compare) ||
+            tac_line_t::has_result(compare)) {
+                continue;
+            }
+
+        size_t t = c + 1;
+        while (t < this->loopBlocks.size() &&
+            !startsWithLabel(this->loopBlocks.at(t), jump.argument1)) {
+                t++;
+            }
+
+        // The jump must skip forward over at least one block.
+        if (t == this->loopBlocks.size() || t == c + 1) {
+            continue;
+        }
+
+        const BBP jumpTarget = this->loopBlocks.at(t);
+        std::set<BBP> regionSet(
+            this->loopBlocks.begin() + c + 1, this->loopBlocks.begin() + t
+        );
+
+        // Control may only enter the region from the conditional and may
+        // only leave the region by reaching the target.
+        bool closed = block->getSuccessors().size() == 2;
+        for (const BBP &bb : regionSet) {
+            for (const BBP &succ : bb->getSuccessors()) {
+                closed = closed &&
+                    (regionSet.count(succ) > 0 || succ == jumpTarget);
+            }
+            for (const BBP &pred : bb->getPredecessors()) {
+                closed = closed &&
+                    (regionSet.count(pred) > 0 || pred == block);
+            }
+        }
+
+        if (!closed) {
+            continue;
+        }
+
+        this->conditional = block;
+        this->hoisted.clear();
+        if (!this->isOperandHoistable(compare.argument1, compare) ||
+            !this->isOperandHoistable(compare.argument2, compare)) {
+                continue;
+            }
+
+        this->target = jumpTarget;
+        this->region = std::vector<BBP>(
+            this->loopBlocks.begin() + c + 1, this->loopBlocks.begin() + t
+        );
+        return true;
+    }
+
+    return false;
+}
+
+bool LoopUnswitcher::isOperandHoistable(
+    const std::string &variable,
+    const tac_line_t &user
+) {
+    if (variable == "" || user.is_operand_constant(variable) ||
+        !this->isDefinedInLoop(variable)) {
+            return true;
+        }
+
+    // Temporaries computed from hoistable operands in the same block as the
+    // conditional may be computed ahead of the loop as well.
+    if (tac_line_t::is_user_defined_var(variable)) {
+        return false;
+    }
+
+    size_t definitions = 0;
+    for (const BBP &bb : this->loopBlocks) {
+        if (!bb->isNeverDefined(variable)) {
+            definitions += bb->getDefChain().at(variable).size();
+        }
+    }
+
+    if (definitions != 1 || this->conditional->isNeverDefined(variable)) {
+        return false;
+    }
+
+    const tac_line_t &definition
+        = this->conditional->getDefChain().at(variable).front();
+
+    // Division is left out since it may trap when hoisted.
+    switch (definition.operation) {
+        case TAC_ASSIGN:
+        case TAC_ADD:
+        case TAC_SUB:
+        case TAC_MULT:
+        case TAC_NEGATE:
+            break;
+        default:
+            return false;
+    }
+
+    if (!this->isOperandHoistable(definition.argument1, definition) ||
+        !this->isOperandHoistable(definition.argument2, definition)) {
+            return false;
+        }
+
+    // Operands are hoisted before their users.
+    if (std::find(this->hoisted.begin(), this->hoisted.end(), definition)
+        == this->hoisted.end()) {
+            this->hoisted.push_back(definition);
+        }
+
+    return true;
+}
+
+bool LoopUnswitcher::isDefinedInLoop(const std::string &variable) const {
+    for (const BBP &bb : this->loopBlocks) {
+        if (!bb->isNeverDefined(variable)) {
+            return true;
+        }
+        for (const tac_line_t &inst : bb->getInstructions()) {
+            if (inst.operation == TAC_READ && inst.argument1 == variable) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void LoopUnswitcher::cloneLoop() {
+    // The clone occurs after the last block of the loop but before the
+    // exit, so the clone shares the major id of the last block.
+    const unsigned int newBlocksMajorId = this->loopBlocks.back()->getID();
+    const std::set<BBP> regionSet(this->region.begin(), this->region.end());
+
+    // The region is not copied, as the clone never executes it. Blocks are
+    // created in layout order so that the minor ids keep that order.
+    std::vector<BBP> copies;
+    for (const BBP &bb : this->loopBlocks) {
+        if (regionSet.count(bb) > 0) {
+            continue;
+        }
+
+        BBP copy = this->allBlocks.create(newBlocksMajorId, bb);
+        copy->clearPredecessors();
+        copy->clearSuccessors();
+        this->clones.insert(std::make_pair(bb, copy));
+        copies.push_back(copy);
+    }
+
+    // Edges inside the loop are redirected to the copies. Edges leaving the
+    // loop remain the same.
+    for (const BBP &bb : this->loopBlocks) {
+        if (regionSet.count(bb) > 0) {
+            continue;
+        }
+
+        BBP copy = this->clones.at(bb);
+        for (const BBP &succ : bb->getSuccessors()) {
+            if (regionSet.count(succ) > 0) {
+                continue;
+            }
+
+            BBP after = this->clones.count(succ) > 0 ?
+                this->clones.at(succ) : succ;
+            copy->insertSuccessor(after);
+            after->insertPredecessor(copy);
+        }
+    }
+
+    for (BBP &copy : copies) {
+        for (tac_line_t &inst : copy->getInstructions()) {
+            if ((tac_line_t::transfers_control(inst) ||
+                inst.operation == TAC_LABEL) &&
+                this->loopLabels.count(inst.argument1) > 0) {
+                    inst.argument1 = this->cloneLabel(inst.argument1);
+                }
+        }
+        this->allBlocks.insert(copy);
+    }
+}
+
+void LoopUnswitcher::insertGuard() {
+    const BBP header = this->loop.getHeader();
+    const BBP headerCopy = this->clones.at(header);
+    const std::vector<tac_line_t> &insts
+        = this->conditional->getInstructions();
+
+    // Placed directly after the preheader.
+    BBP guard = this->allBlocks.create(this->preheader->getID());
+
+    for (tac_line_t inst : this->hoisted) {
+        inst.new_id();
+        guard->insertInstruction(inst);
+    }
+
+    tac_line_t compare = insts.at(insts.size() - 2);
+    compare.new_id();
+    guard->insertInstruction(compare);
+
+    // When the jump is taken, the loop without the region executes.
+    tac_line_t jump = insts.back();
+    jump.new_id();
+    jump.argument1 = headerCopy->getFirstLabel().argument1;
+    guard->insertInstruction(jump);
+
+    // Preheader -> Guard -> Header
+    //                    -> HeaderCopy
+    this->preheader->removeSuccessor(header);
+    this->preheader->insertSuccessor(guard);
+    guard->insertPredecessor(this->preheader);
+
+    header->removePredecessor(this->preheader);
+    header->insertPredecessor(guard);
+    guard->insertSuccessor(header);
+
+    headerCopy->insertPredecessor(guard);
+    guard->insertSuccessor(headerCopy);
+
+    this->allBlocks.insert(guard);
+}
+
+void LoopUnswitcher::removeConditionalFromOriginal() {
+    std::vector<tac_line_t> &insts = this->conditional->getInstructions();
+    insts.pop_back();
+    insts.pop_back();
+    this->conditional->recomputeInstructionInfo();
+
+    // The conditional now falls through into the region.
+    this->conditional->removeSuccessor(this->target);
+    this->target->removePredecessor(this->conditional);
+}
+
+void LoopUnswitcher::removeConditionalFromClone() {
+    // The region was never copied, so the copy already only has the target
+    // as its successor.
+    BBP copy = this->clones.at(this->conditional);
+    std::vector<tac_line_t> &insts = copy->getInstructions();
+    insts.pop_back();
+    insts.pop_back();
+    copy->recomputeInstructionInfo();
+
+    ASSERT(copy->getSuccessors().size() == 1);
+}
+
+void LoopUnswitcher::mergeStraightLineBlocks(BBP start) {
+    BBP current = start;
+    while (current->getSuccessors().size() == 1) {
+        BBP next = current->getSuccessors().front();
+        if (next != this->getNextBlock(current) ||
+            next->getPredecessors().size() != 1) {
+                break;
+            }
+
+        current->mergeWithSuccessor(next);
+        this->allBlocks.erase(next);
+    }
+}
+
+BBP LoopUnswitcher::getNextBlock(const BBP &block) const {
+    return this->allBlocks.getNext(block);
+}
+
+std::string LoopUnswitcher::cloneLabel(const std::string &label) const {
+    return label + this->labelSuffix;
+}
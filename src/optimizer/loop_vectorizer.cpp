@@ -67,14 +67,34 @@ bool LoopVectorizer::isInstructionDependentOnIndex(
     const tac_line_t &inst,
     const induction_variable_t &index
 ) {
-    return isVariableDependentOnIndex(loop, inst.argument2, index) || 
-        isVariableDependentOnIndex(loop, inst.argument1, index);
+    std::set<std::string> visited;
+    return isInstructionDependentOnIndex(loop, inst, index, visited);
+}
+
+bool LoopVectorizer::isInstructionDependentOnIndex(
+    const NaturalLoop &loop,
+    const tac_line_t &inst,
+    const induction_variable_t &index,
+    std::set<std::string> &visited
+) {
+    return isVariableDependentOnIndex(loop, inst.argument2, index, visited) || 
+        isVariableDependentOnIndex(loop, inst.argument1, index, visited);
 }
 
 bool LoopVectorizer::isVariableDependentOnIndex(
     const NaturalLoop &loop,
     const std::string &variable,
     const induction_variable_t &index
+) {
+    std::set<std::string> visited;
+    return isVariableDependentOnIndex(loop, variable, index, visited);
+}
+
+bool LoopVectorizer::isVariableDependentOnIndex(
+    const NaturalLoop &loop,
+    const std::string &variable,
+    const induction_variable_t &index,
+    std::set<std::string> &visited
 ) {
     if (variable == "") {
         return false;
@@ -84,6 +104,10 @@ bool LoopVectorizer::isVariableDependentOnIndex(
         return true;
     }
 
+    if (!visited.insert(variable).second) {
+        return false;
+    }
+
     std::vector<BBP> loopBody;
     loop.forEachBBInBody([&loopBody](BBP bb) {
         loopBody.push_back(bb);
@@ -101,7 +125,7 @@ bool LoopVectorizer::isVariableDependentOnIndex(
                     return true;
                 }
                 return LoopVectorizer::isInstructionDependentOnIndex(
-                    loop, inst, index);
+                    loop, inst, index, visited);
             }
 
         }
@@ -17,10 +17,29 @@ NaturalLoop::NaturalLoop(
 }
 
 void NaturalLoop::forEachBBInBody(std::function<void(BBP)> action) const {
-    // Get the first block in the loop body.
-    BBP current = this->footer;
-    std::set<BBP> visited;
-    this->forEachBBInBodyInternal(current, action, visited);
+    // Depth first search backwards from the footer, which stops at the 
+    // header as it dominates every block in the body.
+    std::vector<bool> visited(this->allBlocks.getArenaSize(), false);
+    std::vector<BBP> stack = { this->footer };
+
+    while (!stack.empty()) {
+        const BBP current = stack.back();
+        stack.pop_back();
+        // The action may create blocks.
+        if (current->getIndex() >= visited.size()) {
+            visited.resize(this->allBlocks.getArenaSize(), false);
+        }
+        if (current == this->header || visited[current->getIndex()]) {
+            continue;
+        }
+
+        action(current);
+        visited[current->getIndex()] = true;
+
+        // Pushed in reverse so that predecessors are visited in order.
+        const std::vector<BBP> &preds = current->getPredecessors();
+        stack.insert(stack.end(), preds.rbegin(), preds.rend());
+    }
 }
 
 /**
@@ -257,20 +276,19 @@ void NaturalLoop::duplicateLoopAfterThisLoop() {
     // LHead -> NewHead -> ... -> NewFoot -> LExit
     std::vector<BBP> copyLoop;
 
-    BBP footerCopy = std::make_shared<BasicBlock>(
+    BBP footerCopy = this->allBlocks.create(
         newBlocksMajorId, this->getFooter()
     );
     footerCopy->clearPredecessors();
     footerCopy->clearSuccessors();
 
-    // NewFoot -> LExit
-    footerCopy->insertSuccessor(exit);
-    exit->clearPredecessors();
-    exit->insertPredecessor(footerCopy);
+    // The exit may be shared with other loops, so only this header is 
+    // detached from it.
+    exit->removePredecessor(this->getHeader());
 
     copyLoop.push_back(footerCopy);
 
-    BBP headerCopy = std::make_shared<BasicBlock>(
+    BBP headerCopy = this->allBlocks.create(
         newBlocksMajorId, this->getHeader()
     );
     headerCopy->clearPredecessors();
@@ -292,7 +310,7 @@ void NaturalLoop::duplicateLoopAfterThisLoop() {
             // Invariant: Footer dominates header implies
             // Invariant: Loops are traversed in backwards order implies
             // Invariant: Each block succeeds/preceeds the other.
-            BBP bodyCopy = std::make_shared<BasicBlock>(
+            BBP bodyCopy = this->allBlocks.create(
                 newBlocksMajorId, body
             );
 
@@ -315,7 +333,6 @@ void NaturalLoop::duplicateLoopAfterThisLoop() {
     this->getHeader()->insertSuccessor(headerCopy);
 
     firstInLoopBody->insertPredecessor(headerCopy);
-    firstInLoopBody->removeSuccessor(exit);
     headerCopy->insertSuccessor(firstInLoopBody);
 
     copyLoop.push_back(headerCopy);
@@ -394,11 +411,145 @@ bool NaturalLoop::isSimpleInductionVariable(const std::string &value) const {
 }
 
 bool NaturalLoop::isNeverDefinedInLoop(const std::string &variable) const {
-    bool assigned = false;
+    bool assigned = !this->header->isNeverDefined(variable);
     this->forEachBBInBody([&assigned, &variable](BBP bb) {
         assigned = assigned || !bb->isNeverDefined(variable);
     });
-    return assigned;
+    return !assigned;
+}
+
+bool NaturalLoop::computeConstantTripCount(
+    const unsigned int limit, 
+    unsigned int &tripCountOut
+) const {
+    induction_variable_t iterator;
+    if (!this->identifyLoopIterator(iterator)) {
+        return false;
+    }
+    const std::string &var = iterator.inductionVar;
+
+    const BBP exit = this->getExit();
+    const BBP preheader = this->getPreheader();
+    if (exit == nullptr || preheader == nullptr) {
+        return false;
+    }
+
+    // The header may only compute the exit condition.
+    const std::vector<tac_line_t> &headerInsts = this->header->getInstructions();
+    const size_t length = headerInsts.size();
+    if (length < 2) {
+        return false;
+    }
+    for (size_t i = 0; i < length - 2; i++) {
+        if (headerInsts.at(i).operation != TAC_LABEL) {
+            return false;
+        }
+    }
+
+    const tac_line_t &compare = headerInsts.at(length - 2);
+    const tac_line_t &jump = headerInsts.at(length - 1);
+    if (!tac_line_t::is_comparision(compare) || 
+        tac_line_t::has_result(compare) ||
+        !tac_line_t::is_conditional_jump(jump)) {
+            return false;
+        }
+
+    const std::vector<tac_line_t> &exitInsts = exit->getInstructions();
+    if (exitInsts.empty() || exitInsts.front().operation != TAC_LABEL ||
+        exitInsts.front().argument1 != jump.argument1) {
+            return false;
+        }
+
+    int64_t bound;
+    const std::string &other = compare.argument1 == var ? 
+        compare.argument2 : compare.argument1;
+    if (other == var || !compare.get_constant_value(other, bound)) {
+        return false;
+    }
+
+    // The iterator must be updated exactly once in every iteration.
+    unsigned int definitions = 0;
+    bool unknownDefinition = false;
+    BBP updateBlock;
+    tac_line_t update;
+    this->forEachBBInBody([&](BBP bb) {
+        for (const tac_line_t &inst : bb->getInstructions()) {
+            if (tac_line_t::is_procedure_call(inst) ||
+                (inst.operation == TAC_READ && inst.argument1 == var)) {
+                    unknownDefinition = true;
+                }
+            if (inst.result == var) {
+                definitions++;
+                updateBlock = bb;
+                update = inst;
+            }
+        }
+    });
+
+    if (unknownDefinition || definitions != 1 || 
+        !this->dom->dominates(updateBlock, this->footer)) {
+            return false;
+        }
+
+    int64_t step;
+    if (!update.get_constant_value(iterator.constant, step)) {
+        return false;
+    }
+    if (update.operation == TAC_SUB) {
+        // C - X is not a step.
+        if (update.argument1 != var) {
+            return false;
+        }
+        step = -step;
+    }
+
+    // The last definition of the iterator in the preheader reaches the loop.
+    int64_t value = 0;
+    bool foundInitial = false;
+    for (const tac_line_t &inst : preheader->getInstructions()) {
+        if (inst.result == var) {
+            foundInitial = inst.operation == TAC_ASSIGN &&
+                inst.get_constant_value(inst.argument1, value);
+        } else if (tac_line_t::is_procedure_call(inst) ||
+            (inst.operation == TAC_READ && inst.argument1 == var)) {
+                foundInitial = false;
+            }
+    }
+
+    if (!foundInitial) {
+        return false;
+    }
+
+    // Simulate the header until the loop is exited.
+    for (unsigned int count = 0; count <= limit; count++) {
+        const int64_t lhs = compare.argument1 == var ? value : bound;
+        const int64_t rhs = compare.argument1 == var ? bound : value;
+        if (tac_line_t::is_jump_taken(jump.operation, lhs, rhs)) {
+            tripCountOut = count;
+            return true;
+        }
+        value += step;
+    }
+
+    return false;
+}
+
+bool NaturalLoop::getContiguousBlocks(std::vector<BBP> &blocksOut) const {
+    std::set<BBP> members = { this->header };
+    this->forEachBBInBody([&members](BBP bb) {
+        members.insert(bb);
+    });
+
+    blocksOut.clear();
+    for (const BBP &bb :
+        this->allBlocks.getBlocksFrom(this->header, members.size())) {
+            if (members.count(bb) == 0) {
+                return false;
+            }
+            blocksOut.push_back(bb);
+        }
+
+    return blocksOut.size() == members.size();
 }
 
 BBP NaturalLoop::getExit() const {
@@ -410,6 +561,24 @@ BBP NaturalLoop::getExit() const {
     return nullptr;
 }
 
+BBP NaturalLoop::getPreheader() const {
+    std::set<BBP> body;
+    this->forEachBBInBody([&body](BBP bb) {
+        body.insert(bb);
+    });
+
+    BBP preheader = nullptr;
+    for (const BBP &pred : this->header->getPredecessors()) {
+        if (body.count(pred) == 0) {
+            if (preheader != nullptr) {
+                return nullptr;
+            }
+            preheader = pred;
+        }
+    }
+    return preheader;
+}
+
 const BBP NaturalLoop::getHeader() const {
     return this->header;
 }
@@ -422,20 +591,3 @@ const std::string NaturalLoop::to_string() const {
     return "(" + std::to_string(this->getHeader()->getID()) + ", " + 
         std::to_string(this->getFooter()->getID()) + ")";
 }
-
-void NaturalLoop::forEachBBInBodyInternal(
-    BBP current, 
-    std::function<void(BBP)> action,
-    std::set<BBP> &visited
-) const {
-    if (current == this->header || visited.count(current) > 0) {
-        return;
-    }
-
-    action(current);
-    visited.insert(current);
-
-    for (BBP pred : current->getPredecessors()) {
-        this->forEachBBInBodyInternal(pred, action, visited);
-    }
-}
@@ -1,11 +1,166 @@
 #include <optimizer/optimizer.h>
 
+#include <climits>
 #include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <assertions.h>
+#include <logging.h>
+#include <timer.h>
+#include <optimizer/loop_unswitcher.h>
+#include <optimizer/ssa.h>
 
-Optimizer::Optimizer(std::vector<tac_line_t> &instructions) 
-: preprocessor(Preprocessor(instructions)), blocker(Blocker(instructions)), 
-    graphs(this->blocker.getBlockSet()) {}
+/**
+ * Inlines small procedures when enabled by -i, or by -O2 unless the passes 
+ * are given by --passes.
+ * @param instructions The code to inline procedures within.
+ * @return The instructions.
+ */
+static std::vector<tac_line_t> &inlineProcedures(
+    std::vector<tac_line_t> &instructions
+) {
+    if (INLINING_ENABLED || 
+        (PASS_PIPELINE == nullptr && OPTIMIZATION_LEVEL >= 2)) {
+            ScopedTimer timer("Inliner");
+            Inliner inliner(instructions);
+        }
+    return instructions;
+}
+
+/**
+ * Turns tail recursion into loops when enabled by -e or -O2, before the 
+ * procedures that no longer call themselves may be inlined.
+ * @param instructions The code to eliminate tail recursion within.
+ * @return The instructions.
+ */
+static std::vector<tac_line_t> &eliminateTailRecursion(
+    std::vector<tac_line_t> &instructions
+) {
+    if (TAIL_CALLS_ENABLED) {
+        ScopedTimer timer("TailRecursionEliminator");
+        TailRecursionEliminator eliminator(instructions);
+    }
+    return instructions;
+}
+
+Optimizer::Optimizer(std::vector<tac_line_t> &instructions, ThreadPool &pool) 
+: pool(pool), preprocessor(Preprocessor(instructions)), 
+    blocker(Blocker(
+        inlineProcedures(eliminateTailRecursion(instructions)))), 
+    graphs(this->blocker.getBlockSet(), this->pool) {
+        if (PASS_PIPELINE != nullptr) {
+            if (!this->passManager.addPipeline(PASS_PIPELINE)) {
+                exit(EXIT_FAILURE);
+            }
+        } else {
+            this->passManager.addDefaultPipeline(OPTIMIZATION_LEVEL);
+        }
+
+        INFO_LOG("Running passes %s", this->passManager.to_string().c_str());
+
+        // The graphs are optimized once they are all built, as they are not 
+        // moved afterwards.
+        this->optimizeGraphs();
+    }
 
 BlockSet &Optimizer::getBlocks() {
     return this->blocker.getBlockSet();
 }
+
+/**
+ * Maps IDs given out from equally sized ranges onto consecutive IDs, in the 
+ * order of the ranges.
+ * @param first The first ID of the first range. Smaller IDs are kept.
+ * @param size The size of each range.
+ * @param used The number of IDs given out from each range.
+ * @return The function from an ID to its new ID.
+ */
+static std::function<unsigned int(unsigned int)> compactRanges(
+    const unsigned int first,
+    const unsigned int size,
+    const std::vector<unsigned int> &used
+) {
+    std::vector<unsigned int> offsets = { first };
+    for (const unsigned int count : used) {
+        offsets.push_back(offsets.back() + count);
+    }
+
+    return [first, size, offsets](const unsigned int id) {
+        if (id < first) {
+            return id;
+        }
+        const unsigned int range = (id - first) / size;
+        return offsets.at(range) + (id - first - range * size);
+    };
+}
+
+void Optimizer::optimizeGraphs() {
+    const std::vector<CFG *> graphs = this->graphs.getAllGraphs();
+    BlockSet &blocks = this->blocker.getBlockSet();
+    const unsigned int depth = ScopedTimer::getDepth();
+
+    if (this->pool.getThreadCount() == 1) {
+        for (CFG *graph : graphs) {
+            SSA::resetIdGenerators();
+            LoopUnswitcher::resetIdGenerators();
+            this->passManager.run(*graph, blocks);
+        }
+        return;
+    }
+
+    // Each graph gives out instruction and block IDs from its own range, 
+    // with the ranges in the order of the graphs, so that the IDs do not 
+    // depend on the thread that optimizes a graph. Instruction IDs stay 
+    // below INT_MAX as the code generator keeps them signed.
+    const TID firstInstructionId = tac_line_t::bid_gen;
+    const unsigned int firstMinorId = BasicBlock::getNextMinorId();
+    ASSERT(firstInstructionId < INT_MAX);
+    const TID instructionIds = 
+        (INT_MAX - firstInstructionId) / (graphs.size() + 1);
+    const unsigned int minorIds = 
+        (UINT_MAX - firstMinorId) / (graphs.size() + 1);
+    std::vector<unsigned int> instructionIdsUsed(graphs.size());
+    std::vector<unsigned int> minorIdsUsed(graphs.size());
+
+    this->pool.run(graphs.size(), [&](size_t i) {
+        const TID instructionId = firstInstructionId + i * instructionIds;
+        const unsigned int minorId = firstMinorId + i * minorIds;
+
+        ScopedTimer::setDepth(depth);
+        tac_line_t::bid_gen = instructionId;
+        BasicBlock::setNextMinorId(minorId);
+        SSA::resetIdGenerators();
+        LoopUnswitcher::resetIdGenerators();
+
+        this->passManager.run(*graphs.at(i), blocks);
+
+        instructionIdsUsed.at(i) = tac_line_t::bid_gen - instructionId;
+        minorIdsUsed.at(i) = BasicBlock::getNextMinorId() - minorId;
+    });
+
+    // Closing the gaps between the ranges gives every instruction and block 
+    // the ID it has when the graphs are optimized one after another.
+    const std::function<unsigned int(unsigned int)> instructionId = 
+        compactRanges(firstInstructionId, instructionIds, instructionIdsUsed);
+    const std::function<unsigned int(unsigned int)> minorId = 
+        compactRanges(firstMinorId, minorIds, minorIdsUsed);
+
+    // The minor IDs order the blocks, so they only change outside the set.
+    const std::vector<BBP> all(blocks.begin(), blocks.end());
+    for (const BBP &bb : all) {
+        blocks.erase(bb);
+    }
+    for (const BBP &bb : all) {
+        bb->setMinorId(minorId(bb->getMinorId()));
+        bb->renumberInstructions(instructionId);
+        blocks.insert(bb);
+    }
+    BasicBlock::renumberGlobalVarDefinitions(instructionId);
+
+    tac_line_t::bid_gen = instructionId(
+        firstInstructionId + graphs.size() * instructionIds
+    );
+    BasicBlock::setNextMinorId(
+        minorId(firstMinorId + graphs.size() * minorIds)
+    );
+}
@@ -0,0 +1,338 @@
+#include <optimizer/pass_manager.h>
+
+#include <optimizer/copy_propagator.h>
+#include <optimizer/dce.h>
+#include <optimizer/gvn.h>
+#include <optimizer/loop_rotator.h>
+#include <optimizer/loop_unroller.h>
+#include <optimizer/loop_unswitcher.h>
+#include <optimizer/loop_vectorizer.h>
+#include <optimizer/sccp.h>
+#include <optimizer/ssa.h>
+
+#include <cstdio>
+#include <sstream>
+#include <assertions.h>
+#include <logging.h>
+#include <timer.h>
+
+// The level of passes that only run when enabled by their flag.
+#define FLAG_ONLY (MAX_OPTIMIZATION_LEVEL + 1)
+
+AnalysisCache::AnalysisCache(CFG *cfg, BlockSet &allBlocks)
+: cfg(cfg), allBlocks(allBlocks), valid(ANALYSIS_NONE) {}
+
+const Dominator &AnalysisCache::getDominator() {
+    if (!(this->valid & ANALYSIS_DOMINATOR)) {
+        this->dominator = Dominator(this->cfg);
+        this->valid |= ANALYSIS_DOMINATOR;
+    }
+    return this->dominator;
+}
+
+const Reach &AnalysisCache::getReach() {
+    if (!(this->valid & ANALYSIS_REACH)) {
+        this->reach = Reach(this->cfg);
+        this->valid |= ANALYSIS_REACH;
+    }
+    return this->reach;
+}
+
+std::vector<NaturalLoop> &AnalysisCache::getLoops() {
+    if (!(this->valid & ANALYSIS_LOOPS)) {
+        this->loops = this->cfg->computeNaturalLoops(
+            this->cfg->computeBackwardsEdges(),
+            &this->getDominator(),
+            &this->getReach(),
+            this->allBlocks
+        );
+        this->valid |= ANALYSIS_LOOPS;
+    }
+    return this->loops;
+}
+
+void AnalysisCache::require(const unsigned int analyses) {
+    if (analyses & ANALYSIS_DOMINATOR) {
+        this->getDominator();
+    }
+    if (analyses & ANALYSIS_REACH) {
+        this->getReach();
+    }
+    if (analyses & ANALYSIS_LOOPS) {
+        this->getLoops();
+    }
+}
+
+void AnalysisCache::invalidate(const unsigned int preserved) {
+    unsigned int kept = preserved;
+    if (!(kept & ANALYSIS_DOMINATOR) || !(kept & ANALYSIS_REACH)) {
+        kept &= ~ANALYSIS_LOOPS;
+    }
+    this->valid &= kept;
+}
+
+PassManager::PassManager() {
+    this->registerDefaultPasses();
+}
+
+void PassManager::registerPass(const pass_t &pass) {
+    ASSERT(!this->passes.count(pass.name));
+    ASSERT((pass.kind == PASS_FUNCTION) == (bool) pass.runOnFunction);
+    ASSERT((pass.kind == PASS_LOOP) == (bool) pass.runOnLoop);
+
+    this->passes[pass.name] = pass;
+    this->order.push_back(pass.name);
+}
+
+void PassManager::addDefaultPipeline(const unsigned int level) {
+    for (const std::string &name : this->order) {
+        const pass_t &pass = this->passes.at(name);
+        if (pass.level <= level || (pass.enabled && *pass.enabled)) {
+            this->pipeline.push_back(name);
+        }
+    }
+}
+
+bool PassManager::addPipeline(const std::string &pipeline) {
+    std::stringstream stream(pipeline);
+    std::string name;
+
+    while (std::getline(stream, name, ',')) {
+        if (!this->passes.count(name)) {
+            ERROR_LOG("unknown pass %s", name.c_str());
+            return false;
+        }
+        this->pipeline.push_back(name);
+    }
+
+    return true;
+}
+
+void PassManager::run(CFG &cfg, BlockSet &allBlocks) const {
+    AnalysisCache analyses(&cfg, allBlocks);
+
+    for (const std::string &name : this->pipeline) {
+        const pass_t &pass = this->passes.at(name);
+
+        bool changed;
+        {
+            ScopedTimer timer("pass " + name);
+            analyses.require(pass.required);
+            changed = this->runPass(pass, cfg, analyses, allBlocks);
+        }
+
+        if (changed) {
+            analyses.invalidate(pass.preserved);
+        }
+
+        INFO_LOG("Ran %s on %s", name.c_str(), cfg.getName().c_str());
+        INFO_LOG("CFG after %s", pass.description.c_str());
+        printf("%s\n\n", cfg.to_graph().c_str());
+    }
+}
+
+std::string PassManager::to_string() const {
+    std::string result;
+    for (const std::string &name : this->pipeline) {
+        result += (result == "" ? "" : ",") + name;
+    }
+    return result;
+}
+
+bool PassManager::runPass(
+    const pass_t &pass,
+    CFG &cfg,
+    AnalysisCache &analyses,
+    BlockSet &allBlocks
+) const {
+    if (pass.kind == PASS_LOOP) {
+        return this->runLoopPass(pass, analyses, allBlocks);
+    }
+    return pass.runOnFunction(cfg, analyses, allBlocks);
+}
+
+bool PassManager::runLoopPass(
+    const pass_t &pass,
+    AnalysisCache &analyses,
+    BlockSet &allBlocks
+) const {
+    const unsigned int budget = pass.budget > 0 ? pass.budget
+        : analyses.getLoops().size();
+    unsigned int transformed = 0;
+    bool changed = true;
+
+    while (changed && transformed < budget) {
+        changed = false;
+
+        for (NaturalLoop &loop : analyses.getLoops()) {
+            if (pass.runOnLoop(loop, allBlocks)) {
+                changed = true;
+                transformed++;
+                break;
+            }
+        }
+
+        // Transformations change the shape of the graph, so the analyses and
+        // loops are computed again before the next loop is considered.
+        if (changed) {
+            analyses.invalidate(pass.preserved);
+        }
+    }
+
+    return transformed > 0;
+}
+
+void PassManager::registerDefaultPasses() {
+    pass_t pass;
+
+    // The scalar optimizations run first, so that the loop transformations
+    // see the bounds and expressions they simplify.
+    pass = pass_t();
+    pass.name = "sccp";
+    pass.description = "constant propagation";
+    pass.kind = PASS_FUNCTION;
+    pass.level = 1;
+    pass.enabled = &SCCP_ENABLED;
+    pass.required = ANALYSIS_DOMINATOR;
+    pass.preserved = ANALYSIS_NONE;
+    pass.runOnFunction = [](
+        CFG &cfg, AnalysisCache &analyses, BlockSet &allBlocks
+    ) {
+        SSA ssa(&cfg, &analyses.getDominator(), allBlocks);
+        SCCP sccp(&cfg, ssa, allBlocks);
+        printf("%s\n", sccp.to_string().c_str());
+        sccp.rewrite();
+        ssa.destruct();
+        return true;
+    };
+    this->registerPass(pass);
+
+    pass = pass_t();
+    pass.name = "gvn";
+    pass.description = "value numbering";
+    pass.kind = PASS_FUNCTION;
+    pass.level = 1;
+    pass.enabled = &GVN_ENABLED;
+    pass.required = ANALYSIS_DOMINATOR;
+    pass.preserved = ANALYSIS_NONE;
+    pass.runOnFunction = [](
+        CFG &cfg, AnalysisCache &analyses, BlockSet &allBlocks
+    ) {
+        SSA ssa(&cfg, &analyses.getDominator(), allBlocks);
+        GVN(&cfg, ssa, &analyses.getDominator()).eliminate();
+        ssa.destruct();
+        return true;
+    };
+    this->registerPass(pass);
+
+    // Runs after SSA destruction, which leaves copies behind.
+    pass = pass_t();
+    pass.name = "copyprop";
+    pass.description = "copy propagation";
+    pass.kind = PASS_FUNCTION;
+    pass.level = 1;
+    pass.enabled = &COPY_PROPAGATION_ENABLED;
+    pass.required = ANALYSIS_NONE;
+    pass.preserved = ANALYSIS_DOMINATOR | ANALYSIS_REACH;
+    pass.runOnFunction = [](CFG &cfg, AnalysisCache &, BlockSet &) {
+        return CopyPropagator(&cfg).propagate();
+    };
+    this->registerPass(pass);
+
+    pass = pass_t();
+    pass.name = "unswitch";
+    pass.description = "unswitching";
+    pass.kind = PASS_LOOP;
+    pass.level = 2;
+    pass.enabled = &LOOP_UNSWITCHING_ENABLED;
+    pass.required = ANALYSIS_LOOPS;
+    pass.preserved = ANALYSIS_NONE;
+    pass.budget = UNSWITCH_BUDGET;
+    pass.runOnLoop = [](NaturalLoop &loop, BlockSet &allBlocks) {
+        return LoopUnswitcher(loop, allBlocks).unswitch();
+    };
+    this->registerPass(pass);
+
+    // Every unroll removes a loop, so each loop is unrolled at most once.
+    pass = pass_t();
+    pass.name = "unroll";
+    pass.description = "full unrolling";
+    pass.kind = PASS_LOOP;
+    pass.level = 2;
+    pass.enabled = &LOOP_UNROLLING_ENABLED;
+    pass.required = ANALYSIS_LOOPS;
+    pass.preserved = ANALYSIS_NONE;
+    pass.runOnLoop = [](NaturalLoop &loop, BlockSet &allBlocks) {
+        return LoopUnroller(loop, allBlocks).unroll();
+    };
+    this->registerPass(pass);
+
+    // The vectorizer does not check the trip count against the vector
+    // width, so it is only run when asked for.
+    pass = pass_t();
+    pass.name = "vectorize";
+    pass.description = "vectorization";
+    pass.kind = PASS_FUNCTION;
+    pass.level = FLAG_ONLY;
+    pass.enabled = &AUTOMATIC_VECTORIZATION_ENABLED;
+    pass.required = ANALYSIS_LOOPS;
+    pass.preserved = ANALYSIS_NONE;
+    pass.runOnFunction = [](CFG &, AnalysisCache &analyses, BlockSet &) {
+        for (NaturalLoop &loop : analyses.getLoops()) {
+            LoopVectorizer(loop).vectorize();
+        }
+        return true;
+    };
+    this->registerPass(pass);
+
+    // Runs after vectorization to remove the scalar code it leaves behind.
+    pass = pass_t();
+    pass.name = "dce";
+    pass.description = "dead code elimination";
+    pass.kind = PASS_FUNCTION;
+    pass.level = 1;
+    pass.enabled = &DCE_ENABLED;
+    pass.required = ANALYSIS_NONE;
+    pass.preserved = ANALYSIS_NONE;
+    pass.runOnFunction = [](CFG &cfg, AnalysisCache &, BlockSet &allBlocks) {
+        return DCE(&cfg, allBlocks).eliminate();
+    };
+    this->registerPass(pass);
+
+    // A rotated loop no longer ends in an unconditional jump, so each loop
+    // is rotated at most once.
+    pass = pass_t();
+    pass.name = "rotate";
+    pass.description = "rotation";
+    pass.kind = PASS_LOOP;
+    pass.level = 2;
+    pass.enabled = &LOOP_ROTATION_ENABLED;
+    pass.required = ANALYSIS_LOOPS;
+    pass.preserved = ANALYSIS_NONE;
+    pass.runOnLoop = [](NaturalLoop &loop, BlockSet &allBlocks) {
+        return LoopRotator(loop, allBlocks).rotate();
+    };
+    this->registerPass(pass);
+
+    pass = pass_t();
+    pass.name = "ssa";
+    pass.description = "SSA destruction";
+    pass.kind = PASS_FUNCTION;
+    pass.level = FLAG_ONLY;
+    pass.enabled = &SSA_ENABLED;
+    pass.required = ANALYSIS_DOMINATOR;
+    pass.preserved = ANALYSIS_NONE;
+    pass.runOnFunction = [](
+        CFG &cfg, AnalysisCache &analyses, BlockSet &allBlocks
+    ) {
+        SSA ssa(&cfg, &analyses.getDominator(), allBlocks);
+
+        INFO_LOG("CFG in SSA form");
+        printf("%s\n", ssa.to_string().c_str());
+        printf("%s\n\n", cfg.to_graph().c_str());
+
+        ssa.destruct();
+        return true;
+    };
+    this->registerPass(pass);
+}
@@ -1,10 +1,12 @@
 #include <optimizer/reach.h>
 
 #include <optimizer/cfg.h>
+#include <optimizer/dataflow.h>
 
 #include <set>
 #include <map>
-#include <algorithm>
+#include <vector>
+#include <timer.h>
 
 Reach::Reach() {}
 
@@ -48,75 +50,50 @@ std::string Reach::to_string() const {
 
 // Algorithm from https://en.wikipedia.org/wiki/Reaching_definition
 void Reach::worklistReaching() {
+    ScopedTimer timer("Reach::worklistReaching");
 
-    std::map<BBP, TIDSet> out;
-    std::map<BBP, TIDSet> in;
-    std::set<BBP> changed;
-
-    // Put all nodes into changed set.
+    // Number the definitions of the graph, so that each set of definitions 
+    // is a bit vector indexed by definition number.
+    std::vector<tac_line_t> definitions;
+    std::map<unsigned int, unsigned int> numbers;
     this->cfg->performPostorderTraversal(
-        [&changed, &out, &in](BBP bb) { 
+        [&definitions, &numbers](BBP bb) {
             bb->computeGenAndKillSets();
-            changed.insert(bb);
-            // Initialize out[n].
-            out.insert(std::make_pair(bb, bb->getGenSet()));
-            // Init in[n] to be empty set.
-            in.insert(std::make_pair(bb, TIDSet()));
+            for (const tac_line_t &def : bb->getGenSet()) {
+                numbers[def.bid] = definitions.size();
+                definitions.push_back(def);
+            }
         }
     );
 
-    while (!changed.empty()) {
-        // Chose a node.
-        BBP n = *changed.rbegin();
-        // Remove it from the change set.
-        changed.erase(n);
-        // Calculate in[n] fom predecessors' out[p].
-        for (
-            auto p = n->getPredecessors().begin(); 
-            p != n->getPredecessors().end(); 
-            p++
-        ) {
-            in[n].merge(out.at(*p));
+    DataflowSolver solver(
+        this->cfg, DATAFLOW_FORWARD, DATAFLOW_UNION, definitions.size()
+    );
+    for (const BBP &bb : solver.getBlocks()) {
+        BitVector gen(definitions.size());
+        BitVector kill(definitions.size());
+        for (const tac_line_t &def : bb->getGenSet()) {
+            gen.set(numbers.at(def.bid));
         }
-        // Save the old out[n].
-        TIDSet oldOut = TIDSet(out[n]);
-        // Update out[n] using transfer function f_n().
-        // out[n] = gen[n] U (in[n] - kill[n])
-        TIDSet result;
-        auto gen = n->getGenSet();
-        auto kill = n->getKillSet();
-        std::set_difference(
-            in.at(n).begin(), in.at(n).end(),
-            kill.begin(), kill.end(),
-            std::inserter(result, result.end())
-        );
-        result.merge(gen);
-        out[n] = result;
-        // Any change to out[n]?
-        if (out[n] != oldOut) {
-            // If yes, put all successors of n into the changed set.
-            for (
-                auto s = n->getSuccessors().begin();
-                s != n->getSuccessors().end();
-                s++
-            ) {
-                changed.insert(*s);
+        // Definitions outside of the graph never reach its blocks.
+        for (const tac_line_t &def : bb->getKillSet()) {
+            if (numbers.count(def.bid)) {
+                kill.set(numbers.at(def.bid));
             }
         }
+        solver.setTransfer(bb, gen, kill);
     }
+    solver.solve();
 
-    for (auto p : in) {
-        std::set<std::string> varNames;
-        for (auto v : p.second) {
-            varNames.insert(v.result);
-        }
-        this->in.insert(std::make_pair(p.first, varNames));
-    }
-    for (auto p : out) {
-        std::set<std::string> varNames;
-        for (auto v : p.second) {
-            varNames.insert(v.result);
-        }
-        this->out.insert(std::make_pair(p.first, varNames));
+    for (const BBP &bb : solver.getBlocks()) {
+        std::set<std::string> &in = this->in[bb];
+        solver.getIn(bb).forEach([&definitions, &in](size_t number) {
+            in.insert(definitions[number].result);
+        });
+
+        std::set<std::string> &out = this->out[bb];
+        solver.getOut(bb).forEach([&definitions, &out](size_t number) {
+            out.insert(definitions[number].result);
+        });
     }
-}
\ No newline at end of file
+}
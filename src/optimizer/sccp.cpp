@@ -0,0 +1,510 @@
+#include <optimizer/sccp.h>
+
+#include <optimizer/cfg.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <assertions.h>
+#include <logging.h>
+
+// The index recorded for uses of a name by the phi-functions of a block.
+#define PHI_FUNCTION_INDEX SIZE_MAX
+
+static const lattice_value_t TOP = { LATTICE_TOP, 0 };
+static const lattice_value_t BOTTOM = { LATTICE_BOTTOM, 0 };
+
+/**
+ * @param constant The constant value.
+ * @return The lattice value of the constant.
+ */
+static lattice_value_t makeConstant(const int64_t constant) {
+    return { LATTICE_CONSTANT, constant };
+}
+
+/**
+ * @param a The first value.
+ * @param b The second value.
+ * @return The greatest value that is no higher than both values.
+ */
+static lattice_value_t meet(const lattice_value_t &a, const lattice_value_t &b) {
+    if (a.height == LATTICE_TOP) {
+        return b;
+    }
+    if (b.height == LATTICE_TOP) {
+        return a;
+    }
+    if (a.height == LATTICE_BOTTOM || b.height == LATTICE_BOTTOM ||
+        a.constant != b.constant) {
+            return BOTTOM;
+        }
+    return a;
+}
+
+/**
+ * Folds a binary operation on constants the same way the generated code
+ * evaluates it, so arithmetic wraps around on overflow.
+ * @param operation The arithmetic operation.
+ * @param lhs The first operand.
+ * @param rhs The second operand.
+ * @return The folded value, or bottom if the operation would trap.
+ */
+static lattice_value_t fold(
+    const tac_op_t operation,
+    const int64_t lhs,
+    const int64_t rhs
+) {
+    const uint64_t a = static_cast<uint64_t>(lhs);
+    const uint64_t b = static_cast<uint64_t>(rhs);
+
+    switch (operation) {
+        case TAC_ADD:
+            return makeConstant(static_cast<int64_t>(a + b));
+        case TAC_SUB:
+            return makeConstant(static_cast<int64_t>(a - b));
+        case TAC_MULT:
+            return makeConstant(static_cast<int64_t>(a * b));
+        case TAC_DIV:
+            if (rhs == 0 || (lhs == INT64_MIN && rhs == -1)) {
+                return BOTTOM;
+            }
+            return makeConstant(lhs / rhs);
+        default:
+            break;
+    }
+    return BOTTOM;
+}
+
+/**
+ * @param block The current block.
+ * @return True if the block ends in a compare followed by a conditional jump
+ * on the result of the compare.
+ */
+static bool endsWithCompareAndJump(const BBP block) {
+    const std::vector<tac_line_t> &insts = block->getInstructions();
+    if (insts.size() < 2) {
+        return false;
+    }
+
+    const tac_line_t &compare = insts.at(insts.size() - 2);
+    return tac_line_t::is_comparision(compare) &&
+        !tac_line_t::has_result(compare) &&
+        tac_line_t::invert_conditional_jump(insts.back().operation) != TAC_NOP;
+}
+
+SCCP::SCCP(CFG *cfg, SSA &ssa, BlockSet &allBlocks)
+: cfg(cfg), ssa(ssa), allBlocks(allBlocks) {
+    cfg->performPostorderTraversal([this](BBP block) {
+        this->blocks.push_back(block);
+    });
+    std::sort(this->blocks.begin(), this->blocks.end(), bb_cmp);
+
+    this->propagate();
+}
+
+bool SCCP::rewrite() {
+    bool changed = false;
+
+    for (const BBP &bb : this->blocks) {
+        if (this->executableBlocks.count(bb)) {
+            changed |= this->resolveConditionalJump(bb);
+            changed |= this->replaceConstants(bb);
+        }
+    }
+
+    changed |= this->removeUnreachableBlocks();
+    return changed;
+}
+
+std::string SCCP::to_string() const {
+    std::string result = "Constants for " + this->cfg->getName() + ":\n";
+    for (const auto &p : this->values) {
+        if (p.second.height == LATTICE_CONSTANT) {
+            result += p.first + " = " + std::to_string(p.second.constant) +
+                "\n";
+        }
+    }
+    return result;
+}
+
+void SCCP::propagate() {
+    std::map<std::string, unsigned int> temporaryDefinitions;
+    for (const BBP &bb : this->blocks) {
+        for (tac_line_t &inst : bb->getInstructions()) {
+            Symbol *def = SSA::getDefinition(inst);
+            if (def != nullptr && !tac_line_t::is_user_defined_var(*def)) {
+                temporaryDefinitions[*def]++;
+            }
+        }
+    }
+
+    // Versions of integer variables and temporaries holding arithmetic are
+    // tracked, every other name is never a constant.
+    for (const BBP &bb : this->blocks) {
+        if (this->ssa.getPhiFunctions().count(bb)) {
+            for (const phi_function_t &phi : this->ssa.getPhiFunctions().at(bb)) {
+                this->values[phi.result] = TOP;
+                for (const auto &argument : phi.arguments) {
+                    this->uses[argument.second].push_back(
+                        std::make_pair(bb, PHI_FUNCTION_INDEX)
+                    );
+                }
+            }
+        }
+
+        std::vector<tac_line_t> &insts = bb->getInstructions();
+        for (size_t i = 0; i < insts.size(); i++) {
+            tac_line_t &inst = insts.at(i);
+            for (Symbol *use : SSA::getUses(inst)) {
+                this->uses[*use].push_back(std::make_pair(bb, i));
+            }
+
+            Symbol *def = SSA::getDefinition(inst);
+            if (def == nullptr) {
+                continue;
+            }
+
+            if (this->ssa.isRenamed(*def)) {
+                const std::string &variable = this->ssa.getVariable(*def);
+                unsigned int level;
+                st_entry_t entry;
+                if (*def != variable &&
+                    inst.table->lookup(variable, &level, &entry) &&
+                    entry.variable.type == INT) {
+                        this->values[*def] = TOP;
+                    }
+            } else if (!tac_line_t::is_user_defined_var(*def) &&
+                temporaryDefinitions.at(*def) == 1 &&
+                (inst.operation == TAC_NEGATE ||
+                (inst.operation >= TAC_ADD && inst.operation <= TAC_MULT))) {
+                    this->values[*def] = TOP;
+                }
+        }
+    }
+
+    this->edgeWorklist.push_back(
+        std::make_pair(nullptr, this->cfg->getEntryBlock())
+    );
+
+    while (!this->edgeWorklist.empty() || !this->nameWorklist.empty()) {
+        if (!this->edgeWorklist.empty()) {
+            const std::pair<BBP, BBP> edge = this->edgeWorklist.back();
+            this->edgeWorklist.pop_back();
+            this->visitEdge(edge.first, edge.second);
+            continue;
+        }
+
+        const std::string name = this->nameWorklist.back();
+        this->nameWorklist.pop_back();
+        if (!this->uses.count(name)) {
+            continue;
+        }
+
+        for (const std::pair<BBP, size_t> &use : this->uses.at(name)) {
+            const BBP block = use.first;
+            if (!this->executableBlocks.count(block)) {
+                continue;
+            }
+
+            if (use.second == PHI_FUNCTION_INDEX) {
+                this->visitPhiFunctions(block);
+                continue;
+            }
+
+            this->visitInstruction(block, use.second);
+            if (use.second + 2 >= block->getInstructions().size()) {
+                this->visitTerminator(block);
+            }
+        }
+    }
+}
+
+void SCCP::visitEdge(const BBP pred, const BBP succ) {
+    if (!this->executableEdges.insert(std::make_pair(pred, succ)).second) {
+        return;
+    }
+
+    this->visitPhiFunctions(succ);
+
+    // The instructions of a block are only evaluated again when one of their
+    // operands changes.
+    if (!this->executableBlocks.insert(succ).second) {
+        return;
+    }
+
+    for (size_t i = 0; i < succ->getInstructions().size(); i++) {
+        this->visitInstruction(succ, i);
+    }
+    this->visitTerminator(succ);
+}
+
+void SCCP::visitPhiFunctions(const BBP block) {
+    if (!this->ssa.getPhiFunctions().count(block)) {
+        return;
+    }
+
+    for (const phi_function_t &phi : this->ssa.getPhiFunctions().at(block)) {
+        // Only values flowing in along edges that may be taken are merged.
+        lattice_value_t value = TOP;
+        for (const auto &argument : phi.arguments) {
+            if (!this->isExecutable(argument.first, block)) {
+                continue;
+            }
+            value = meet(value, this->values.count(argument.second) ?
+                this->values.at(argument.second) : BOTTOM);
+        }
+        this->lowerValue(phi.result, value);
+    }
+}
+
+void SCCP::visitInstruction(const BBP block, const size_t index) {
+    tac_line_t &inst = block->getInstructions().at(index);
+    Symbol *def = SSA::getDefinition(inst);
+    if (def == nullptr || !this->values.count(*def)) {
+        return;
+    }
+
+    this->lowerValue(*def, this->evaluate(inst));
+}
+
+void SCCP::visitTerminator(const BBP block) {
+    const std::vector<BBP> &succs = block->getSuccessors();
+
+    if (!endsWithCompareAndJump(block)) {
+        for (const BBP &succ : succs) {
+            this->edgeWorklist.push_back(std::make_pair(block, succ));
+        }
+        return;
+    }
+
+    const std::vector<tac_line_t> &insts = block->getInstructions();
+    const tac_line_t &compare = insts.at(insts.size() - 2);
+    const lattice_value_t lhs = this->getValue(compare, compare.argument1);
+    const lattice_value_t rhs = this->getValue(compare, compare.argument2);
+
+    // Wait until both operands are reached.
+    if (lhs.height == LATTICE_TOP || rhs.height == LATTICE_TOP) {
+        return;
+    }
+
+    if (lhs.height == LATTICE_BOTTOM || rhs.height == LATTICE_BOTTOM) {
+        for (const BBP &succ : succs) {
+            this->edgeWorklist.push_back(std::make_pair(block, succ));
+        }
+        return;
+    }
+
+    const bool taken = tac_line_t::is_jump_taken(
+        insts.back().operation, lhs.constant, rhs.constant
+    );
+
+    // A jump to the block that follows reaches it either way.
+    const bool hasFallThrough = std::any_of(succs.begin(), succs.end(),
+        [&block](const BBP &succ) { return !SSA::isJumpEdge(block, succ); }
+    );
+
+    for (const BBP &succ : succs) {
+        if (SSA::isJumpEdge(block, succ) == taken || !hasFallThrough) {
+            this->edgeWorklist.push_back(std::make_pair(block, succ));
+        }
+    }
+}
+
+lattice_value_t SCCP::evaluate(const tac_line_t &inst) const {
+    switch (inst.operation) {
+        case TAC_ASSIGN:
+            if (inst.argument2 != "") {
+                return BOTTOM;
+            }
+            return this->getValue(inst, inst.argument1);
+        case TAC_NEGATE: {
+            const lattice_value_t value = this->getValue(inst, inst.argument1);
+            if (value.height != LATTICE_CONSTANT) {
+                return value;
+            }
+            return makeConstant(static_cast<int64_t>(
+                -static_cast<uint64_t>(value.constant)
+            ));
+        }
+        case TAC_ADD ... TAC_MULT: {
+            const lattice_value_t lhs = this->getValue(inst, inst.argument1);
+            const lattice_value_t rhs = this->getValue(inst, inst.argument2);
+            if (lhs.height == LATTICE_BOTTOM || rhs.height == LATTICE_BOTTOM) {
+                return BOTTOM;
+            }
+            if (lhs.height == LATTICE_TOP || rhs.height == LATTICE_TOP) {
+                return TOP;
+            }
+            return fold(inst.operation, lhs.constant, rhs.constant);
+        }
+        default:
+            break;
+    }
+    return BOTTOM;
+}
+
+lattice_value_t SCCP::getValue(
+    const tac_line_t &inst,
+    const std::string &operand
+) const {
+    int64_t constant;
+    if (inst.get_constant_value(operand, constant)) {
+        return makeConstant(constant);
+    }
+
+    if (this->values.count(operand)) {
+        return this->values.at(operand);
+    }
+
+    return BOTTOM;
+}
+
+void SCCP::lowerValue(const std::string &name, const lattice_value_t &value) {
+    lattice_value_t &current = this->values.at(name);
+    const lattice_value_t lowered = meet(current, value);
+
+    if (lowered != current) {
+        current = lowered;
+        this->nameWorklist.push_back(name);
+    }
+}
+
+bool SCCP::isExecutable(const BBP pred, const BBP succ) const {
+    return this->executableEdges.count(std::make_pair(pred, succ)) > 0;
+}
+
+bool SCCP::replaceConstants(const BBP block) {
+    bool changed = false;
+
+    for (tac_line_t &inst : block->getInstructions()) {
+        Symbol *def = SSA::getDefinition(inst);
+        if (def != nullptr && this->values.count(*def) &&
+            this->values.at(*def).height == LATTICE_CONSTANT) {
+                const std::string literal =
+                    this->getLiteral(inst, this->values.at(*def).constant);
+                if (inst.operation != TAC_ASSIGN || inst.argument1 != literal) {
+                    inst.operation = TAC_ASSIGN;
+                    inst.argument1 = literal;
+                    inst.argument2 = "";
+                    changed = true;
+                }
+                continue;
+            }
+
+        for (Symbol *use : SSA::getUses(inst)) {
+            const lattice_value_t value = this->getValue(inst, *use);
+            if (value.height != LATTICE_CONSTANT) {
+                continue;
+            }
+
+            // Constant variables are replaced as well, as their values are
+            // otherwise only loaded into the block they are declared in.
+            const std::string literal = this->getLiteral(inst, value.constant);
+            if (*use != literal) {
+                *use = literal;
+                changed = true;
+            }
+        }
+    }
+
+    if (changed) {
+        block->recomputeInstructionInfo();
+    }
+    return changed;
+}
+
+bool SCCP::resolveConditionalJump(const BBP block) {
+    if (!endsWithCompareAndJump(block)) {
+        return false;
+    }
+
+    std::vector<tac_line_t> &insts = block->getInstructions();
+    const tac_line_t &compare = insts.at(insts.size() - 2);
+    const lattice_value_t lhs = this->getValue(compare, compare.argument1);
+    const lattice_value_t rhs = this->getValue(compare, compare.argument2);
+    if (lhs.height != LATTICE_CONSTANT || rhs.height != LATTICE_CONSTANT) {
+        return false;
+    }
+
+    tac_line_t jump = insts.back();
+    const bool taken = tac_line_t::is_jump_taken(
+        jump.operation, lhs.constant, rhs.constant
+    );
+
+    INFO_LOG(
+        "Resolving conditional jump in %s as %s",
+        block->id_to_string().c_str(), taken ? "taken" : "not taken"
+    );
+
+    insts.pop_back();
+    insts.pop_back();
+    if (taken) {
+        jump.operation = TAC_UNCOND_JMP;
+        jump.argument2 = "";
+        jump.new_id();
+        insts.push_back(jump);
+    }
+    block->recomputeInstructionInfo();
+
+    // Only the edges control may still take remain.
+    const std::vector<BBP> succs = block->getSuccessors();
+    for (const BBP &succ : succs) {
+        block->removeSuccessor(succ);
+        succ->removePredecessor(block);
+    }
+
+    std::set<BBP> kept;
+    std::map<BBP, std::vector<phi_function_t>> &phis
+        = this->ssa.getPhiFunctions();
+    for (const BBP &succ : succs) {
+        if (!this->isExecutable(block, succ)) {
+            if (phis.count(succ)) {
+                for (phi_function_t &phi : phis.at(succ)) {
+                    phi.arguments.erase(block);
+                }
+            }
+        } else if (kept.insert(succ).second) {
+            block->insertSuccessor(succ);
+            succ->insertPredecessor(block);
+        }
+    }
+
+    return true;
+}
+
+bool SCCP::removeUnreachableBlocks() {
+    bool changed = false;
+
+    for (const BBP &bb : this->blocks) {
+        // The procedure markers are kept for the code generator.
+        if (this->executableBlocks.count(bb) || bb->getHasEnterProcedure() ||
+            bb->getHasExitProcedure()) {
+                continue;
+            }
+
+        INFO_LOG("Removing unreachable block %s", bb->id_to_string().c_str());
+
+        const std::vector<BBP> succs = bb->getSuccessors();
+        for (const BBP &succ : succs) {
+            succ->removePredecessor(bb);
+        }
+        const std::vector<BBP> preds = bb->getPredecessors();
+        for (const BBP &pred : preds) {
+            pred->removeSuccessor(bb);
+        }
+        bb->clearSuccessors();
+        bb->clearPredecessors();
+
+        this->ssa.removeBlock(bb);
+        this->allBlocks.erase(bb);
+        changed = true;
+    }
+
+    return changed;
+}
+
+std::string SCCP::getLiteral(const tac_line_t &inst, const int64_t constant) {
+    st_entry_t entry;
+    inst.table->lookupOrInsertIntConstant(constant, &entry);
+    ASSERT(entry.entry_type == ST_LITERAL);
+    return std::to_string(constant);
+}
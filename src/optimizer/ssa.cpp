@@ -0,0 +1,861 @@
+#include <optimizer/ssa.h>
+
+#include <optimizer/cfg.h>
+
+#include <algorithm>
+#include <iterator>
+#include <assertions.h>
+#include <logging.h>
+
+thread_local unsigned int SSA::edgeIdGenerator = 0;
+thread_local unsigned int SSA::copyTempIdGenerator = 0;
+
+std::vector<Symbol *> SSA::getUses(tac_line_t &inst) {
+    std::vector<Symbol *> uses;
+
+    switch (inst.operation) {
+        case TAC_ASSIGN:
+            // Declarations do not read a value.
+            if (inst.argument1 != "") {
+                uses.push_back(&inst.argument1);
+                uses.push_back(&inst.argument2);
+            }
+            break;
+        case TAC_NEGATE:
+        case TAC_WRITE:
+        case TAC_PROC_PARAM:
+        case TAC_RETVAL:
+            uses.push_back(&inst.argument1);
+            break;
+        case TAC_ADD ... TAC_MULT:
+        case TAC_LESS_THAN ... TAC_NOT_EQUALS:
+            uses.push_back(&inst.argument1);
+            uses.push_back(&inst.argument2);
+            break;
+        case TAC_ARRAY_INDEX:
+            // The array itself is accessed through its address.
+            uses.push_back(&inst.argument2);
+            break;
+        default:
+            break;
+    }
+
+    uses.erase(std::remove_if(uses.begin(), uses.end(),
+        [](Symbol *use) { return *use == ""; }
+    ), uses.end());
+    return uses;
+}
+
+Symbol *SSA::getDefinition(tac_line_t &inst) {
+    switch (inst.operation) {
+        case TAC_ASSIGN:
+            if (inst.argument1 == "") {
+                return nullptr;
+            }
+            return &inst.result;
+        case TAC_NEGATE:
+        case TAC_ADD ... TAC_MULT:
+        case TAC_LESS_THAN ... TAC_NOT_EQUALS:
+            return inst.result != "" ? &inst.result : nullptr;
+        case TAC_READ:
+            return &inst.argument1;
+        default:
+            break;
+    }
+    return nullptr;
+}
+
+/**
+ * @param inst The instruction the variable is used in.
+ * @param name The variable to check.
+ * @return True if the name is a scalar variable declared by the user.
+ */
+static bool isScalarVariable(const tac_line_t &inst, const std::string &name) {
+    if (!tac_line_t::is_user_defined_var(name) || tac_line_t::is_label(name)) {
+        return false;
+    }
+
+    unsigned int level;
+    st_entry_t entry;
+    return inst.table->lookup(name, &level, &entry) &&
+        entry.entry_type == ST_VARIABLE && !entry.variable.isConstant &&
+        !entry.variable.isArray;
+}
+
+SSA::SSA(CFG *cfg, const Dominator *dominator, BlockSet &allBlocks)
+: cfg(cfg), dominator(dominator), allBlocks(allBlocks) {
+    cfg->performPostorderTraversal([this](BBP block) {
+        this->blocks.push_back(block);
+    });
+    std::sort(this->blocks.begin(), this->blocks.end(), bb_cmp);
+
+    this->collectVariables();
+    this->insertPhiFunctions();
+
+    std::map<std::string, std::vector<std::string>> stacks;
+    this->renameVariables(
+        cfg->getEntryBlock(),
+        stacks,
+        dominator->computeDominatorTreeChildren()
+    );
+}
+
+void SSA::destruct() {
+    this->computeInterference();
+    this->computeStorage();
+
+    auto storageOf = [this](const std::string &name) {
+        return this->isRenamed(name) ? this->storage.at(this->findWeb(name))
+            : name;
+    };
+
+    // The copies are collected before any edge is split.
+    std::vector<std::pair<std::pair<BBP, BBP>,
+        std::vector<std::pair<std::string, std::string>>>> edgeCopies;
+
+    for (const BBP &bb : this->blocks) {
+        if (!this->phis.count(bb)) {
+            continue;
+        }
+
+        const std::vector<BBP> &preds = bb->getPredecessors();
+        const std::set<BBP> uniquePreds(preds.begin(), preds.end());
+        for (const BBP &pred : uniquePreds) {
+            std::vector<std::pair<std::string, std::string>> copies;
+            for (const phi_function_t &phi : this->phis.at(bb)) {
+                if (!phi.arguments.count(pred)) {
+                    continue;
+                }
+
+                const std::string dest = storageOf(phi.result);
+                const std::string source = storageOf(phi.arguments.at(pred));
+                if (dest != source) {
+                    copies.push_back(std::make_pair(dest, source));
+                }
+            }
+
+            if (!copies.empty()) {
+                edgeCopies.push_back(
+                    std::make_pair(std::make_pair(pred, bb), copies)
+                );
+            }
+        }
+    }
+
+    // The procedure returns its values in the variables themselves.
+    std::vector<std::pair<std::string, std::string>> exitCopies;
+    for (const auto &p : this->exitVersions) {
+        const std::string source = storageOf(p.second);
+        if (source != p.first) {
+            exitCopies.push_back(std::make_pair(p.first, source));
+        }
+    }
+
+    this->replaceVersionsWithStorage();
+
+    for (const auto &edge : edgeCopies) {
+        this->insertCopies(edge.first.first, edge.first.second, edge.second);
+    }
+
+    for (const BBP &bb : this->blocks) {
+        if (exitCopies.empty() || !bb->getHasExitProcedure()) {
+            continue;
+        }
+
+        std::vector<tac_line_t> &insts = bb->getInstructions();
+        auto exit = std::find_if(insts.begin(), insts.end(),
+            [](const tac_line_t &inst) {
+                return inst.operation == TAC_EXIT_PROC;
+            }
+        );
+        const std::vector<tac_line_t> sequence
+            = this->sequentializeCopies(exitCopies, *exit);
+        insts.insert(exit, sequence.begin(), sequence.end());
+        bb->recomputeInstructionInfo();
+    }
+
+    this->phis.clear();
+}
+
+std::map<BBP, std::vector<phi_function_t>> &SSA::getPhiFunctions() {
+    return this->phis;
+}
+
+bool SSA::isRenamed(const std::string &name) const {
+    return this->versionToVariable.count(name) > 0;
+}
+
+const std::string &SSA::getVariable(const std::string &version) const {
+    return this->versionToVariable.at(version);
+}
+
+std::string SSA::to_string() const {
+    std::string result = "Phi-functions for " + this->cfg->getName() + ":\n";
+    for (const BBP &bb : this->blocks) {
+        if (!this->phis.count(bb)) {
+            continue;
+        }
+
+        for (const phi_function_t &phi : this->phis.at(bb)) {
+            result += bb->id_to_string() + ": " + phi.result + " := phi(";
+            for (auto i = phi.arguments.begin(); i != phi.arguments.end(); i++) {
+                if (i != phi.arguments.begin()) {
+                    result += ", ";
+                }
+                result += i->second + " from " + i->first->id_to_string();
+            }
+            result += ")\n";
+        }
+    }
+    return result;
+}
+
+void SSA::removeBlock(const BBP block) {
+    this->blocks.erase(
+        std::remove(this->blocks.begin(), this->blocks.end(), block),
+        this->blocks.end()
+    );
+    this->phis.erase(block);
+
+    for (auto &p : this->phis) {
+        for (phi_function_t &phi : p.second) {
+            phi.arguments.erase(block);
+        }
+    }
+}
+
+void SSA::collectVariables() {
+    for (const BBP &bb : this->blocks) {
+        if (bb->getHasProcedureCall()) {
+            INFO_LOG(
+                "Variables of %s are not renamed, as it calls procedures",
+                this->cfg->getName().c_str()
+            );
+            return;
+        }
+    }
+
+    // Variables used in any other way, such as arrays, are left alone.
+    std::set<std::string> candidates;
+    std::set<std::string> excluded;
+    // Variables declared by another graph are left alone too, since their
+    // storage would have to be declared outside of this graph.
+    std::set<std::string> declared;
+
+    for (const BBP &bb : this->blocks) {
+        for (tac_line_t &inst : bb->getInstructions()) {
+            if (inst.operation == TAC_ASSIGN && inst.argument1 == "") {
+                declared.insert(inst.result);
+                continue;
+            }
+
+            std::vector<Symbol *> operands = getUses(inst);
+            if (Symbol *def = getDefinition(inst)) {
+                operands.push_back(def);
+            }
+
+            for (Symbol *field :
+                {&inst.result, &inst.argument1, &inst.argument2}) {
+                    if (*field == "") {
+                        continue;
+                    }
+
+                    const bool isOperand = std::find(
+                        operands.begin(), operands.end(), field
+                    ) != operands.end();
+                    if (isOperand && isScalarVariable(inst, *field)) {
+                        candidates.insert(*field);
+                    } else if (!isOperand) {
+                        excluded.insert(*field);
+                    }
+                }
+        }
+    }
+
+    for (const std::string &candidate : candidates) {
+        if (declared.count(candidate) == 0) {
+            excluded.insert(candidate);
+        }
+    }
+
+    std::set_difference(
+        candidates.begin(), candidates.end(),
+        excluded.begin(), excluded.end(),
+        std::inserter(this->variables, this->variables.end())
+    );
+
+    for (const std::string &variable : this->variables) {
+        this->versionToVariable[variable] = variable;
+    }
+}
+
+// Places phi-functions for variables that are live across blocks at the
+// iterated dominance frontier of their definitions, known as semi-pruned SSA.
+void SSA::insertPhiFunctions() {
+    const std::map<BBP, std::set<BBP>> frontiers
+        = this->dominator->computeDominanceFrontiers();
+
+    std::set<std::string> nonLocals;
+    std::map<std::string, std::set<BBP>> definitionSites;
+
+    for (const BBP &bb : this->blocks) {
+        std::set<std::string> defined;
+        for (tac_line_t &inst : bb->getInstructions()) {
+            for (Symbol *use : getUses(inst)) {
+                if (this->variables.count(*use) && !defined.count(*use)) {
+                    nonLocals.insert(*use);
+                }
+            }
+
+            Symbol *def = getDefinition(inst);
+            if (def != nullptr && this->variables.count(*def)) {
+                defined.insert(*def);
+                definitionSites[*def].insert(bb);
+            }
+
+            // The caller may use any variable after the procedure returns.
+            if (inst.operation == TAC_EXIT_PROC) {
+                std::set_difference(
+                    this->variables.begin(), this->variables.end(),
+                    defined.begin(), defined.end(),
+                    std::inserter(nonLocals, nonLocals.end())
+                );
+            }
+        }
+    }
+
+    for (const std::string &variable : nonLocals) {
+        std::vector<BBP> worklist(
+            definitionSites[variable].begin(), definitionSites[variable].end()
+        );
+        std::set<BBP> visited(worklist.begin(), worklist.end());
+        std::set<BBP> hasPhi;
+
+        while (!worklist.empty()) {
+            const BBP bb = worklist.back();
+            worklist.pop_back();
+
+            if (!frontiers.count(bb)) {
+                continue;
+            }
+
+            for (const BBP &frontier : frontiers.at(bb)) {
+                if (!hasPhi.insert(frontier).second) {
+                    continue;
+                }
+
+                phi_function_t phi;
+                phi.variable = variable;
+                this->phis[frontier].push_back(phi);
+
+                // The phi-function is a new definition of the variable.
+                if (visited.insert(frontier).second) {
+                    worklist.push_back(frontier);
+                }
+            }
+        }
+    }
+}
+
+void SSA::renameVariables(
+    const BBP block,
+    std::map<std::string, std::vector<std::string>> &stacks,
+    const std::map<BBP, std::vector<BBP>> &children
+) {
+    // Variables that are not yet defined hold their value from before the
+    // graph is entered.
+    auto current = [&stacks](const std::string &variable) {
+        return stacks[variable].empty() ? variable : stacks[variable].back();
+    };
+
+    std::vector<std::string> pushed;
+
+    if (this->phis.count(block)) {
+        for (phi_function_t &phi : this->phis.at(block)) {
+            phi.result = this->newVersion(phi.variable);
+            stacks[phi.variable].push_back(phi.result);
+            pushed.push_back(phi.variable);
+        }
+    }
+
+    for (tac_line_t &inst : block->getInstructions()) {
+        for (Symbol *use : getUses(inst)) {
+            if (this->variables.count(*use)) {
+                *use = current(*use);
+            }
+        }
+
+        Symbol *def = getDefinition(inst);
+        if (def != nullptr && this->variables.count(*def)) {
+            const std::string variable = *def;
+            *def = this->newVersion(variable);
+            stacks[variable].push_back(*def);
+            pushed.push_back(variable);
+        }
+
+        if (inst.operation == TAC_EXIT_PROC) {
+            for (const std::string &variable : this->variables) {
+                this->exitVersions[variable] = current(variable);
+            }
+        }
+    }
+    block->recomputeInstructionInfo();
+
+    for (const BBP &succ : block->getSuccessors()) {
+        if (!this->phis.count(succ)) {
+            continue;
+        }
+        for (phi_function_t &phi : this->phis.at(succ)) {
+            phi.arguments[block] = current(phi.variable);
+        }
+    }
+
+    if (children.count(block)) {
+        for (const BBP &child : children.at(block)) {
+            this->renameVariables(child, stacks, children);
+        }
+    }
+
+    for (const std::string &variable : pushed) {
+        stacks[variable].pop_back();
+    }
+}
+
+std::string SSA::newVersion(const std::string &variable) {
+    const std::string version = variable + SSA_VERSION_SEPARATOR +
+        std::to_string(++this->versionCounts[variable]);
+    this->versionToVariable[version] = variable;
+    return version;
+}
+
+// Two versions of a variable interfere if one is live where the other is
+// defined. Phi-functions define their results at the start of their block
+// and use their arguments at the end of the predecessors.
+void SSA::computeInterference() {
+    std::map<BBP, std::set<std::string>> liveIn;
+
+    auto liveOut = [this, &liveIn](const BBP &bb) {
+        std::set<std::string> live;
+        for (const BBP &succ : bb->getSuccessors()) {
+            if (liveIn.count(succ)) {
+                live.insert(liveIn.at(succ).begin(), liveIn.at(succ).end());
+            }
+            if (!this->phis.count(succ)) {
+                continue;
+            }
+            for (const phi_function_t &phi : this->phis.at(succ)) {
+                if (phi.arguments.count(bb) &&
+                    this->isRenamed(phi.arguments.at(bb))) {
+                        live.insert(phi.arguments.at(bb));
+                    }
+            }
+        }
+        return live;
+    };
+
+    auto define = [this](
+        const std::string &def,
+        const std::set<std::string> &live
+    ) {
+        for (const std::string &other : live) {
+            if (other != def &&
+                this->getVariable(other) == this->getVariable(def)) {
+                    this->interference[def].insert(other);
+                    this->interference[other].insert(def);
+                }
+        }
+    };
+
+    // Computes the variables live at the start of the block, recording
+    // interference at each definition if requested.
+    auto transfer = [&](const BBP &bb, const bool record) {
+        std::set<std::string> live = liveOut(bb);
+
+        std::vector<tac_line_t> &insts = bb->getInstructions();
+        for (auto i = insts.rbegin(); i != insts.rend(); i++) {
+            if (i->operation == TAC_EXIT_PROC) {
+                for (const auto &p : this->exitVersions) {
+                    live.insert(p.second);
+                }
+            }
+
+            Symbol *def = getDefinition(*i);
+            if (def != nullptr && this->isRenamed(*def)) {
+                if (record) {
+                    define(*def, live);
+                }
+                live.erase(*def);
+            }
+
+            for (Symbol *use : getUses(*i)) {
+                if (this->isRenamed(*use)) {
+                    live.insert(*use);
+                }
+            }
+        }
+
+        if (this->phis.count(bb)) {
+            for (const phi_function_t &phi : this->phis.at(bb)) {
+                if (record) {
+                    define(phi.result, live);
+                }
+                live.erase(phi.result);
+            }
+        }
+
+        return live;
+    };
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto i = this->blocks.rbegin(); i != this->blocks.rend(); i++) {
+            std::set<std::string> live = transfer(*i, false);
+            if (live != liveIn[*i]) {
+                liveIn[*i] = live;
+                changed = true;
+            }
+        }
+    }
+
+    for (const BBP &bb : this->blocks) {
+        transfer(bb, true);
+    }
+}
+
+void SSA::computeStorage() {
+    std::map<std::string, std::vector<std::string>> members;
+    for (const auto &p : this->versionToVariable) {
+        this->webs[p.first] = p.first;
+        members[p.first].push_back(p.first);
+    }
+
+    auto interferes = [this, &members](
+        const std::string &a,
+        const std::string &b
+    ) {
+        for (const std::string &m : members.at(a)) {
+            if (!this->interference.count(m)) {
+                continue;
+            }
+            for (const std::string &n : members.at(b)) {
+                if (this->interference.at(m).count(n)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+
+    // Versions merged by a phi-function share a web unless they interfere,
+    // in which case a copy is required.
+    for (const BBP &bb : this->blocks) {
+        if (!this->phis.count(bb)) {
+            continue;
+        }
+        for (const phi_function_t &phi : this->phis.at(bb)) {
+            for (const auto &arg : phi.arguments) {
+                if (!this->isRenamed(arg.second) ||
+                    this->getVariable(arg.second) != phi.variable) {
+                        continue;
+                    }
+
+                const std::string a = this->findWeb(phi.result);
+                const std::string b = this->findWeb(arg.second);
+                if (a == b || interferes(a, b)) {
+                    continue;
+                }
+
+                this->webs[b] = a;
+                members[a].insert(
+                    members[a].end(), members[b].begin(), members[b].end()
+                );
+                members.erase(b);
+            }
+        }
+    }
+
+    // Webs that do not interfere are stored in the same variable. The web
+    // holding the value from before the graph is entered is stored in the
+    // variable itself, followed by the largest webs.
+    for (const std::string &variable : this->variables) {
+        const std::string entryWeb = this->findWeb(variable);
+        std::vector<std::string> order;
+        for (const auto &p : members) {
+            if (this->getVariable(p.first) == variable && 
+                p.first != entryWeb) {
+                    order.push_back(p.first);
+                }
+        }
+        std::stable_sort(order.begin(), order.end(),
+            [&members](const std::string &a, const std::string &b) {
+                return members.at(a).size() > members.at(b).size();
+            }
+        );
+        order.insert(order.begin(), entryWeb);
+
+        std::vector<std::pair<std::string, std::vector<std::string>>> colors;
+        for (const std::string &web : order) {
+            auto color = std::find_if(colors.begin(), colors.end(),
+                [&web, &interferes](const auto &c) {
+                    return std::none_of(c.second.begin(), c.second.end(),
+                        [&web, &interferes](const std::string &other) {
+                            return interferes(web, other);
+                        }
+                    );
+                }
+            );
+
+            if (color == colors.end()) {
+                const std::string name = colors.empty() ? variable : web;
+                if (name != variable) {
+                    this->declareStorage(variable, name);
+                }
+                colors.push_back(
+                    std::make_pair(name, std::vector<std::string>())
+                );
+                color = colors.end() - 1;
+            }
+
+            color->second.push_back(web);
+            this->storage[web] = color->first;
+        }
+    }
+}
+
+void SSA::declareStorage(const std::string &variable, const std::string &name) {
+    INFO_LOG("Version %s of %s is given storage", name.c_str(), variable.c_str());
+
+    // The scope of the variable is found from an instruction using it.
+    std::shared_ptr<SymbolTable> table = nullptr;
+    for (const BBP &bb : this->blocks) {
+        for (tac_line_t &inst : bb->getInstructions()) {
+            std::vector<Symbol *> operands = getUses(inst);
+            if (Symbol *def = getDefinition(inst)) {
+                operands.push_back(def);
+            }
+            for (Symbol *operand : operands) {
+                if (this->isRenamed(*operand) && 
+                    this->getVariable(*operand) == variable) {
+                        table = inst.table;
+                    }
+            }
+        }
+    }
+    ASSERT(table != nullptr);
+
+    unsigned int level;
+    st_entry_t entry;
+    const bool found = table->lookup(variable, &level, &entry);
+    ASSERT(found);
+
+    // The storage is declared beside the variable so it has the same scope.
+    // Only variables declared in the graph are renamed.
+
+    for (const BBP &bb : this->blocks) {
+        std::vector<tac_line_t> &insts = bb->getInstructions();
+        for (auto i = insts.begin(); i != insts.end(); i++) {
+            if (i->operation != TAC_ASSIGN || i->result != variable ||
+                i->argument1 != "" || i->table->getLevel() != level) {
+                    continue;
+                }
+
+            i->table->insert(name, entry);
+
+            tac_line_t declaration = *i;
+            declaration.result = name;
+            declaration.new_id();
+            insts.insert(i + 1, declaration);
+            bb->recomputeInstructionInfo();
+            return;
+        }
+    }
+
+    ERROR_LOG("Failed to find declaration of %s", variable.c_str());
+    exit(EXIT_FAILURE);
+}
+
+void SSA::replaceVersionsWithStorage() {
+    for (const BBP &bb : this->blocks) {
+        for (tac_line_t &inst : bb->getInstructions()) {
+            std::vector<Symbol *> operands = getUses(inst);
+            if (Symbol *def = getDefinition(inst)) {
+                operands.push_back(def);
+            }
+
+            for (Symbol *operand : operands) {
+                if (this->isRenamed(*operand)) {
+                    *operand = this->storage.at(this->findWeb(*operand));
+                }
+            }
+        }
+        bb->recomputeInstructionInfo();
+    }
+}
+
+void SSA::insertCopies(
+    BBP pred,
+    BBP succ,
+    const std::vector<std::pair<std::string, std::string>> &copies
+) {
+    // Copies in a predecessor with other successors would also execute on
+    // the other edges, so the edge is split instead.
+    BBP location;
+    const auto edge = std::make_pair(pred, succ);
+    if (this->edgeBlocks.count(edge)) {
+        location = this->edgeBlocks.at(edge);
+    } else if (pred->getSuccessors().size() == 1) {
+        location = pred;
+    } else {
+        location = this->splitEdge(pred, succ);
+    }
+
+    const std::vector<tac_line_t> sequence
+        = this->sequentializeCopies(copies, pred->getInstructions().back());
+
+    // The copies are made before control leaves the block.
+    std::vector<tac_line_t> &insts = location->getInstructions();
+    auto position = insts.end();
+    if (!insts.empty() && tac_line_t::transfers_control(insts.back())) {
+        position--;
+    }
+    insts.insert(position, sequence.begin(), sequence.end());
+    location->recomputeInstructionInfo();
+}
+
+BBP SSA::splitEdge(BBP pred, BBP succ) {
+    BBP block;
+
+    if (!SSA::isJumpEdge(pred, succ)) {
+        // The predecessor falls through into the new block.
+        block = this->insertBlockAfter(pred);
+    } else {
+        // The new block falls through into the successor, so the block
+        // before the successor must jump to it instead.
+        BBP previous = this->allBlocks.getPrevious(succ);
+        ASSERT(previous != nullptr);
+
+        const std::vector<BBP> &succs = previous->getSuccessors();
+        if (std::find(succs.begin(), succs.end(), succ) != succs.end() &&
+            !SSA::isJumpEdge(previous, succ)) {
+                if (succs.size() != 1) {
+                    previous = this->splitEdge(previous, succ);
+                }
+
+                tac_line_t jump = succ->getFirstLabel();
+                jump.operation = TAC_UNCOND_JMP;
+                jump.new_id();
+                previous->insertInstruction(jump);
+            }
+
+        block = this->insertBlockAfter(previous);
+
+        tac_line_t label = succ->getFirstLabel();
+        label.argument1 += "S" + std::to_string(SSA::edgeIdGenerator++);
+        label.new_id();
+        block->insertInstruction(label);
+
+        pred->getInstructions().back().argument1 = label.argument1;
+        pred->recomputeInstructionInfo();
+    }
+
+    pred->removeSuccessor(succ);
+    pred->insertSuccessor(block);
+    succ->removePredecessor(pred);
+    succ->insertPredecessor(block);
+    block->insertPredecessor(pred);
+    block->insertSuccessor(succ);
+
+    this->edgeBlocks[std::make_pair(pred, succ)] = block;
+    return block;
+}
+
+BBP SSA::insertBlockAfter(const BBP block) {
+    // Blocks sharing the major ID that follow the block are ordered after
+    // the new block.
+    BBP inserted = this->allBlocks.create(block->getID());
+    this->allBlocks.insertAfter(block, inserted);
+    return inserted;
+}
+
+bool SSA::isJumpEdge(const BBP pred, const BBP succ) {
+    const std::vector<tac_line_t> &insts = pred->getInstructions();
+    if (insts.empty() || !tac_line_t::transfers_control(insts.back())) {
+        return false;
+    }
+
+    for (const tac_line_t &inst : succ->getInstructions()) {
+        if (inst.operation == TAC_LABEL &&
+            inst.argument1 == insts.back().argument1) {
+                return true;
+            }
+    }
+    return false;
+}
+
+void SSA::resetIdGenerators() {
+    SSA::edgeIdGenerator = 0;
+    SSA::copyTempIdGenerator = 0;
+}
+
+// The copies of an edge happen at the same time, so a copy may only be made
+// once no other copy reads its destination. Cycles of copies, such as swaps,
+// are broken by saving a destination in a temporary.
+std::vector<tac_line_t> SSA::sequentializeCopies(
+    std::vector<std::pair<std::string, std::string>> copies,
+    const tac_line_t &location
+) {
+    std::vector<tac_line_t> sequence;
+
+    auto makeCopy = [&sequence, &location](
+        const std::string &dest,
+        const std::string &source
+    ) {
+        tac_line_t copy = location;
+        copy.new_id();
+        copy.operation = TAC_ASSIGN;
+        copy.result = dest;
+        copy.argument1 = source;
+        copy.argument2 = "";
+        sequence.push_back(copy);
+    };
+
+    while (!copies.empty()) {
+        auto ready = std::find_if(copies.begin(), copies.end(),
+            [&copies](const std::pair<std::string, std::string> &copy) {
+                return std::none_of(copies.begin(), copies.end(),
+                    [&copy](const std::pair<std::string, std::string> &other) {
+                        return &other != &copy && other.second == copy.first;
+                    }
+                );
+            }
+        );
+
+        if (ready != copies.end()) {
+            makeCopy(ready->first, ready->second);
+            copies.erase(ready);
+            continue;
+        }
+
+        const std::string saved = copies.front().first;
+        const std::string temp = "$tssa" +
+            std::to_string(SSA::copyTempIdGenerator++);
+        makeCopy(temp, saved);
+
+        for (std::pair<std::string, std::string> &copy : copies) {
+            if (copy.second == saved) {
+                copy.second = temp;
+            }
+        }
+    }
+
+    return sequence;
+}
+
+std::string &SSA::findWeb(const std::string &name) {
+    std::string &parent = this->webs.at(name);
+    if (parent != name) {
+        parent = this->findWeb(parent);
+    }
+    return parent;
+}
@@ -215,6 +215,14 @@ bool StripProfile::arrayExpressionUsesIterator(
 
 bool StripProfile::isVariableDependentOnIndex(
     const std::string &variable
+) const {
+    std::set<std::string> visited;
+    return this->isVariableDependentOnIndex(variable, visited);
+}
+
+bool StripProfile::isVariableDependentOnIndex(
+    const std::string &variable,
+    std::set<std::string> &visited
 ) const {
     if (variable == "") {
         return false;
@@ -224,6 +232,10 @@ bool StripProfile::isVariableDependentOnIndex(
         return true;
     }
 
+    if (!visited.insert(variable).second) {
+        return false;
+    }
+
     std::vector<BBP> loopBody;
     this->loop.forEachBBInBody([&loopBody](BBP bb) {
         loopBody.push_back(bb);
@@ -249,8 +261,10 @@ bool StripProfile::isVariableDependentOnIndex(
                     continue;
                 }
 
-                return this->isVariableDependentOnIndex(inst.argument1) 
-                    || this->isVariableDependentOnIndex(inst.argument2);
+                return this->isVariableDependentOnIndex(inst.argument1, visited)
+                    || this->isVariableDependentOnIndex(
+                        inst.argument2, visited
+                    );
             }
 
         }
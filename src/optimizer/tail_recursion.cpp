@@ -0,0 +1,172 @@
+#include <optimizer/tail_recursion.h>
+
+#include <set>
+#include <assertions.h>
+#include <logging.h>
+
+/**
+ * @param inst An instruction.
+ * @return True if the instruction declares a variable, else false.
+ */
+static bool isDeclaration(const tac_line_t &inst) {
+    return inst.operation == TAC_ASSIGN && !inst.result.empty() &&
+        inst.argument1.empty();
+}
+
+TailRecursionEliminator::TailRecursionEliminator(
+    std::vector<tac_line_t> &instructions
+) : instructions(instructions), tempCount(0), eliminatedCount(0) {
+    std::vector<tac_line_t> code;
+    std::vector<tac_line_t> procedure;
+    for (const tac_line_t &inst : this->instructions) {
+        if (inst.operation == TAC_ENTER_PROC) {
+            ASSERT(procedure.empty());
+            procedure.push_back(inst);
+            continue;
+        }
+        if (procedure.empty()) {
+            code.push_back(inst);
+            continue;
+        }
+
+        procedure.push_back(inst);
+        if (inst.operation == TAC_EXIT_PROC) {
+            const std::vector<tac_line_t> eliminated =
+                this->eliminate(procedure);
+            code.insert(code.end(), eliminated.begin(), eliminated.end());
+            procedure.clear();
+        }
+    }
+    ASSERT(procedure.empty());
+
+    if (this->eliminatedCount != 0) {
+        this->instructions = code;
+    }
+}
+
+std::vector<tac_line_t> TailRecursionEliminator::eliminate(
+    const std::vector<tac_line_t> &procedure
+) {
+    const tac_line_t &enter = procedure.front();
+    ASSERT(procedure.size() >= 3 && procedure.at(1).operation == TAC_LABEL);
+
+    unsigned int level;
+    st_entry_t entry;
+    const bool success = enter.table->lookup(enter.argument1, &level, &entry);
+    ASSERT(success);
+    ASSERT(entry.entry_type == ST_FUNCTION);
+
+    if (entry.procedure.returnType != VOID) {
+        return procedure;
+    }
+
+    const std::string header = procedure.at(1).argument1 + "T";
+    const size_t count = this->eliminatedCount;
+
+    std::vector<tac_line_t> code;
+    std::vector<tac_line_t> arguments;
+    for (size_t i = 0; i < procedure.size(); i++) {
+        const tac_line_t &inst = procedure.at(i);
+        if (inst.operation == TAC_PROC_PARAM) {
+            arguments.push_back(inst);
+            continue;
+        }
+
+        if (inst.operation == TAC_CALL &&
+            tac_line_t::extract_label(inst.argument1) == enter.argument1 &&
+            isInTailPosition(procedure, i) &&
+            this->assignArguments(entry, arguments, code)) {
+                tac_line_t jump;
+                jump.operation = TAC_UNCOND_JMP;
+                jump.argument1 = header;
+                jump.table = inst.table;
+                code.push_back(jump);
+                this->eliminatedCount++;
+            } else {
+                code.insert(code.end(), arguments.begin(), arguments.end());
+                code.push_back(inst);
+            }
+        arguments.clear();
+    }
+
+    if (this->eliminatedCount == count) {
+        return procedure;
+    }
+
+    INFO_LOG("Turned the tail recursion of %s into a loop",
+        enter.argument1.c_str());
+
+    // The code before the loop is left as it was, so the loop starts at
+    // the same place in the new code.
+    size_t start = 2;
+    while (isDeclaration(procedure.at(start))) {
+        start++;
+    }
+
+    tac_line_t label;
+    label.operation = TAC_LABEL;
+    label.argument1 = header;
+    label.table = procedure.at(start).table;
+    code.insert(code.begin() + start, label);
+    return code;
+}
+
+bool TailRecursionEliminator::assignArguments(
+    const st_entry_t &entry,
+    const std::vector<tac_line_t> &arguments,
+    std::vector<tac_line_t> &out
+) {
+    ASSERT(arguments.size() == entry.procedure.argumentsLength);
+
+    std::set<std::string> parameters;
+    for (size_t i = 0; i < arguments.size(); i++) {
+        const std::string parameter = entry.procedure.argumentNames[i];
+        if (entry.procedure.argumentIsArray[i] &&
+            arguments.at(i).argument1 != parameter) {
+                return false;
+            }
+        parameters.insert(parameter);
+    }
+
+    std::vector<tac_line_t> copies;
+    std::vector<tac_line_t> assignments;
+    for (size_t i = 0; i < arguments.size(); i++) {
+        const std::string parameter = entry.procedure.argumentNames[i];
+        std::string argument = arguments.at(i).argument1;
+        if (argument == parameter) {
+            continue;
+        }
+
+        if (parameters.count(argument)) {
+            tac_line_t copy;
+            copy.operation = TAC_ASSIGN;
+            copy.result = "$ttail" + std::to_string(this->tempCount++);
+            copy.argument1 = argument;
+            copy.table = arguments.at(i).table;
+            copies.push_back(copy);
+            argument = copy.result;
+        }
+
+        tac_line_t assignment;
+        assignment.operation = TAC_ASSIGN;
+        assignment.result = parameter;
+        assignment.argument1 = argument;
+        assignment.table = arguments.at(i).table;
+        assignments.push_back(assignment);
+    }
+
+    out.insert(out.end(), copies.begin(), copies.end());
+    out.insert(out.end(), assignments.begin(), assignments.end());
+    return true;
+}
+
+bool TailRecursionEliminator::isInTailPosition(
+    const std::vector<tac_line_t> &procedure,
+    const size_t call
+) {
+    size_t i = call + 1;
+    while (procedure.at(i).operation == TAC_LABEL) {
+        i++;
+    }
+    return procedure.at(i).operation == TAC_EXIT_PROC;
+}
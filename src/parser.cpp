@@ -8,6 +8,7 @@
 #include <parser.h>
 
 #include <string.h>
+#include <timer.h>
 
 Parser::Parser(const token_stream_t &tokens) 
 : tokens(tokens) {
@@ -19,6 +20,7 @@ Parser::Parser(const token_stream_t &tokens)
 Parser::~Parser() {}
 
 AST Parser::parse() {
+    ScopedTimer timer("Parser::parse");
     return this->parseProgram();
 }
 
@@ -403,6 +405,8 @@ void Parser::parseProcedure(std::shared_ptr<ExprListAST> parent) {
 
     for (uint8_t i = 0; i < func_info.procedure.argumentsLength; i++) {
         func_info.procedure.argumentTypes[i] = prototype->arguments.at(i)->type;
+        func_info.procedure.argumentIsArray[i] = 
+            prototype->arguments.at(i)->is_array;
         memset(func_info.procedure.argumentNames[i], 0, MAX_ID_LEN);
         memcpy(
             func_info.procedure.argumentNames[i], 
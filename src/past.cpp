@@ -197,6 +197,7 @@ std::optional<std::string> CallExprAST::generateCode(
         );
     }
 
+    std::vector<std::string> values;
     for (unsigned int i = 0; i < this->arguments.size(); i++) {
         type_t providedType = this->arguments.at(i)->type;
         type_t expectedType = func_ent.procedure.argumentTypes[i];
@@ -206,8 +207,13 @@ std::optional<std::string> CallExprAST::generateCode(
             );
         }
 
-        std::string arg1 = this->arguments
-            .at(i)->generateCode(generator, generated).value();
+        values.push_back(this->arguments
+            .at(i)->generateCode(generator, generated).value());
+    }
+
+    // The parameters are placed together right before the call, so that 
+    // every argument is evaluated by the time the first is passed.
+    for (const std::string &arg1 : values) {
         tac_line_t param_code = generator.makeQuad(
             this->symTable, TAC_PROC_PARAM, arg1
         );
@@ -242,12 +248,13 @@ std::optional<std::string> ProcedureAST::generateCode(
 
     this->body->generateCode(generator, generated);
 
-    // Return types are optional.
+    // Return types are optional. The value is read in the scope of the 
+    // procedure, where the return variable is declared.
     if (this->proto->returnVariable != nullptr) {
-        generator.makeQuad(
-            this->symTable,
-            TAC_ASSIGN, this->proto->returnVariable->name, RETURN_ADDRESS
-        );
+        generated.push_back(generator.makeQuad(
+            this->proto->returnVariable->symTable,
+            TAC_RETVAL, this->proto->returnVariable->name
+        ));
     }
 
     generated.push_back(generator.makeQuad(
@@ -1,6 +1,7 @@
 #include <symbol_table.h>
 
 #include <assertions.h>
+#include <mutex>
 
 SymbolTable::SymbolTable() : enclosingScope(nullptr), level(0) {
     
@@ -19,6 +20,7 @@ void SymbolTable::insert(
     const address &name, 
     const st_entry_t &object
 ) {
+    std::unique_lock<std::shared_mutex> guard(this->lock);
     this->symbolTable.insert(std::make_pair(name, object));
 }
 
@@ -27,10 +29,14 @@ bool SymbolTable::lookup(
     unsigned int *out_level,
     st_entry_t *out_entry
 ) const {
-    if (this->symbolTable.count(name) > 0) {
-        *out_entry = this->symbolTable.at(name);
-        *out_level = this->level;
-        return true;
+    {
+        std::shared_lock<std::shared_mutex> guard(this->lock);
+        const auto entry = this->symbolTable.find(name);
+        if (entry != this->symbolTable.end()) {
+            *out_entry = entry->second;
+            *out_level = this->level;
+            return true;
+        }
     }
 
     if (this->enclosingScope != nullptr) {
@@ -45,13 +51,15 @@ void SymbolTable::lookupOrInsertIntConstant(
     st_entry_t *out_entry
 ) {
     const address name = std::to_string(value);
-    if (this->symbolTable.count(name) > 0) {
-        *out_entry = this->symbolTable.at(name);
+    std::unique_lock<std::shared_mutex> guard(this->lock);
+    const auto entry = this->symbolTable.find(name);
+    if (entry != this->symbolTable.end()) {
+        *out_entry = entry->second;
     } else {
         out_entry->entry_type = ST_LITERAL;
         out_entry->literal.type = INT;
         out_entry->literal.value.int_value = value;
-        this->insert(name, *out_entry);
+        this->symbolTable.insert(std::make_pair(name, *out_entry));
     }
 }
 
@@ -0,0 +1,138 @@
+#include <thread_pool.h>
+
+#include <assertions.h>
+
+ThreadPool::ThreadPool(const unsigned int threads)
+: batch(0), stopping(false), task(nullptr), remaining(0) {
+    ASSERT(threads > 0);
+
+    for (unsigned int i = 0; i < threads; i++) {
+        this->queues.push_back(std::make_unique<task_queue_t>());
+    }
+
+    // The calling thread is the first thread of the pool.
+    for (unsigned int i = 1; i < threads; i++) {
+        this->threads.emplace_back([this, i]() { this->work(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->stopping = true;
+    }
+    this->started.notify_all();
+
+    for (std::thread &thread : this->threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::run(
+    const size_t count,
+    const std::function<void(size_t)> &task
+) {
+    if (count == 0) {
+        return;
+    }
+
+    const size_t threads = this->queues.size();
+    {
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->task = &task;
+        this->remaining = count;
+        this->error = nullptr;
+
+        // Neighbouring tasks go to the same thread, which keeps the order of
+        // a single threaded run when there is nothing to steal.
+        for (size_t i = 0; i < threads; i++) {
+            std::lock_guard<std::mutex> queueGuard(this->queues[i]->lock);
+            for (size_t t = i * count / threads;
+                t < (i + 1) * count / threads; t++) {
+                    this->queues[i]->tasks.push_back(t);
+                }
+        }
+
+        this->batch++;
+    }
+    this->started.notify_all();
+
+    while (this->runOne(0)) {}
+
+    std::unique_lock<std::mutex> guard(this->lock);
+    this->finished.wait(guard, [this]() { return this->remaining == 0; });
+    this->task = nullptr;
+
+    if (this->error != nullptr) {
+        std::rethrow_exception(this->error);
+    }
+}
+
+unsigned int ThreadPool::getThreadCount() const {
+    return this->queues.size();
+}
+
+void ThreadPool::work(const unsigned int self) {
+    unsigned long seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> guard(this->lock);
+            this->started.wait(guard, [this, &seen]() {
+                return this->stopping || this->batch != seen;
+            });
+            if (this->stopping) {
+                return;
+            }
+            seen = this->batch;
+        }
+
+        while (this->runOne(self)) {}
+    }
+}
+
+bool ThreadPool::runOne(const unsigned int self) {
+    size_t index = 0;
+    bool found = false;
+
+    {
+        task_queue_t &own = *this->queues[self];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty()) {
+            index = own.tasks.front();
+            own.tasks.pop_front();
+            found = true;
+        }
+    }
+
+    // Steals the last task of the next thread that has any.
+    for (size_t i = 1; !found && i < this->queues.size(); i++) {
+        task_queue_t &victim =
+            *this->queues[(self + i) % this->queues.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            index = victim.tasks.back();
+            victim.tasks.pop_back();
+            found = true;
+        }
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    try {
+        (*this->task)(index);
+    } catch (...) {
+        std::lock_guard<std::mutex> guard(this->lock);
+        if (this->error == nullptr) {
+            this->error = std::current_exception();
+        }
+    }
+
+    if (--this->remaining == 0) {
+        // The lock is taken so the waiting thread cannot miss the wakeup.
+        std::lock_guard<std::mutex> guard(this->lock);
+        this->finished.notify_all();
+    }
+    return true;
+}
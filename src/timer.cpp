@@ -0,0 +1,215 @@
+#include <timer.h>
+
+#include <constants.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <sys/resource.h>
+
+// Every allocation made through operator new is counted, so that the usage
+// of a phase is the difference between the counts at its start and end.
+static std::atomic<uint64_t> allocationCount(0);
+static std::atomic<uint64_t> allocatedByteCount(0);
+
+void *operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedByteCount.fetch_add(size, std::memory_order_relaxed);
+
+    // Zero sized allocations must still return a unique pointer.
+    void *pointer = std::malloc(size > 0 ? size : 1);
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void *operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+std::mutex TimeReport::lock;
+std::vector<phase_usage_t> TimeReport::phases;
+
+void TimeReport::record(const phase_usage_t &usage) {
+    std::lock_guard<std::mutex> guard(TimeReport::lock);
+    auto phase = std::find_if(
+        TimeReport::phases.begin(), TimeReport::phases.end(),
+        [&usage](const phase_usage_t &p) { return p.name == usage.name; }
+    );
+
+    if (phase == TimeReport::phases.end()) {
+        TimeReport::phases.push_back(usage);
+        return;
+    }
+
+    phase->calls += usage.calls;
+    phase->milliseconds += usage.milliseconds;
+    phase->allocations += usage.allocations;
+    phase->allocatedBytes += usage.allocatedBytes;
+    phase->peakResidentKb = usage.peakResidentKb;
+}
+
+const std::vector<phase_usage_t> &TimeReport::getPhases() {
+    return TimeReport::phases;
+}
+
+void TimeReport::reset() {
+    std::lock_guard<std::mutex> guard(TimeReport::lock);
+    TimeReport::phases.clear();
+}
+
+std::string TimeReport::to_table() {
+    const double total = TimeReport::getTotalMilliseconds();
+
+    std::string result;
+    char line[256];
+    snprintf(line, sizeof(line), "%-32s %6s %12s %7s %12s %12s %12s\n",
+        "Phase", "Calls", "Time (ms)", "Time %", "Allocs", "Alloc KiB",
+        "Peak RSS KiB");
+    result += line;
+
+    for (const phase_usage_t &phase : TimeReport::phases) {
+        const std::string name = std::string(2 * phase.depth, ' ') +
+            phase.name;
+        snprintf(line, sizeof(line),
+            "%-32s %6u %12.3f %6.1f%% %12lu %12lu %12ld\n",
+            name.c_str(), phase.calls, phase.milliseconds,
+            total > 0 ? 100.0 * phase.milliseconds / total : 0.0,
+            (unsigned long) phase.allocations,
+            (unsigned long) (phase.allocatedBytes / 1024),
+            phase.peakResidentKb);
+        result += line;
+    }
+
+    snprintf(line, sizeof(line), "%-32s %6s %12.3f %6.1f%% %12s %12s %12ld\n",
+        "Total", "", total, 100.0, "", "", TimeReport::getPeakResidentKb());
+    result += line;
+
+    return result;
+}
+
+std::string TimeReport::to_json() {
+    char buffer[256];
+    std::string result = "{\"phases\": [";
+
+    for (auto i = TimeReport::phases.begin();
+        i != TimeReport::phases.end(); i++) {
+            snprintf(buffer, sizeof(buffer),
+                "{\"name\": \"%s\", \"depth\": %u, \"calls\": %u, "
+                "\"milliseconds\": %.3f, \"allocations\": %lu, "
+                "\"allocated_bytes\": %lu, \"peak_rss_kb\": %ld}",
+                i->name.c_str(), i->depth, i->calls, i->milliseconds,
+                (unsigned long) i->allocations,
+                (unsigned long) i->allocatedBytes, i->peakResidentKb);
+            result += (i == TimeReport::phases.begin() ? "" : ", ");
+            result += buffer;
+        }
+
+    snprintf(buffer, sizeof(buffer),
+        "], \"total_milliseconds\": %.3f, \"peak_rss_kb\": %ld}",
+        TimeReport::getTotalMilliseconds(), TimeReport::getPeakResidentKb());
+    result += buffer;
+
+    return result;
+}
+
+uint64_t TimeReport::getAllocationCount() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+uint64_t TimeReport::getAllocatedBytes() {
+    return allocatedByteCount.load(std::memory_order_relaxed);
+}
+
+long TimeReport::getPeakResidentKb() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    // Linux reports the maximum resident set size in KiB.
+    return usage.ru_maxrss;
+}
+
+double TimeReport::getTotalMilliseconds() {
+    double total = 0.0;
+    for (const phase_usage_t &phase : TimeReport::phases) {
+        if (phase.depth == 0) {
+            total += phase.milliseconds;
+        }
+    }
+    return total;
+}
+
+thread_local unsigned int ScopedTimer::depth = 0;
+
+ScopedTimer::ScopedTimer(const std::string &phase)
+: phase(phase), active(TIME_REPORT_ENABLED) {
+    if (!this->active) {
+        return;
+    }
+
+    // Phases are listed in the order they start, before the phases nested
+    // in them, so the phase is added to the report without any usage.
+    phase_usage_t usage;
+    usage.name = this->phase;
+    usage.depth = ScopedTimer::depth;
+    usage.calls = 0;
+    usage.milliseconds = 0.0;
+    usage.allocations = 0;
+    usage.allocatedBytes = 0;
+    usage.peakResidentKb = TimeReport::getPeakResidentKb();
+    TimeReport::record(usage);
+
+    ScopedTimer::depth++;
+    this->allocations = TimeReport::getAllocationCount();
+    this->allocatedBytes = TimeReport::getAllocatedBytes();
+    this->start = std::chrono::steady_clock::now();
+}
+
+ScopedTimer::~ScopedTimer() {
+    if (!this->active) {
+        return;
+    }
+
+    const std::chrono::duration<double, std::milli> elapsed
+        = std::chrono::steady_clock::now() - this->start;
+    ScopedTimer::depth--;
+
+    phase_usage_t usage;
+    usage.name = this->phase;
+    usage.depth = ScopedTimer::depth;
+    usage.calls = 1;
+    usage.milliseconds = elapsed.count();
+    usage.allocations = TimeReport::getAllocationCount() - this->allocations;
+    usage.allocatedBytes =
+        TimeReport::getAllocatedBytes() - this->allocatedBytes;
+    usage.peakResidentKb = TimeReport::getPeakResidentKb();
+    TimeReport::record(usage);
+}
+
+unsigned int ScopedTimer::getDepth() {
+    return ScopedTimer::depth;
+}
+
+void ScopedTimer::setDepth(const unsigned int depth) {
+    ScopedTimer::depth = depth;
+}